@@ -0,0 +1,103 @@
+/*
+Type annotation benchmark. Each kernel is written twice, without and with annotations, and both versions compute the
+same result. Run with --vm=register: annotated arguments are checked once on entry, and arithmetic on variables of a
+proven type compiles to typed instructions which skip the type checks. The tree-walking interpreter also uses the
+annotations when inferring types.
+*/
+
+// The sum of each counter value's remainder after division by 7
+def sum_remainders(n)
+{
+    i = 0;
+    total = 0;
+    while (i < n)
+    {
+        d = i / 7;
+        total = total + i - d * 7;
+        i = i + 1;
+    }
+    total;
+}
+
+def sum_remainders_typed(n: int) -> int
+{
+    i: int = 0;
+    d: int = 0;
+    total: int = 0;
+    while (i < n)
+    {
+        d = i / 7;
+        total = total + i - d * 7;
+        i = i + 1;
+    }
+    total;
+}
+
+// A polynomial, evaluated by Horner's rule, summed over evenly spaced points
+def poly_sum(n, step)
+{
+    i = 0;
+    x = 0.0;
+    total = 0.0;
+    while (i < n)
+    {
+        p = 2.0 * x + 3.0;
+        p = p * x - 5.0;
+        total = total + p * x;
+        x = x + step;
+        i = i + 1;
+    }
+    total;
+}
+
+def poly_sum_typed(n: int, step: float) -> float
+{
+    i: int = 0;
+    x: float = 0.0;
+    p: float = 0.0;
+    total: float = 0.0;
+    while (i < n)
+    {
+        p = 2.0 * x + 3.0;
+        p = p * x - 5.0;
+        total = total + p * x;
+        x = x + step;
+        i = i + 1;
+    }
+    total;
+}
+
+n = 90000;
+step = 0.001;
+
+start = clock();
+a = sum_remainders(n);
+b = sum_remainders(n);
+c = sum_remainders(n);
+elapsed = clock();
+elapsed -= start;
+printf("Sum of remainders: {} in {}ms", a, elapsed);
+
+start = clock();
+a = sum_remainders_typed(n);
+b = sum_remainders_typed(n);
+c = sum_remainders_typed(n);
+elapsed = clock();
+elapsed -= start;
+printf("Sum of remainders, annotated: {} in {}ms", a, elapsed);
+
+start = clock();
+a = poly_sum(n, step);
+b = poly_sum(n, step);
+c = poly_sum(n, step);
+elapsed = clock();
+elapsed -= start;
+printf("Polynomial sum: {} in {}ms", a, elapsed);
+
+start = clock();
+a = poly_sum_typed(n, step);
+b = poly_sum_typed(n, step);
+c = poly_sum_typed(n, step);
+elapsed = clock();
+elapsed -= start;
+printf("Polynomial sum, annotated: {} in {}ms", a, elapsed);
@@ -0,0 +1,57 @@
+/*
+Channel throughput benchmark. Two producer tasks send 20000 ints each through a channel to two consumer tasks, which
+sum what they receive, once for each of several channel capacities, and prints how many values per millisecond got
+through. Run it with --workers set to the number of cores, and with --workers=1 to see the cost of parking and waking
+on one thread.
+
+A capacity of 1 makes every send wait for a receive, so the tasks park and wake each other all the time; larger
+buffers let producers run ahead, so they park only when the consumers fall behind.
+*/
+
+def produce(ch, first, count)
+{
+    i = first;
+    last = first + count;
+    while (i < last)
+    {
+        send(ch, i);
+        i = i + 1;
+    }
+    count;
+}
+
+def consume(ch)
+{
+    total = 0;
+    item = 0;
+    while (recv(ch, item))
+    {
+        total = total + item;
+    }
+    total;
+}
+
+def run(capacity)
+{
+    start = clock();
+    ch = channel(capacity);
+    readers = spawn consume(ch);
+    others = spawn consume(ch);
+    a = spawn produce(ch, 0, 20000);
+    b = spawn produce(ch, 20000, 20000);
+    sent = join(a);
+    sent += join(b);
+    close(ch);
+    total = join(readers);
+    total += join(others);
+    elapsed = clock();
+    elapsed -= start;
+
+    rate = sent / elapsed;
+    printf("Capacity {}: {} values, sum {}, in {}ms: {} values/ms", capacity, sent, total, elapsed, rate);
+}
+
+run(1);
+run(16);
+run(256);
+run(4096);
@@ -0,0 +1,57 @@
+/*
+Dispatch benchmark. Each loop does almost no work per iteration, so the time is mostly spent dispatching from one
+operation to the next. Compare the tree-walking interpreter with the VM by running once as-is and once with --vm.
+*/
+
+count = 90000;
+
+// Counting loop: 'while (i < count)' and 'i += 1'
+i = 0;
+start = clock();
+while (i < count)
+{
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Counting loop: {} iterations in {}ms", i, elapsed);
+
+// Array indexing: 'values[j]'
+values = [3, 1, 4, 1, 5, 9, 2, 6, 5, 3];
+total = 0;
+i = 0;
+start = clock();
+while (i < 9000)
+{
+    j = 0;
+    while (j < 10)
+    {
+        total += values[j];
+        j += 1;
+    }
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Array indexing: total {} in {}ms", total, elapsed);
+
+// General arithmetic, with a branch
+a = 0;
+b = 1;
+i = 0;
+start = clock();
+while (i < count)
+{
+    t = a + b;
+    a = b;
+    b = t;
+    if (b > 1000000)
+    {
+        a = 0;
+        b = 1;
+    }
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Arithmetic loop: {} in {}ms", b, elapsed);
@@ -0,0 +1,66 @@
+/*
+Embedding benchmark: a small request handler, run the way a host program runs a script per request. Run it with
+--repeat=<count>, which binds the request number to 'request' and runs the script that many times through the
+embedding API: first compiling it once and reusing one execution, then creating an execution of that program for
+every run, then compiling it again for every run. Each request does little work, so the cold start of a new execution
+costs about half as much as running it, and compiling it every time costs about ten times as much.
+*/
+
+// The price of a quantity of items after the bulk discount
+def price(quantity, unit)
+{
+    total = quantity * unit;
+    if (quantity > 100)
+    {
+        total = total - total / 10;
+    }
+    total;
+}
+
+// The shipping cost for a weight, in steps of 5
+def shipping(weight)
+{
+    cost = 4;
+    left = weight;
+    while (left > 5)
+    {
+        cost = cost + 2;
+        left = left - 5;
+    }
+    cost;
+}
+
+// Limits a value to the range low..high
+def clamp(value, low, high)
+{
+    limited = value;
+    if (value < low)
+    {
+        limited = low;
+    }
+    if (value > high)
+    {
+        limited = high;
+    }
+    limited;
+}
+
+// The loyalty points earned on an order
+def points(amount)
+{
+    earned = amount / 20;
+    clamp(earned, 1, 50);
+}
+
+// The amount due for a request
+def handle(number)
+{
+    quantity = number / 3 + 1;
+    weight = quantity * 2;
+    subtotal = price(quantity, 7);
+    bonus = points(subtotal);
+    due = subtotal + shipping(weight);
+    due - bonus;
+}
+
+handle(request);
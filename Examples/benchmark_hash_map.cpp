@@ -0,0 +1,123 @@
+/*
+Map benchmark. Scripts have no way to build a map, so this times Core::THashMap, which backs TMapValue, directly against
+the std::map it replaced: inserting, looking up and iterating over 1K, 100K and 10M string keys. Lookups hit and miss
+in equal numbers, in shuffled order. HashMap.h needs nothing but the standard library:
+
+    g++ -std=c++20 -O2 -ISource/Public -o benchmark_hash_map Examples/benchmark_hash_map.cpp
+    ./benchmark_hash_map
+
+Smaller maps are rebuilt and searched over several rounds, so every size does about as much work in total. The 10M
+rows need about 1.5GB of memory.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "HashMap.h"
+
+// Operations timed per size, spread over as many rounds as it takes
+static constexpr size_t OPERATIONS = 10'000'000;
+
+struct TTimes
+{
+    double Insert = 0; // Nanoseconds per operation
+    double Lookup = 0;
+    double Iterate = 0;
+};
+
+template <typename TBody>
+static double Time(size_t Operations, TBody&& Body)
+{
+    const auto Start = std::chrono::steady_clock::now();
+    Body();
+    const std::chrono::duration<double, std::nano> Elapsed = std::chrono::steady_clock::now() - Start;
+    return Elapsed.count() / static_cast<double>(Operations);
+}
+
+template <typename TMap, typename TInsert, typename TFind>
+static TTimes Measure(const std::vector<std::string>& Keys, const std::vector<std::string>& Probes, TInsert&& Insert,
+                      TFind&& Find)
+{
+    const size_t Rounds = std::max<size_t>(OPERATIONS / Keys.size(), 1);
+    TTimes Times;
+    size_t Found = 0;
+    long long Sum = 0;
+
+    TMap Map;
+    Times.Insert = Time(Rounds * Keys.size(), [&]
+    {
+        for (size_t Round = 0; Round < Rounds; Round++)
+        {
+            Map = TMap();
+            for (size_t Index = 0; Index < Keys.size(); Index++)
+            {
+                Insert(Map, Keys[Index], static_cast<int>(Index));
+            }
+        }
+    });
+    Times.Lookup = Time(Rounds * Probes.size(), [&]
+    {
+        for (size_t Round = 0; Round < Rounds; Round++)
+        {
+            for (const std::string& Probe : Probes)
+            {
+                Found += Find(Map, Probe);
+            }
+        }
+    });
+    Times.Iterate = Time(Rounds * Keys.size(), [&]
+    {
+        for (size_t Round = 0; Round < Rounds; Round++)
+        {
+            for (const auto& [Key, Value] : Map)
+            {
+                Sum += Value + static_cast<long long>(Key.size());
+            }
+        }
+    });
+
+    // Printed so neither loop can be optimized away
+    std::printf("    (found %zu, sum %lld)\n", Found, Sum);
+    return Times;
+}
+
+int main()
+{
+    std::mt19937 Random(42);
+    for (const size_t Size : {size_t{1'000}, size_t{100'000}, size_t{10'000'000}})
+    {
+        std::vector<std::string> Keys;
+        Keys.reserve(Size);
+        for (size_t Index = 0; Index < Size; Index++)
+        {
+            Keys.push_back("key_" + std::to_string(Index));
+        }
+        std::vector<std::string> Probes;
+        Probes.reserve(Size);
+        for (size_t Index = 0; Index < Size; Index++)
+        {
+            Probes.push_back(Index % 2 == 0 ? Keys[Index] : "missing_" + std::to_string(Index));
+        }
+        std::shuffle(Probes.begin(), Probes.end(), Random);
+
+        std::printf("%zu entries\n", Size);
+        const TTimes Hash = Measure<Core::THashMap<int>>(
+            Keys, Probes,
+            [](Core::THashMap<int>& Map, const std::string& Key, int Value) { Map.Set(Key, Value); },
+            [](const Core::THashMap<int>& Map, const std::string& Key) { return Map.Find(Key) ? 1 : 0; });
+        const TTimes Tree = Measure<std::map<std::string, int>>(
+            Keys, Probes,
+            [](std::map<std::string, int>& Map, const std::string& Key, int Value) { Map[Key] = Value; },
+            [](const std::map<std::string, int>& Map, const std::string& Key) { return Map.count(Key); });
+
+        std::printf("    insert:  THashMap %7.1fns  std::map %7.1fns\n", Hash.Insert, Tree.Insert);
+        std::printf("    lookup:  THashMap %7.1fns  std::map %7.1fns\n", Hash.Lookup, Tree.Lookup);
+        std::printf("    iterate: THashMap %7.1fns  std::map %7.1fns\n", Hash.Iterate, Tree.Iterate);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+Inlining benchmark. The loops call small helpers, which --vm=register compiles in place of the calls, so no activation
+is pushed and no parameters are bound through the frame. Run with --inline-report to see which sites were inlined:
+'clamp' has a conditional and is kept as a call.
+*/
+
+def square(x)
+{
+    x * x;
+}
+
+// Linear interpolation between a and b in steps of 1/16
+def lerp(a, b, t)
+{
+    d = b - a;
+    s = d * t;
+    a + s / 16;
+}
+
+def sum_of_squares(a, b)
+{
+    p = square(a);
+    q = square(b);
+    p + q;
+}
+
+def clamp(x, limit)
+{
+    if (x > limit)
+    {
+        limit;
+    }
+    else
+    {
+        x;
+    }
+}
+
+i = 0;
+total = 0;
+start = clock();
+while (i < 90000)
+{
+    k = i / 900;
+    total += square(k);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Squares: 90000 calls in {}ms, total {}", elapsed, total);
+
+i = 0;
+low = 100;
+high = 900;
+start = clock();
+while (i < 90000)
+{
+    step = i / 6000;
+    mid = lerp(low, high, step);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Interpolation: 90000 calls in {}ms, ends at {}", elapsed, mid);
+
+i = 0;
+j = 3;
+start = clock();
+while (i < 90000)
+{
+    hyp = sum_of_squares(j, j);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Nested helpers: 90000 calls in {}ms, last {}", elapsed, hyp);
+
+i = 0;
+limit = 45000;
+start = clock();
+while (i < 90000)
+{
+    c = clamp(i, limit);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Clamp, not inlined: 90000 calls in {}ms, ends at {}", elapsed, c);
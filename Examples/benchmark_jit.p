@@ -0,0 +1,58 @@
+/*
+JIT benchmark. Run once as-is and once with --jit to compare; both runs print the same results.
+*/
+
+// Integer arithmetic in nested loops
+start = clock();
+total = 0;
+i = 0;
+while (i < 500)
+{
+    j = 0;
+    while (j < 500)
+    {
+        k = i * j;
+        total += k / 7 - j;
+        j += 1;
+    }
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Nested int loops: {} in {}ms", total, elapsed);
+
+// Float accumulation with a branch
+start = clock();
+x = 0.0;
+step = 0.001;
+n = 0;
+while (n < 90000)
+{
+    if (x > 10.0)
+    {
+        x -= 10.0;
+    }
+    x += step * n;
+    n += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Float loop: {} in {}ms", x, elapsed);
+
+// A small function called from a loop, compiled once it is hot
+def poly(p)
+{
+    p * p * 3 + p * 2 + 1;
+}
+start = clock();
+sum = 0;
+c = 0;
+while (c < 20000)
+{
+    v = poly(c);
+    sum += v / 1000;
+    c += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Function calls: {} in {}ms", sum, elapsed);
@@ -0,0 +1,36 @@
+/*
+Line reading benchmark. Counts the lines and bytes of a large text file with 'open_file' and 'next_line', and prints
+the throughput in MB/s. Create the file first, for example 5GB of log-like lines with:
+
+    yes "2024-01-01 12:00:00 INFO request handled in 12ms by worker 3" | head -c 5G > /tmp/penguin_lines.txt
+
+The file is read through a buffer of fixed size and each line reuses the string before it, so memory use stays the same
+whatever the size of the file; run it with a file larger than memory to see. The 5GB file has about 88 million lines,
+so run it with --max-loop=100000000. Ints are 32 bits, so bytes are counted in whole megabytes as they add up.
+*/
+
+path = "/tmp/penguin_lines.txt";
+
+start = clock();
+file = open_file(path);
+lines = 0;
+megabytes = 0;
+bytes = 0;
+line = "";
+while (next_line(file, line))
+{
+    lines = lines + 1;
+    bytes += size_of(line);
+    if (bytes > 1000000)
+    {
+        megabytes = megabytes + 1;
+        bytes -= 1000000;
+    }
+}
+close_file(file);
+elapsed = clock();
+elapsed -= start;
+
+rate = megabytes * 1000;
+rate = rate / elapsed;
+printf("{} lines, {}MB without newlines, in {}ms: {} MB/s", lines, megabytes, elapsed, rate);
@@ -0,0 +1,23 @@
+/*
+Loop optimization benchmark. Run with and without --optimize, which hoists the invariant parts of each loop in front
+of it. Add --stats to see how many expressions were moved.
+*/
+
+data = [3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9];
+width = 12;
+height = 7;
+
+// The bound and the scale do not change inside the loop
+i = 0;
+total = 0;
+start = clock();
+while (i < width * height * 1000)
+{
+    n = size_of(data);
+    scale = width * height + n;
+    total += scale;
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Invariant bound and scale: {} iterations in {}ms, total {}", i, elapsed, total);
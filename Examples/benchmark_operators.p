@@ -0,0 +1,255 @@
+/*
+Operator microbenchmark. Times every binary operator on every pair of int, float, string and bool operands. Pairs an
+operator does not support still go through the dispatch table and produce no value.
+*/
+
+count = 20000;
+
+def bench_add(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x + y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} + {}: {}ms", x, y, elapsed);
+}
+
+def bench_sub(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x - y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} - {}: {}ms", x, y, elapsed);
+}
+
+def bench_mul(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x * y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} * {}: {}ms", x, y, elapsed);
+}
+
+def bench_div(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x / y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} / {}: {}ms", x, y, elapsed);
+}
+
+def bench_less(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x < y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} < {}: {}ms", x, y, elapsed);
+}
+
+def bench_greater(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x > y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} > {}: {}ms", x, y, elapsed);
+}
+
+def bench_equal(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x == y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} == {}: {}ms", x, y, elapsed);
+}
+
+def bench_not_equal(x, y)
+{
+    i = 0;
+    start = clock();
+    while (i < count)
+    {
+        x != y;
+        i += 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+    printf("{} != {}: {}ms", x, y, elapsed);
+}
+
+bench_add(3, 3);
+bench_add(3, 2.5);
+bench_add(3, "ab");
+bench_add(3, true);
+bench_add(2.5, 3);
+bench_add(2.5, 2.5);
+bench_add(2.5, "ab");
+bench_add(2.5, true);
+bench_add("ab", 3);
+bench_add("ab", 2.5);
+bench_add("ab", "ab");
+bench_add("ab", true);
+bench_add(true, 3);
+bench_add(true, 2.5);
+bench_add(true, "ab");
+bench_add(true, true);
+print("=========");
+bench_sub(3, 3);
+bench_sub(3, 2.5);
+bench_sub(3, "ab");
+bench_sub(3, true);
+bench_sub(2.5, 3);
+bench_sub(2.5, 2.5);
+bench_sub(2.5, "ab");
+bench_sub(2.5, true);
+bench_sub("ab", 3);
+bench_sub("ab", 2.5);
+bench_sub("ab", "ab");
+bench_sub("ab", true);
+bench_sub(true, 3);
+bench_sub(true, 2.5);
+bench_sub(true, "ab");
+bench_sub(true, true);
+print("=========");
+bench_mul(3, 3);
+bench_mul(3, 2.5);
+bench_mul(3, "ab");
+bench_mul(3, true);
+bench_mul(2.5, 3);
+bench_mul(2.5, 2.5);
+bench_mul(2.5, "ab");
+bench_mul(2.5, true);
+bench_mul("ab", 3);
+bench_mul("ab", 2.5);
+bench_mul("ab", "ab");
+bench_mul("ab", true);
+bench_mul(true, 3);
+bench_mul(true, 2.5);
+bench_mul(true, "ab");
+bench_mul(true, true);
+print("=========");
+bench_div(3, 3);
+bench_div(3, 2.5);
+bench_div(3, "ab");
+bench_div(3, true);
+bench_div(2.5, 3);
+bench_div(2.5, 2.5);
+bench_div(2.5, "ab");
+bench_div(2.5, true);
+bench_div("ab", 3);
+bench_div("ab", 2.5);
+bench_div("ab", "ab");
+bench_div("ab", true);
+bench_div(true, 3);
+bench_div(true, 2.5);
+bench_div(true, "ab");
+bench_div(true, true);
+print("=========");
+bench_less(3, 3);
+bench_less(3, 2.5);
+bench_less(3, "ab");
+bench_less(3, true);
+bench_less(2.5, 3);
+bench_less(2.5, 2.5);
+bench_less(2.5, "ab");
+bench_less(2.5, true);
+bench_less("ab", 3);
+bench_less("ab", 2.5);
+bench_less("ab", "ab");
+bench_less("ab", true);
+bench_less(true, 3);
+bench_less(true, 2.5);
+bench_less(true, "ab");
+bench_less(true, true);
+print("=========");
+bench_greater(3, 3);
+bench_greater(3, 2.5);
+bench_greater(3, "ab");
+bench_greater(3, true);
+bench_greater(2.5, 3);
+bench_greater(2.5, 2.5);
+bench_greater(2.5, "ab");
+bench_greater(2.5, true);
+bench_greater("ab", 3);
+bench_greater("ab", 2.5);
+bench_greater("ab", "ab");
+bench_greater("ab", true);
+bench_greater(true, 3);
+bench_greater(true, 2.5);
+bench_greater(true, "ab");
+bench_greater(true, true);
+print("=========");
+bench_equal(3, 3);
+bench_equal(3, 2.5);
+bench_equal(3, "ab");
+bench_equal(3, true);
+bench_equal(2.5, 3);
+bench_equal(2.5, 2.5);
+bench_equal(2.5, "ab");
+bench_equal(2.5, true);
+bench_equal("ab", 3);
+bench_equal("ab", 2.5);
+bench_equal("ab", "ab");
+bench_equal("ab", true);
+bench_equal(true, 3);
+bench_equal(true, 2.5);
+bench_equal(true, "ab");
+bench_equal(true, true);
+print("=========");
+bench_not_equal(3, 3);
+bench_not_equal(3, 2.5);
+bench_not_equal(3, "ab");
+bench_not_equal(3, true);
+bench_not_equal(2.5, 3);
+bench_not_equal(2.5, 2.5);
+bench_not_equal(2.5, "ab");
+bench_not_equal(2.5, true);
+bench_not_equal("ab", 3);
+bench_not_equal("ab", 2.5);
+bench_not_equal("ab", "ab");
+bench_not_equal("ab", true);
+bench_not_equal(true, 3);
+bench_not_equal(true, 2.5);
+bench_not_equal(true, "ab");
+bench_not_equal(true, true);
+print("=========");
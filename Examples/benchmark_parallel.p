@@ -0,0 +1,65 @@
+/*
+Parallel array benchmark. Maps, filters and sums arrays of 1000, 100000 and 1000000 ints, first with while loops and
+then with 'par_map', 'par_filter' and 'par_reduce', and prints both times for each size. Run it with
+--max-loop=2000000 so the loops can walk the longest array, and with --workers set to the number of cores.
+
+The parallel built-ins split an array into chunks that run on the workers, each in an interpreter of its own, and put
+the results back in order. Arrays shorter than 2048 elements run on the calling thread in one chunk, so the smallest
+size shows what a call costs without threads, besides compiling the program for the workers on the first call. Every
+element is a boxed value, so an array of 100 million would not fit in memory here; the times grow linearly with size.
+*/
+
+def scale(x)
+{
+    x / 1000;
+}
+
+def is_even(x)
+{
+    half = x / 2;
+    half * 2 == x;
+}
+
+def add(a, b)
+{
+    a + b;
+}
+
+def run(size)
+{
+    values = range(size);
+
+    start = clock();
+    scaled = [];
+    evens = [];
+    total = 0;
+    i = 0;
+    while (i < size)
+    {
+        value = index_of(values, i);
+        if (is_even(value))
+        {
+            append(evens, value);
+        }
+        value = scale(value);
+        append(scaled, value);
+        total = add(total, value);
+        i = i + 1;
+    }
+    sequential = clock();
+    sequential -= start;
+
+    start = clock();
+    scaled = par_map("scale", values);
+    evens = par_filter("is_even", values);
+    total = par_reduce("add", scaled, 0);
+    parallel = clock();
+    parallel -= start;
+
+    count = size_of(evens);
+    printf("{} elements: {} even, sum {}: sequential {}ms, parallel {}ms", size, count, total, sequential, parallel);
+}
+
+run(1000);
+run(100000);
+run(1000000);
@@ -0,0 +1,25 @@
+/*
+Output benchmark. Prints 10 million lines, half with 'print' and half with 'printf'. Time it with its output discarded,
+which buffers it in blocks, and again forcing a write for every line:
+
+    time peng --max-loop=20000000 Examples/benchmark_print.p > /dev/null
+    time peng --max-loop=20000000 --flush=line Examples/benchmark_print.p > /dev/null
+
+Lines are collected in a buffer which is written out in 64KB blocks when standard output is a file or pipe, and after
+every line when it is a terminal, so the second run shows what each line cost before.
+*/
+
+i = 0;
+while (i < 5000000)
+{
+    print(i);
+    i = i + 1;
+}
+
+i = 0;
+while (i < 5000000)
+{
+    printf("line {} of {}", i, 5000000);
+    i = i + 1;
+}
+flush();
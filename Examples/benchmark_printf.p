@@ -0,0 +1,61 @@
+/*
+printf benchmark. Prints 200000 lines with one field, with eight, and with eight fields with specs, then how long each
+took. Only the last lines are worth reading:
+
+    peng --max-loop=1000000 Examples/benchmark_printf.p | tail -n 5
+
+Each format string is compiled once into its literal text and a parsed spec per field, so a call only copies the text
+and formats each value straight into the output buffer, however many fields it has.
+*/
+
+def one(count)
+{
+    i = 0;
+    while (i < count)
+    {
+        printf("line {}", i);
+        i = i + 1;
+    }
+}
+
+def eight(count)
+{
+    i = 0;
+    while (i < count)
+    {
+        printf("{} {} {} {} {} {} {} {}", i, i, i, i, i, i, i, i);
+        i = i + 1;
+    }
+}
+
+def specs(count)
+{
+    x = 3.14159;
+    i = 0;
+    while (i < count)
+    {
+        printf("{:>8} {:<6} {:08.3f} {:x} {:+} {:^7} {:.2e} {:>4}", i, i, x, i, i, i, x, i);
+        i = i + 1;
+    }
+}
+
+count = 200000;
+
+start = clock();
+one(count);
+first = clock();
+first -= start;
+
+start = clock();
+eight(count);
+second = clock();
+second -= start;
+
+start = clock();
+specs(count);
+third = clock();
+third -= start;
+
+printf("One field: {} lines in {:.0f}ms", count, first);
+printf("Eight fields: {} lines in {:.0f}ms", count, second);
+printf("Eight fields with specs: {} lines in {:.0f}ms", count, third);
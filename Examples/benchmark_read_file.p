@@ -0,0 +1,53 @@
+/*
+read_file throughput benchmark. Writes a file of 1MB, then 16MB, 256MB and 1GB to /tmp, reads each back with
+'read_file' several times, and prints the throughput in MB/s. The file is in the page cache after being written, so
+this measures the cost of getting its bytes into a string rather than the disk; the largest needs about 3GB of memory.
+
+read_file sizes its buffer from the file's size and reads it in one call, or maps files of 1MB or more and copies them
+into the string in one pass, and the string becomes the call's value without being copied again.
+*/
+
+def measure(path, megabytes, reads)
+{
+    start = clock();
+    i = 0;
+    while (i < reads)
+    {
+        contents = read_file(path);
+        i = i + 1;
+    }
+    elapsed = clock();
+    elapsed -= start;
+
+    bytes = size_of(contents);
+    rate = megabytes * reads;
+    rate = rate * 1000;
+    rate = rate / elapsed;
+    printf("{}MB ({} bytes): read {} times in {}ms, {} MB/s", megabytes, bytes, reads, elapsed, rate);
+    contents = "";
+}
+
+def grow(doublings)
+{
+    i = 0;
+    while (i < doublings)
+    {
+        text = text + text;
+        i = i + 1;
+    }
+    handle = write_async(path, text);
+    await(handle);
+}
+
+path = "/tmp/penguin_read_file.bin";
+text = "0123456789abcdef";
+
+grow(16);
+measure(path, 1, 64);
+grow(4);
+measure(path, 16, 16);
+grow(4);
+measure(path, 256, 4);
+grow(2);
+text = "";
+measure(path, 1024, 1);
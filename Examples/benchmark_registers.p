@@ -0,0 +1,56 @@
+/*
+Register VM benchmark: arithmetic.p-style loops. Run with --stats and each of --vm=stack and --vm=register to compare
+the instructions executed and operand moves, as well as the time. The register VM reads operands straight out of
+registers and computes into the assigned variable, so 'b += a' is one instruction rather than four.
+*/
+
+count = 90000;
+
+// Fibonacci, as in arithmetic.p, wrapping before it overflows
+a = 0;
+b = 1;
+i = 0;
+start = clock();
+while (i < count)
+{
+    t = b;
+    b += a;
+    a = t;
+    if (b > 1000000)
+    {
+        a = 0;
+        b = 1;
+    }
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Fibonacci: {} iterations in {}ms, ends with {}", count, elapsed, a);
+
+// Polynomial, with temporaries for the nested expression
+x = 0;
+sum = 0;
+start = clock();
+while (x < count)
+{
+    y = x * 7 - x / 3 + 11;
+    sum += y / 1000;
+    x += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Polynomial: {} iterations in {}ms, sum {}", count, elapsed, sum);
+
+// Float accumulation
+f = 0.0;
+g = 1.5;
+j = 0;
+start = clock();
+while (j < count)
+{
+    f = f * 0.5 + g;
+    j += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Float: {} iterations in {}ms, ends with {}", count, elapsed, f);
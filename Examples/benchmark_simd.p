@@ -0,0 +1,75 @@
+/*
+Compares the vectorized array builtins against the equivalent script loops.
+*/
+
+// Build the input arrays
+size = 50000;
+a = [];
+b = [];
+i = 0;
+while (i < size)
+{
+    append(a, i);
+    append(b, 0.5);
+    i += 1;
+}
+
+// Dot product
+start = clock();
+total = 0.0;
+i = 0;
+while (i < size)
+{
+    total += a[i] * b[i];
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Dot (loop): {} in {}ms", total, elapsed);
+
+start = clock();
+total = dot(a, b);
+elapsed = clock();
+elapsed -= start;
+printf("Dot (dot): {} in {}ms", total, elapsed);
+print("=========");
+
+// Sum
+start = clock();
+total = 0;
+i = 0;
+while (i < size)
+{
+    total += a[i];
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Sum (loop): {} in {}ms", total, elapsed);
+
+start = clock();
+total = sum(a);
+elapsed = clock();
+elapsed -= start;
+printf("Sum (sum): {} in {}ms", total, elapsed);
+print("=========");
+
+// Scalar broadcast
+start = clock();
+scaled = [];
+i = 0;
+while (i < size)
+{
+    value = a[i] * 2;
+    append(scaled, value);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Scale (loop): {} in {}ms", size, elapsed);
+
+start = clock();
+scaled = vec_mul(a, 2);
+elapsed = clock();
+elapsed -= start;
+printf("Scale (vec_mul): {} in {}ms", size, elapsed);
@@ -0,0 +1,69 @@
+/*
+Tail call benchmark. Both functions recurse once per step with the call as the last thing they do, so with
+--vm=register each call reuses the caller's activation and the recursion runs in constant memory however deep it goes.
+Without tail calls each sum would need 65,000 activations at once.
+
+Arguments are passed by reference, so each function copies what it still needs from its parameters before assigning
+the variables the recursive call's parameters are bound to.
+*/
+
+// Sum of 1..n with an accumulator
+def sum_to(n, acc)
+{
+    if (n == 0)
+    {
+        return acc;
+    }
+    else
+    {
+        total = acc + n;
+        m = n - 1;
+        return sum_to(m, total);
+    }
+}
+
+// Greatest common divisor by Euclid's algorithm, with the remainder computed by division since there is no '%'
+def gcd(a, b)
+{
+    if (b == 0)
+    {
+        a;
+    }
+    else
+    {
+        x = a;
+        y = b;
+        q = x / y;
+        p = q * y;
+        r = x - p;
+        gcd(y, r);
+    }
+}
+
+// The largest sum that fits in an int
+count = 65000;
+zero = 0;
+i = 0;
+start = clock();
+while (i < 20)
+{
+    result = sum_to(count, zero);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("sum_to({}) = {}, 20 times in {}ms", count, result, elapsed);
+
+// Consecutive Fibonacci numbers take the most steps
+u = 1134903170;
+v = 701408733;
+i = 0;
+start = clock();
+while (i < 10000)
+{
+    g = gcd(u, v);
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("gcd({}, {}) = {}, 10000 times in {}ms", u, v, g, elapsed);
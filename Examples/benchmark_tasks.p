@@ -0,0 +1,65 @@
+/*
+Task scaling benchmark. Sums the Collatz steps of every number below 20000 in 16 tasks, each spawned with 'spawn' and
+joined with 'join'. Run it with --workers=1 and then with --workers set to the number of cores: the tasks run on that
+many threads, so the time printed should shrink as workers are added until every core is busy. A task runs its function
+in an interpreter of its own, with copies of its arguments, and 'join' copies its result back.
+*/
+
+// Counts the steps of the Collatz sequence from n down to 1
+def collatz_steps(n)
+{
+    m = n;
+    steps = 0;
+    while (m > 1)
+    {
+        half = m / 2;
+        if (half * 2 == m)
+        {
+            m = half;
+        }
+        else
+        {
+            m = 3 * m + 1;
+        }
+        steps = steps + 1;
+    }
+    steps;
+}
+
+// Sums the Collatz steps of the numbers from first up to last
+def collatz_range(first, last)
+{
+    k = first;
+    sum = 0;
+    while (k < last)
+    {
+        sum = sum + collatz_steps(k);
+        k = k + 1;
+    }
+    sum;
+}
+
+start = clock();
+tasks = [];
+first = 0;
+while (first < 20000)
+{
+    last = first + 1250;
+    task = spawn collatz_range(first, last);
+    append(tasks, task);
+    first = last;
+}
+
+total = 0;
+count = size_of(tasks);
+i = 0;
+while (i < count)
+{
+    task = index_of(tasks, i);
+    steps = join(task);
+    total = total + steps;
+    i = i + 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Collatz steps below 20000: {} from {} tasks in {}ms", total, count, elapsed);
@@ -0,0 +1,35 @@
+/*
+Multi-threaded throughput benchmark. Run it with --jobs=1 and then with --jobs set to the number of cores: each job runs
+the whole script in an interpreter of its own on its own thread, so the jobs per second printed at the end should grow
+with the number of jobs until every core is busy. Works with every engine.
+*/
+
+// Counts the steps of the Collatz sequence from n down to 1
+def collatz_steps(n)
+{
+    m = n;
+    steps = 0;
+    while (m > 1)
+    {
+        half = m / 2;
+        if (half * 2 == m)
+        {
+            m = half;
+        }
+        else
+        {
+            m = 3 * m + 1;
+        }
+        steps = steps + 1;
+    }
+    steps;
+}
+
+i = 1;
+total = 0;
+while (i < 20000)
+{
+    total = total + collatz_steps(i);
+    i = i + 1;
+}
+printf("Collatz steps below 20000: {}", total);
@@ -0,0 +1,50 @@
+/*
+Type inference benchmark. Every variable below keeps one type, so type inference proves the operands of each operator
+and the tree runs them without checking types. Add --type-report to see how many operators were specialized.
+*/
+
+// Integer arithmetic and comparisons
+i = 0;
+total = 0;
+start = clock();
+while (i < 90000)
+{
+    k = i / 7;
+    total += k * 3 - i / 11;
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Int arithmetic: {} iterations in {}ms, total {}", i, elapsed, total);
+
+// Float arithmetic and negation
+i = 0;
+x = 0.5;
+acc = 0.0;
+start = clock();
+while (i < 90000)
+{
+    y = -x;
+    acc += x * y + 1.5;
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Float arithmetic: {} iterations in {}ms, sum {}", i, elapsed, acc);
+
+// A variable which holds both ints and floats is dynamic, so its operators keep their checks
+i = 0;
+v = 1;
+start = clock();
+while (i < 90000)
+{
+    v = v * 1;
+    if (i == 45000)
+    {
+        v = 1.0;
+    }
+    i += 1;
+}
+elapsed = clock();
+elapsed -= start;
+printf("Dynamic variable: {} iterations in {}ms, ends as {}", i, elapsed, v);
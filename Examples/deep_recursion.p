@@ -0,0 +1,21 @@
+/*
+Recursion far deeper than the native stack allows. Run with --vm=register, which keeps every call on stacks on the
+heap; the tree-walking interpreter recurses natively and overflows. --stack-budget sets how much memory those stacks may
+use, 64M by default.
+*/
+
+// Counting the returns after the recursive call keeps it from being a tail call, so every call stays on the stack
+def down(n)
+{
+    if (n > 0)
+    {
+        m = n - 1;
+        down(m);
+        returned += 1;
+    }
+}
+
+depth = 500000;
+returned = 0;
+down(depth);
+printf("Returned from {} calls", returned);
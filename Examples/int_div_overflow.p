@@ -0,0 +1,10 @@
+/*
+Dividing the smallest int by -1 overflows, and traps like a division by zero. Every engine should report it as an
+error instead of crashing, including the register VM when type inference proves both operands are ints.
+*/
+
+low = 0 - 2147483647;
+low -= 1;
+minus = 0 - 1;
+quotient = low / minus;
+print(quotient);
@@ -0,0 +1,34 @@
+/*
+A division by zero inside a nested expression of compiled code, where the left operand is still pushed on the native
+stack when the divisor is checked. The loop is hot long before d reaches 0, so with --jit it runs as native code. Every
+engine should report "Division by zero." and none should crash.
+
+Dividing the smallest int by -1 overflows and traps the same way. Every engine stops at the first error, so set
+overflow to 1 to run that case instead: d reaches -1 on the last iteration, and every engine should report "Integer
+overflow dividing -2147483648 by -1."
+*/
+
+overflow = 0;
+
+n = 0;
+z = 0;
+if (overflow == 0)
+{
+    while (n < 100)
+    {
+        d = 90 - n;
+        z = z + 5 / d;
+        n += 1;
+    }
+}
+else
+{
+    low = 0 - 2147483647;
+    low -= 1;
+    while (n < 100)
+    {
+        d = n - 100;
+        z = z + low / d;
+        n += 1;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+Built-ins which store into a variable passed to them, such as 'recv' and 'next_line', may change its type. Type
+inference must not prove such a variable keeps the type it was first assigned, or the operators using it would read the
+new value as the old type. Every engine should print 'texttext' on the first two lines and 'hellohello' on the next
+two.
+*/
+
+def receive_twice(c)
+{
+    item = 1;
+    recv(c, item);
+    item + item;
+}
+
+c = channel(2);
+v = 1;
+send(c, "text");
+recv(c, v);
+w = v + v;
+print(w);
+
+send(c, "text");
+inner = receive_twice(c);
+print(inner);
+
+def read_twice(file)
+{
+    text = 0;
+    next_line(file, text);
+    text + text;
+}
+
+path = "/tmp/penguin_out_arguments.txt";
+handle = write_async(path, "hello");
+await(handle);
+
+line = 0;
+file = open_file(path);
+next_line(file, line);
+y = line + line;
+print(y);
+close_file(file);
+
+file = open_file(path);
+inner = read_twice(file);
+print(inner);
+close_file(file);
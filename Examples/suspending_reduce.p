@@ -0,0 +1,35 @@
+/*
+par_reduce with a function which waits on a channel, called from the script and from inside a task. On a worker the
+function's calls are suspended while they wait, and par_reduce must still return only once the whole fold is done.
+Run it with --workers=1, where the task, the fold and the senders all share one thread. It prints 4950 twice.
+*/
+
+def pass(ch, value)
+{
+    send(ch, value);
+}
+
+// Adds b to a after passing it through a channel, so the call waits until another task sends it
+def add(a, b)
+{
+    ch = channel(1);
+    sender = spawn pass(ch, b);
+    item = 0;
+    recv(ch, item);
+    join(sender);
+    a + item;
+}
+
+def sum(count)
+{
+    values = range(count);
+    par_reduce("add", values, 0);
+}
+
+values = range(100);
+total = par_reduce("add", values, 0);
+print(total);
+
+task = spawn sum(100);
+total = join(task);
+print(total);
@@ -0,0 +1,19 @@
+/*
+Dividing the smallest int by -1 overflows, and traps like a division by zero. vec_div should report both as errors
+instead of crashing, whether the -1 is an element of an array or a scalar, and on either side of the division.
+*/
+
+low = 0 - 2147483647;
+low -= 1;
+minus = 0 - 1;
+
+dividends = [];
+append(dividends, 10);
+append(dividends, low);
+divisors = [];
+append(divisors, 2);
+append(divisors, minus);
+
+quotients = vec_div(dividends, divisors);
+quotients = vec_div(dividends, minus);
+quotients = vec_div(low, divisors);
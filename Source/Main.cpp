@@ -1,20 +1,234 @@
 #include "Public/Ast.h"
+#include "Public/AsyncIo.h"
+#include "Public/Compiler.h"
+#include "Public/Context.h"
+#include "Public/Embed.h"
+#include "Public/Inference.h"
+#include "Public/Optimizer.h"
+#include "Public/Output.h"
+#include "Public/Resolver.h"
+#include "Public/Tasks.h"
+#include "Public/Vm.h"
+#include <chrono>
 #include <string>
 #include <iostream>
+#include <thread>
 
 using namespace Core;
 using namespace Values;
 using namespace Logging;
 
-int Compile(std::string FileName)
+// What programs run on
+enum class EEngine
 {
-    std::string Source = ReadFile(FileName);
-    if (Source.empty())
+    Tree,     // The tree-walking interpreter
+    Stack,    // The stack VM
+    Register, // The register VM
+};
+
+// Command line options
+struct TOptions
+{
+    std::string FileName;
+    bool bStats = false;            // --stats: print interpreter statistics after running
+    bool bJit = false;              // --jit: compile hot loops and functions to native code
+    EEngine Engine = EEngine::Tree; // --vm, --vm=stack, --vm=register: compile to bytecode and run it on a VM
+    size_t StackBudget = Vm::DEFAULT_STACK_BUDGET; // --stack-budget=<bytes>[K|M|G]: memory for register VM calls
+    bool bInlineReport = false;     // --inline-report: print the register compiler's inlining decisions
+    bool bOptimize = false;         // --optimize: hoist loop invariants out of while loops
+    bool bTypeReport = false;       // --type-report: print how many operators type inference specialized
+    int MaxLoop = Runtime::DEFAULT_MAX_LOOP; // --max-loop=<count>: iterations a while loop may run before it fails
+    int Jobs = 1;                   // --jobs=<count>: run a script in this many interpreters at once, one per thread
+    int Repeat = 0;                 // --repeat=<count>: run a script this many times through the embedding API
+    int Workers = 0;                // --workers=<count>: threads running the tasks a script spawns; one per core if 0
+    Io::EBackend IoBackend = Io::EBackend::Uring; // --io=uring, --io=threads: how read_async and write_async run
+    std::optional<Io::EFlushPolicy> FlushPolicy; // --flush=line, --flush=block: when printed lines are written out
+};
+
+// Parses a positive count, returning 0 if it is invalid
+int ParseCount(const std::string& Text)
+{
+    size_t Length = 0;
+    int Count;
+    try
     {
-        Error("File not found or empty: {}", FileName);
-        return -1;
+        Count = std::stoi(Text, &Length);
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+    return Length == Text.size() && Count > 0 ? Count : 0;
+}
+
+// Parses a byte count with an optional K, M or G suffix, returning 0 if it is invalid
+size_t ParseBytes(const std::string& Text)
+{
+    size_t Length = 0;
+    size_t Bytes;
+    try
+    {
+        Bytes = std::stoull(Text, &Length);
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+    const std::string Suffix = Text.substr(Length);
+    if (Suffix.empty())
+    {
+        return Bytes;
+    }
+    if (Suffix == "K")
+    {
+        return Bytes << 10;
+    }
+    if (Suffix == "M")
+    {
+        return Bytes << 20;
+    }
+    if (Suffix == "G")
+    {
+        return Bytes << 30;
+    }
+    return 0;
+}
+
+// Compiled code for the session. It is kept alive since variables may be bound to storage inside it.
+struct TSession
+{
+    std::vector<std::unique_ptr<Vm::TChunk>> Chunks;
+    std::vector<std::unique_ptr<Vm::TRegisterCode>> Programs;
+    std::unique_ptr<Vm::TRegisterMachine> RegisterMachine; // Owns the compiled functions
+    Vm::TStats VmStats;
+    std::vector<Vm::TInlineDecision> InlineDecisions; // Since the last report
+    Optimizer::TLoopOptimizer LoopOptimizer;
+};
+
+void PrintStats(const Visitor& V, const TSession& Session, const TOptions& Options)
+{
+    std::cout << std::format("Quickened sites: {}, deoptimized: {}", V.QuickenStats.Quickened,
+                             V.QuickenStats.Deoptimized)
+              << '\n';
+    if (V.JitCompiler)
+    {
+        const Jit::TStats& Stats = V.JitCompiler->Stats;
+        std::cout << std::format("JIT regions compiled: {}, rejected: {}, guard failures: {}", Stats.Compiled,
+                                 Stats.Rejected, Stats.GuardFailures)
+                  << '\n';
+    }
+    if (Options.bOptimize)
+    {
+        const Optimizer::TStats& Stats = Session.LoopOptimizer.GetStats();
+        std::cout << std::format("Loop invariants hoisted: {}", Stats.Hoisted) << '\n';
+    }
+    if (Options.Engine != EEngine::Tree)
+    {
+        std::cout << std::format("VM instructions executed: {}, operand moves: {}", Session.VmStats.Instructions,
+                                 Session.VmStats.Moves)
+                  << '\n';
+    }
+}
+
+void PrintInlineReport(TSession& Session)
+{
+    for (const Vm::TInlineDecision& Decision : Session.InlineDecisions)
+    {
+        std::cout << std::format("Line {}, column {}: {} '{}' ({})", Decision.Line, Decision.Column,
+                                 Decision.bInlined ? "inlined" : "did not inline", Decision.Function, Decision.Detail)
+                  << '\n';
+    }
+    Session.InlineDecisions.clear();
+}
+
+void EnableJit(Visitor& V, const TOptions& Options)
+{
+    if (!Options.bJit)
+    {
+        return;
+    }
+    if (!Jit::IsSupported())
+    {
+        std::cout << "The JIT is not supported on this platform; running interpreted.\n";
+        return;
+    }
+    V.JitCompiler = std::make_unique<Jit::TJit>();
+}
+
+// Runs a program with the tree-walking interpreter, or on one of the VMs
+void Run(Visitor& V, AstBody* Program, const TOptions& Options, TSession& Session)
+{
+    if (Options.bOptimize)
+    {
+        Session.LoopOptimizer.Optimize(Program);
+    }
+
+    // A script is resolved as a whole, so a name it can never define stops it before it starts. A REPL line's
+    // functions may use what later lines define.
+    Resolver::TResolver Resolver(V.CurrentFrame, V.Functions, !Options.FileName.empty());
+    if (!Resolver.Run(Program))
+    {
+        return;
     }
 
+    // The VMs compile their own code, so only the tree runs the operators inference specializes
+    if (Options.Engine == EEngine::Tree)
+    {
+        Inference::TTypeInference Inference(V.CurrentFrame, V.Functions);
+        const Inference::TReport Report = Inference.Run(Program);
+        if (Options.bTypeReport)
+        {
+            const double Percent = Report.Operations ? 100.0 * Report.Specialized / Report.Operations : 0.0;
+            std::cout << std::format("Type inference: {} of {} operations specialized ({:.1f}%)", Report.Specialized,
+                                     Report.Operations, Percent)
+                      << '\n';
+        }
+    }
+
+    Vm::TStats* Stats = Options.bStats ? &Session.VmStats : nullptr;
+    switch (Options.Engine)
+    {
+    case EEngine::Stack :
+    {
+        Vm::TCompiler Compiler(V.CurrentFrame);
+        Session.Chunks.push_back(Compiler.Compile(Program));
+        Vm::TVirtualMachine Machine(&V, Stats);
+        Machine.Run(*Session.Chunks.back());
+        break;
+    }
+    case EEngine::Register :
+    {
+        // Functions are compiled when first called, so the report covers them once the program has run
+        std::vector<Vm::TInlineDecision>* InlineReport = Options.bInlineReport ? &Session.InlineDecisions : nullptr;
+        Vm::TRegisterCompiler Compiler(V.CurrentFrame, V.Functions, InlineReport);
+        Session.Programs.push_back(Compiler.Compile(Program));
+        if (!Session.RegisterMachine)
+        {
+            Session.RegisterMachine = std::make_unique<Vm::TRegisterMachine>(&V, Stats, Options.StackBudget,
+                                                                             InlineReport);
+        }
+        Session.RegisterMachine->Run(*Session.Programs.back());
+        break;
+    }
+    default :
+        V.Visit(Program);
+        break;
+    }
+
+    // What the program printed comes before anything printed about it
+    Runtime::GetContext().Output.Flush();
+    if (Options.Engine == EEngine::Register && Options.bInlineReport)
+    {
+        PrintInlineReport(Session);
+    }
+}
+
+// Parses and runs a script in its own interpreter, which logs to the given context
+void RunScript(const std::string& Source, const TOptions& Options, Runtime::TContext& Context)
+{
+    Runtime::TScope Scope(Context);
+    Context.MaxLoop = Options.MaxLoop;
+
     // Tokenize the source code
     Lexer Lex(Source);
     std::vector<Token> Tokens = Lex.Tokenize();
@@ -23,26 +237,166 @@ int Compile(std::string FileName)
     Ast Ast(Tokens);
     AstBody* Program = Ast.GetTree();
 
+    // Tasks the script spawns run its functions on a pool of workers, which finish them before the script ends
+    const int Workers = Options.Workers > 0 ? Options.Workers : static_cast<int>(std::thread::hardware_concurrency());
+    Tasks::TScheduler Scheduler(Source, Workers, Options.bJit, Options.MaxLoop);
+    Context.Scheduler = &Scheduler;
+
     auto V = Visitor();
-    V.Visit(Program);
-    
-    int ErrorCount = GetLogger()->GetCount(LogLevel::Error);
-    std::cout << std::format("Program compiled with {} errors.", ErrorCount) << '\n';
-    if (ErrorCount > 0)
+    EnableJit(V, Options);
+    TSession Session;
+    Run(V, Program, Options, Session);
+    if (Options.bStats)
     {
-        for (auto Msg : GetLogger()->GetMessages(LogLevel::Error))
+        PrintStats(V, Session, Options);
+    }
+    Context.Scheduler = nullptr;
+}
+
+// Runs a script as a host program would, binding the run's number to 'request' each time: first compiling it once and
+// reusing one execution for every run, then creating an execution of the one program for each run, which starts its
+// operators and hot code cold, then compiling it again for each run
+int Repeat(const std::string& Source, const TOptions& Options)
+{
+    const std::vector<std::string> Inputs{"request"};
+    const std::shared_ptr<const Embed::TProgram> Program = Embed::TProgram::Compile(Source, Inputs);
+    Embed::TExecution Execution(Program, Options.bJit);
+
+    auto PrintErrors = [](Embed::TExecution& Failed)
+    {
+        for (const std::string& Msg : Failed.GetErrors())
         {
             std::cout << std::format("{}ERROR: {}{}", "\033[31m", Msg, "\033[0m") << '\n';
         }
+    };
+
+    auto Start = std::chrono::steady_clock::now();
+    for (int Request = 0; Request < Options.Repeat; Request++)
+    {
+        Execution.Set("request", Request);
+        if (!Execution.Run())
+        {
+            PrintErrors(Execution);
+            return -1;
+        }
     }
+    const std::chrono::duration<double, std::milli> Reused = std::chrono::steady_clock::now() - Start;
+    if (const TObject* Result = Execution.GetResult())
+    {
+        std::cout << std::format("Result: {}", Result->ToString()) << '\n';
+    }
+
+    Start = std::chrono::steady_clock::now();
+    for (int Request = 0; Request < Options.Repeat; Request++)
+    {
+        Embed::TExecution Fresh(Program, Options.bJit);
+        Fresh.Set("request", Request);
+        if (!Fresh.Run())
+        {
+            PrintErrors(Fresh);
+            return -1;
+        }
+    }
+    const std::chrono::duration<double, std::milli> PerExecution = std::chrono::steady_clock::now() - Start;
 
+    Start = std::chrono::steady_clock::now();
+    for (int Request = 0; Request < Options.Repeat; Request++)
+    {
+        Embed::TExecution Fresh(Embed::TProgram::Compile(Source, Inputs), Options.bJit);
+        Fresh.Set("request", Request);
+        if (!Fresh.Run())
+        {
+            PrintErrors(Fresh);
+            return -1;
+        }
+    }
+    const std::chrono::duration<double, std::milli> Recompiled = std::chrono::steady_clock::now() - Start;
+
+    std::cout << std::format("Compiled once: {} runs in {:.0f}ms, {:.0f} runs per second", Options.Repeat,
+                             Reused.count(), 1000.0 * Options.Repeat / Reused.count())
+              << '\n';
+    std::cout << std::format("Execution per run: {} runs in {:.0f}ms, {:.0f} runs per second", Options.Repeat,
+                             PerExecution.count(), 1000.0 * Options.Repeat / PerExecution.count())
+              << '\n';
+    std::cout << std::format("Compiled per run: {} runs in {:.0f}ms, {:.0f} runs per second", Options.Repeat,
+                             Recompiled.count(), 1000.0 * Options.Repeat / Recompiled.count())
+              << '\n';
     return 0;
 }
 
-int Interpret()
+int Compile(const TOptions& Options)
+{
+    const std::string& FileName = Options.FileName;
+    std::string Source = ReadFile(FileName).value_or("");
+    if (Source.empty())
+    {
+        Error("File not found or empty: {}", FileName);
+        return -1;
+    }
+    if (Options.Repeat > 0)
+    {
+        return Repeat(Source, Options);
+    }
+
+    // Each job runs in an interpreter of its own, so jobs share nothing and take no locks
+    std::vector<Runtime::TContext> Contexts(Options.Jobs);
+    const auto Start = std::chrono::steady_clock::now();
+    if (Options.Jobs == 1)
+    {
+        RunScript(Source, Options, Contexts[0]);
+    }
+    else
+    {
+        std::vector<std::thread> Threads;
+        for (Runtime::TContext& Context : Contexts)
+        {
+            Threads.emplace_back(RunScript, std::cref(Source), std::cref(Options), std::ref(Context));
+        }
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+    const std::chrono::duration<double, std::milli> Elapsed = std::chrono::steady_clock::now() - Start;
+
+    // Including what tasks printed after the program itself finished
+    for (Runtime::TContext& Context : Contexts)
+    {
+        Context.Output.Flush();
+    }
+    for (size_t Index = 0; Index < Contexts.size(); Index++)
+    {
+        Logger& JobLogger = Contexts[Index].Logger;
+        int ErrorCount = JobLogger.GetCount(LogLevel::Error);
+        const std::string Job = Options.Jobs > 1 ? std::format("Job {}: ", Index + 1) : "";
+        std::cout << std::format("{}Program compiled with {} errors.", Job, ErrorCount) << '\n';
+        if (ErrorCount > 0)
+        {
+            for (auto Msg : JobLogger.GetMessages(LogLevel::Error))
+            {
+                std::cout << std::format("{}ERROR: {}{}", "\033[31m", Msg, "\033[0m") << '\n';
+            }
+        }
+    }
+    if (Options.Jobs > 1)
+    {
+        std::cout << std::format("Ran {} jobs in {:.0f}ms: {:.2f} jobs per second", Options.Jobs, Elapsed.count(),
+                                 1000.0 * Options.Jobs / Elapsed.count())
+                  << '\n';
+    }
+
+    return 0;
+}
+
+int Interpret(const TOptions& Options)
 {
     int Result = 0;
+    Runtime::TContext Context;
+    Context.MaxLoop = Options.MaxLoop;
+    Runtime::TScope Scope(Context);
     Visitor V = Visitor();
+    EnableJit(V, Options);
+    TSession Session;
     printf("Penguin Interpreter\nType below and press enter to run commands.\n");
     while (true)
     {
@@ -61,9 +415,13 @@ int Interpret()
 
         // Construct a syntax tree from the tokens
         Ast Ast(Tokens);
-        const AstBody* Program = Ast.GetTree();
+        AstBody* Program = Ast.GetTree();
 
-        V.Visit(Program);
+        Run(V, Program, Options, Session);
+        if (Options.bStats)
+        {
+            PrintStats(V, Session, Options);
+        }
 
         for (const std::string& Msg : GetLogger()->GetMessages(LogLevel::Error))
         {
@@ -78,22 +436,134 @@ int Interpret()
 // Main entrypoint
 int main(int argc, char* argv[])
 {
-    int Result;
-    if (argc == 1)// [1]cmd
+    // [1]cmd [2..]--<option> [3]<filename>.p
+    TOptions Options;
+    for (int Index = 1; Index < argc; Index++)
+    {
+        const std::string Arg = argv[Index];
+        if (Arg == "--stats")
+        {
+            Options.bStats = true;
+        }
+        else if (Arg == "--jit")
+        {
+            Options.bJit = true;
+        }
+        else if (Arg == "--vm" || Arg == "--vm=stack")
+        {
+            Options.Engine = EEngine::Stack;
+        }
+        else if (Arg == "--vm=register")
+        {
+            Options.Engine = EEngine::Register;
+        }
+        else if (Arg == "--optimize")
+        {
+            Options.bOptimize = true;
+        }
+        else if (Arg == "--type-report")
+        {
+            Options.bTypeReport = true;
+        }
+        else if (Arg == "--inline-report")
+        {
+            Options.bInlineReport = true;
+        }
+        else if (Arg.starts_with("--max-loop="))
+        {
+            Options.MaxLoop = ParseCount(Arg.substr(std::string("--max-loop=").size()));
+            if (Options.MaxLoop == 0)
+            {
+                printf("Invalid loop limit: %s\n", Arg.c_str());
+                return -1;
+            }
+        }
+        else if (Arg.starts_with("--jobs="))
+        {
+            Options.Jobs = ParseCount(Arg.substr(std::string("--jobs=").size()));
+            if (Options.Jobs == 0)
+            {
+                printf("Invalid job count: %s\n", Arg.c_str());
+                return -1;
+            }
+        }
+        else if (Arg.starts_with("--workers="))
+        {
+            Options.Workers = ParseCount(Arg.substr(std::string("--workers=").size()));
+            if (Options.Workers == 0)
+            {
+                printf("Invalid worker count: %s\n", Arg.c_str());
+                return -1;
+            }
+        }
+        else if (Arg == "--io=uring")
+        {
+            Options.IoBackend = Io::EBackend::Uring;
+        }
+        else if (Arg == "--io=threads")
+        {
+            Options.IoBackend = Io::EBackend::Threads;
+        }
+        else if (Arg == "--flush=line")
+        {
+            Options.FlushPolicy = Io::EFlushPolicy::Line;
+        }
+        else if (Arg == "--flush=block")
+        {
+            Options.FlushPolicy = Io::EFlushPolicy::Block;
+        }
+        else if (Arg.starts_with("--repeat="))
+        {
+            Options.Repeat = ParseCount(Arg.substr(std::string("--repeat=").size()));
+            if (Options.Repeat == 0)
+            {
+                printf("Invalid repeat count: %s\n", Arg.c_str());
+                return -1;
+            }
+        }
+        else if (Arg.starts_with("--stack-budget="))
+        {
+            Options.StackBudget = ParseBytes(Arg.substr(std::string("--stack-budget=").size()));
+            if (Options.StackBudget == 0)
+            {
+                printf("Invalid stack budget: %s\n", Arg.c_str());
+                return -1;
+            }
+        }
+        else if (Arg.starts_with("--"))
+        {
+            printf("Unknown option: %s\n", Arg.c_str());
+            return -1;
+        }
+        else if (Options.FileName.empty())
+        {
+            Options.FileName = Arg;
+        }
+        else
+        {
+            printf("Invalid argument count.");
+            return -1;
+        }
+    }
+
+    Io::SetBackend(Options.IoBackend);
+    if (Options.FlushPolicy)
     {
-        Result = Interpret();
+        // Contexts made from here on, such as those of jobs and tasks, use it too
+        Io::SetDefaultFlushPolicy(*Options.FlushPolicy);
+        Runtime::GetContext().Output.SetPolicy(*Options.FlushPolicy);
     }
-    else if (argc == 2) // [1]cmd [2]<filename>.p
+    int Result;
+    if (Options.FileName.empty())
     {
-        const std::string FileName = argv[1];
-        Result = Compile(FileName);
+        Result = Interpret(Options);
     }
     else
     {
-        printf("Invalid argument count.");
-        return -1;
+        Result = Compile(Options);
     }
     
+    Runtime::GetContext().Output.Flush();
     std::cout << "Press ENTER to exit.\n";
     return Result;
 }
@@ -1,6 +1,7 @@
 #include "../Public/Ast.h"
 
 #include <cassert>
+#include <limits>
 #include <ranges>
 
 using namespace Core;
@@ -8,19 +9,14 @@ using namespace Core;
 
 bool IsBuiltIn(const std::string& Name)
 {
-    for (const auto& Key : FUNCTION_MAP | std::views::keys)
-    {
-        if (Key == Name)
-        {
-            return true;
-        }
-    }
-    return false;
+    return Runtime::GetContext().BuiltIns.contains(Name);
 }
 
 std::string FormatSource()
 {
-    return std::format("line {}, column {}\n\t{}\n\t{}^", LINE, COLUMN, SOURCE, std::string(COLUMN, ' '));
+    const Runtime::TContext& Context = Runtime::GetContext();
+    return std::format("line {}, column {}\n\t{}\n\t{}^", Context.Line, Context.Column, Context.Source,
+                       std::string(Context.Column, ' '));
 }
 
 //////////////
@@ -54,11 +50,11 @@ bool Visitor::Visit(AstValue* Node) const
     return true;
 }
 
-bool Visitor::Visit(AstIdentifier* Node) const
+bool Visitor::Visit(AstIdentifier* Node)
 {
     DEBUG_ENTER
 
-    auto T = CurrentFrame->GetIdentifier(Node->Name);
+    auto T = CurrentFrame->GetIdentifier(Node->Binding, Node->Name);
     if (T == nullptr)
     {
         Logging::Error("'{}' is undefined.", Node->Name);
@@ -66,8 +62,9 @@ bool Visitor::Visit(AstIdentifier* Node) const
         Logging::Error("line {}, column {}", Context.Line, Context.Column);
         return false;
     }
-    Node->Value = *T;
-    if (Node->Value.GetType() == NullType)
+    TObject& Value = States.Identifiers[Node->Slot];
+    Value = *T;
+    if (Value.GetType() == NullType)
     {
         Logging::Error("'{}' is undefined.", Node->Name);
         auto Context = Node->GetContext();
@@ -76,91 +73,134 @@ bool Visitor::Visit(AstIdentifier* Node) const
     }
 
     // If the variable is found, push the variable's value to the stack
-    Logging::Debug("'{}' is {}.", Node->Name, Node->Value.ToString());
-    CurrentFrame->Push(&Node->Value);
+#ifdef _DEBUG
+    Logging::Debug("'{}' is {}.", Node->Name, Value.ToString());
+#endif
+    CurrentFrame->Push(&Value);
     DEBUG_EXIT
     return true;
 }
 
-bool Visitor::Visit(const AstUnaryExpr* Node)
+bool Visitor::Visit(AstUnaryExpr* Node)
 {
     DEBUG_ENTER
     CHECK_ACCEPT(Node->Right)
-    TObject* CurrentValue = CurrentFrame->Pop();
+    const TObject* CurrentValue = CurrentFrame->Pop();
+    CHECK_ERRORS
+    TObject& Result = States.Unaries[Node->Slot];
 
-    switch (Node->Op)
+    // An operand of a proven type is negated directly, without checking it or going through the kernel table
+    switch (Node->ProvenType)
     {
-    case Not :
-        *CurrentValue = *CurrentValue - TObject(1);
+    case BoolType :
+        Result.SetBool(!CurrentValue->RawBool());
+        break;
+    case IntType :
+        Result.SetInt(-CurrentValue->RawInt());
         break;
-    case Minus :
-        *CurrentValue = *CurrentValue * TObject(-1);
+    case FloatType :
+        Result.SetFloat(-CurrentValue->RawFloat());
         break;
     default :
-        Logging::Error("Operator is not a valid unary operator.");
-        CHECK_ERRORS
+        switch (Node->Op)
+        {
+        case Not :
+            if (CurrentValue->GetType() != BoolType)
+            {
+                Logging::Error("Operator '!' wants a bool, got '{}'.", CurrentValue->ToString());
+                CHECK_ERRORS
+            }
+            Result.SetBool(!CurrentValue->RawBool());
+            break;
+        case Minus :
+            TObject::BinaryOp(EBinaryOp::Mul, *CurrentValue, TObject(-1), Result);
+            break;
+        default :
+            Logging::Error("Operator is not a valid unary operator.");
+            CHECK_ERRORS
+        }
+        break;
     }
 
-    CurrentFrame->Push(CurrentValue);
+    CurrentFrame->Push(&Result);
     DEBUG_EXIT
     return true;
 }
 
+void Visitor::Quicken(TBinOpState& State, EBinaryOp Op, EValueType LeftType, EValueType RightType)
+{
+    if (LeftType != RightType || (LeftType != IntType && LeftType != FloatType && LeftType != StringType))
+    {
+        State.QuickenState = EQuickenState::Generic;
+        return;
+    }
+    State.QuickenState = EQuickenState::Quickened;
+    State.QuickenedType = LeftType;
+    State.QuickenedKernel = TObject::GetBinaryKernel(Op, LeftType, RightType);
+    QuickenStats.Quickened++;
+}
+
 bool Visitor::Visit(AstBinOp* Node)
 {
     DEBUG_ENTER
+    if (Node->BinaryOp == EBinaryOp::Count)
+    {
+        Logging::Error("Operator '{}' is not a valid binary operator.", GetTokenString(Node->Op));
+        CHECK_ERRORS
+    }
+
     // Visit the left value
     CHECK_ACCEPT(Node->Left)
 
     // After visiting the left value, pop it off the stack and store it here
-    TObject* Left = CurrentFrame->Pop();
-    TObject OriginalLeftValue = *Left;
+    const TObject* Left = CurrentFrame->Pop();
 
     // Visit the right value
     CHECK_ACCEPT(Node->Right)
 
     // After visiting the right value, pop it off the stack and store it here
-    TObject* Right = CurrentFrame->Pop();
+    const TObject* Right = CurrentFrame->Pop();
+    CHECK_ERRORS
 
-    // Execute the operator on the left and right value
-    switch (Node->Op)
+    // Execute the operator on the left and right value, writing into this node's result storage rather than over the
+    // left operand, which may be a literal in the tree
+    TBinOpState& State = States.BinOps[Node->Slot];
+    if (Node->ProvenKernel)
     {
-    case Plus :
-    case PlusEquals :
-        *Left = *Left + *Right;
-        break;
-    case Minus :
-    case MinusEquals :
-        *Left = *Left - *Right;
-        break;
-    case Multiply :
-    case MultEquals :
-        *Left = *Left * *Right;
-        break;
-    case Divide :
-    case DivEquals :
-        *Left = *Left / *Right;
-        break;
-    case LessThan :
-        *Left = *Left < *Right;
-        break;
-    case GreaterThan :
-        *Left = *Left > *Right;
-        break;
-    case Equals :
-        *Left = *Left == *Right;
-        break;
-    case NotEquals :
-        *Left = *Left != *Right;
-        break;
-    default :
-        break;
+        Node->ProvenKernel(*Left, *Right, State.Result);
+    }
+    else
+    {
+        switch (State.QuickenState)
+        {
+        case EQuickenState::Quickened :
+            if (Left->GetType() == State.QuickenedType && Right->GetType() == State.QuickenedType)
+            {
+                State.QuickenedKernel(*Left, *Right, State.Result);
+                break;
+            }
+            // The operand types changed, so this site goes back to the generic path
+            State.QuickenState = EQuickenState::Generic;
+            QuickenStats.Deoptimized++;
+            TObject::BinaryOp(Node->BinaryOp, *Left, *Right, State.Result);
+            break;
+        case EQuickenState::Uninitialized :
+            Quicken(State, Node->BinaryOp, Left->GetType(), Right->GetType());
+            TObject::BinaryOp(Node->BinaryOp, *Left, *Right, State.Result);
+            break;
+        default :
+            TObject::BinaryOp(Node->BinaryOp, *Left, *Right, State.Result);
+            break;
+        }
     }
 
     // Push the resulting value to the stack
-    CurrentFrame->Push(Left);
-    Logging::Debug("BINOP: {} {} {} = {}", Left->ToString(), TokenToStringMap[Node->Op], Right->ToString(),
-                   OriginalLeftValue.ToString());
+    CurrentFrame->Push(&State.Result);
+#ifdef _DEBUG
+    // Formatting the operands is not free, so skip evaluating the arguments entirely outside of debug builds
+    Logging::Debug("BINOP: {} {} {} = {}", Left->ToString(), GetTokenString(Node->Op), Right->ToString(),
+                   State.Result.ToString());
+#endif
     DEBUG_EXIT
     return true;
 }
@@ -181,8 +221,22 @@ bool Visitor::Visit(AstAssignment* Node)
         DEBUG_EXIT
         return false;
     }
+    if (Node->Annotation != Void && Value->GetType() != Node->Annotation)
+    {
+        Logging::Error("'{}' is declared {}, cannot assign '{}'.", Node->Name, GetTypeName(Node->Annotation),
+                       Value->ToString());
+        DEBUG_EXIT
+        return false;
+    }
 
-    CurrentFrame->SetIdentifier(Node->Name, Value);
+    // A literal is copied, since the variable may be changed in place and the tree must stay as written
+    if (Cast<AstValue>(Node->Right))
+    {
+        TObject& Copy = States.Assignments[Node->Slot];
+        Copy = *Value;
+        Value = &Copy;
+    }
+    CurrentFrame->SetIdentifier(Node->Binding, Node->Name, Value);
 
     Logging::Debug("ASSIGN: {} <= {}", Node->Name, Value->ToString());
     DEBUG_EXIT
@@ -193,6 +247,7 @@ bool Visitor::Visit(AstCall* Node)
 {
     DEBUG_ENTER
 
+    TCallState& State = States.Calls[Node->Slot];
     if (Node->Type == IndexOf)
     {
         if (Node->Args.size() != 1)
@@ -206,23 +261,28 @@ bool Visitor::Visit(AstCall* Node)
         CHECK_ERRORS
         int IndexValue = Index->GetInt().GetValue();
 
-        TObject* IdentifierPtr = CurrentFrame->GetIdentifier(Node->Identifier);
+        TObject* IdentifierPtr = CurrentFrame->GetIdentifier(Node->Binding, Node->Identifier);
         if (!IdentifierPtr)
         {
             Logging::Error("Unable to find identifier {}.", Node->Identifier);
             CHECK_ERRORS
         }
-        TObject* Value;
-        TObject Char;
+        const TObject* Element;
         switch (IdentifierPtr->GetType())
         {
         case StringType :
-            Char = IdentifierPtr->At(IndexValue);
-            CurrentFrame->Push(&Char);
+            State.Value = IdentifierPtr->At(IndexValue);
+            CurrentFrame->Push(&State.Value);
             break;
         case ArrayType :
-            Value = IdentifierPtr->AsArray()->GetValue().data() + IndexValue;
-            CurrentFrame->Push(Value);
+            Element = IdentifierPtr->AsArray()->At(IndexValue);
+            if (!Element)
+            {
+                Logging::Error("Index {} is out of range.", IndexValue);
+                CHECK_ERRORS
+            }
+            State.Value = *Element;
+            CurrentFrame->Push(&State.Value);
             break;
         default :
             Logging::Error("Invalid identifier type.");
@@ -232,31 +292,39 @@ bool Visitor::Visit(AstCall* Node)
     }
     else if (Node->Type == Function)
     {
-        // Parse argument values
-        TArguments InArgs;
-        for (AstNode* Arg : Node->Args)
+        const TFunction* BuiltIn = Node->BuiltIn;
+        if (!BuiltIn && IsBuiltIn(Node->Identifier))
+        {
+            BuiltIn = &Runtime::GetContext().BuiltIns.at(Node->Identifier);
+        }
+
+        // Arguments are passed in place: a variable's value, so a callee can change the variable, or a literal's. The
+        // callee may change a literal too, so it gets a copy, unless it is a built-in which changes nothing.
+        const bool bCopyLiterals = !BuiltIn || BuiltIn->GetPurity() == EPurity::Mutating;
+        State.ArgValues.resize(Node->Args.size());
+        State.ArgCopies.resize(Node->Args.size());
+        for (size_t Index = 0; Index < Node->Args.size(); Index++)
         {
-            // Evaluate identifiers
-            if (Cast<AstIdentifier>(Arg))
+            AstNode* Arg = Node->Args[Index];
+            if (const auto Identifier = Cast<AstIdentifier>(Arg))
             {
-                // Cast to an identifier
-                AstIdentifier* Identifier = Cast<AstIdentifier>(Arg);
-
-                // Get the corresponding identifier name and pointer
-                std::string ArgName = Identifier->Name;
-                TObject* ArgValue = CurrentFrame->GetIdentifier(ArgName);
-
-                // Add this as a new variable argument. The key here is the
-                // ArgValue is a pointer to the `Identifiers` array so we can
-                // modify that value in place rather than pass around a bunch
-                // of copies.
-                InArgs.push_back(std::make_shared<TVariable>(ArgName, ArgValue));
+                TObject* Value = CurrentFrame->GetIdentifier(Identifier->Binding, Identifier->Name);
+                if (BuiltIn && (!Value || Value->GetType() == NullType))
+                {
+                    Logging::Error("{} is undefined.", Identifier->Name);
+                    CHECK_ERRORS
+                }
+                State.ArgValues[Index] = Value;
             }
-            // Evaluate literal values
-            else if (AstValue* ValueArg = Cast<AstValue>(Arg))
+            else if (const auto ValueArg = Cast<AstValue>(Arg))
             {
-                // Add the copy of the literal value to the argument list.
-                InArgs.push_back(std::make_shared<TLiteral>(ValueArg->Value));
+                TObject* Value = &ValueArg->Value;
+                if (bCopyLiterals)
+                {
+                    State.ArgCopies[Index] = *Value;
+                    Value = &State.ArgCopies[Index];
+                }
+                State.ArgValues[Index] = Value;
             }
             else
             {
@@ -265,53 +333,45 @@ bool Visitor::Visit(AstCall* Node)
             }
         }
 
-        // Handle built-in functions
-        if (IsBuiltIn(Node->Identifier))
+        // Handle built-in functions. The resolver checked the argument count of the calls it bound.
+        if (BuiltIn)
         {
-            // Temporary return value for the function
-            auto ReturnValue = new TObject(); // TODO: Refactor this
-
-            // Get the corresponding function pointer to the identifier name
-            auto Func = FUNCTION_MAP[Node->Identifier];
-
-            // Invoke the function with the arguments parsed above
-            bool bResult = Func.Invoke(&InArgs, ReturnValue);
-            if (!bResult && !ReturnValue)
+            if (!Node->BuiltIn && !BuiltIn->AcceptsArgumentCount(Node->Args.size()))
             {
-                auto Context = Node->GetContext();
-                auto Space = std::string(Context.Column, ' ');
-                Logging::Error("line {}, column {}\n\t{}\n\t{}^", Context.Line, Context.Column, Context.Source, Space);
+                Logging::Error("Argument count mismatch for '{}'. Got {}, wanted {}{}.", Node->Identifier,
+                               Node->Args.size(), BuiltIn->IsVariadic() ? "at least " : "", BuiltIn->GetArity());
                 CHECK_ERRORS
             }
 
-            if (ReturnValue)
+            // The result goes into the call's storage, and a failed call has logged its error
+            if (!BuiltIn->Invoke(State.ArgValues, State.Value))
             {
-                CurrentFrame->Push(ReturnValue);
+                CHECK_ERRORS
             }
+            CurrentFrame->Push(&State.Value);
         }
         // Handle user-defined functions
-        else if (IsFunctionDeclared(Node->Identifier))
+        else if (AstFunction* Func = Node->Function   ? Node->Function
+                                     : State.Function ? State.Function
+                                                      : GetFunction(Node->Identifier))
         {
-            // Get the function AST node for this identifier
-            auto Func = Functions[Node->Identifier];
-
-            // Make sure in arguments are the same count as expected arguments
-            if (InArgs.size() != Func->Args.size())
+            // Make sure in arguments are the same count as expected arguments. Functions cannot be redefined, so once
+            // a call has found its function it keeps it and skips the lookup and this check.
+            if (!Node->Function && !State.Function)
             {
-                Logging::Error("Argument count mismatch for '{}'. Got {}, wanted {}.", Node->Identifier, InArgs.size(),
-                               Func->Args.size());
-                CHECK_ERRORS
+                if (Node->Args.size() != Func->Args.size())
+                {
+                    Logging::Error("Argument count mismatch for '{}'. Got {}, wanted {}.", Node->Identifier,
+                                   Node->Args.size(), Func->Args.size());
+                    CHECK_ERRORS
+                }
+                State.Function = Func;
             }
-
-            // Push arguments to the variable table
-            for (const auto& [Index, InArg] : Enumerate(InArgs))
+            if (!CallFunction(Func, State.ArgValues))
             {
-                TObject* Value = InArg->GetValuePtr();
-                CurrentFrame->SetIdentifier(Func->Args[Index], Value);
+                DEBUG_EXIT
+                return false;
             }
-
-            // Execute the function body
-            CHECK_ACCEPT(Func->Body)
         }
         else
         {
@@ -324,20 +384,74 @@ bool Visitor::Visit(AstCall* Node)
     return true;
 }
 
+bool Visitor::CallFunction(AstFunction* Func, const std::vector<TObject*>& Arguments)
+{
+    DEBUG_ENTER
+    // Push arguments to the variable table. Annotated parameters are checked here, once per call, so the body can rely
+    // on their types.
+    for (size_t Index = 0; Index < Arguments.size(); Index++)
+    {
+        TObject* Value = Arguments[Index];
+        const EValueType ArgType = Func->ArgTypes[Index];
+        if (ArgType != Void && (!Value || Value->GetType() != ArgType))
+        {
+            Logging::Error("Argument '{}' of '{}' must be {}, got '{}'.", Func->Args[Index], Func->Name,
+                           GetTypeName(ArgType), Value ? Value->ToString() : "undefined");
+            CHECK_ERRORS
+        }
+        CurrentFrame->SetIdentifier(Func->ArgBindings[Index], Func->Args[Index], Value);
+    }
+    const size_t Depth = CurrentFrame->Stack.size();
+
+    // Once the function is hot, compile its body for the argument types it has now
+    TJitState& JitState = States.Jit[Func->Slot];
+    if (JitCompiler && JitState.State == EJitState::Cold && ++JitState.HitCount >= Jit::HOT_CALL_COUNT)
+    {
+        JitState.Region = JitCompiler->Compile(Func, CurrentFrame);
+        JitState.State = JitState.Region ? EJitState::Compiled : EJitState::Rejected;
+    }
+
+    // Execute the function body, as native code if it has been compiled
+    bool bEntered = false;
+    if (JitState.State == EJitState::Compiled && !RunJit(JitState.Region, 0, bEntered))
+    {
+        DEBUG_EXIT
+        return false;
+    }
+    if (!bEntered)
+    {
+        CHECK_ACCEPT(Func->Body)
+    }
+
+    // The result is whatever the body left on the stack
+    if (Func->ReturnType != Void)
+    {
+        const TObject* Result = CurrentFrame->Stack.size() > Depth ? CurrentFrame->Stack.back() : nullptr;
+        if (!Result || Result->GetType() != Func->ReturnType)
+        {
+            Logging::Error("'{}' must return {}, got '{}'.", Func->Name, GetTypeName(Func->ReturnType),
+                           Result ? Result->ToString() : "nothing");
+            CHECK_ERRORS
+        }
+    }
+    DEBUG_EXIT
+    return true;
+}
+
 bool Visitor::Visit(AstIf* Node)
 {
     DEBUG_ENTER
 
     CHECK_ACCEPT(Node->Cond)
 
-    bool bResult = CurrentFrame->Pop();
+    TBoolValue bResult = CurrentFrame->Pop()->GetBool();
 
-    Logging::Debug("IF: {}", bResult? "true" : "false");
+    Logging::Debug("IF: {}", bResult ? "true" : "false");
     if (bResult)
     {
         CHECK_ACCEPT(Node->TrueBody)
     }
-    else
+    else if (Node->FalseBody)
     {
         CHECK_ACCEPT(Node->FalseBody)
     }
@@ -345,11 +459,59 @@ bool Visitor::Visit(AstIf* Node)
     return true;
 }
 
-bool Visitor::Visit(const AstWhile* Node)
+bool Visitor::RunJit(Jit::TRegion* Region, int Count, bool& bEntered)
+{
+    bEntered = true;
+    switch (Region->Run(CurrentFrame, Count))
+    {
+    case Jit::EStatus::GuardFailed :
+        JitCompiler->Stats.GuardFailures++;
+        bEntered = false;
+        return true;
+    case Jit::EStatus::MaxLoop :
+        Logging::Error("ERROR: Hit max loop count ({}).", Runtime::GetContext().MaxLoop);
+        return false;
+    case Jit::EStatus::DivideByZero :
+        Logging::Error("Division by zero.");
+        return false;
+    case Jit::EStatus::DivideOverflow :
+        Logging::Error("Integer overflow dividing {} by -1.", std::numeric_limits<int>::min());
+        return false;
+    default :
+        break;
+    }
+
+    if (TObject* Result = Region->GetResult())
+    {
+        CurrentFrame->Push(Result);
+    }
+    return true;
+}
+
+bool Visitor::Visit(AstWhile* Node)
 {
     DEBUG_ENTER
+    TJitState& JitState = States.Jit[Node->Slot];
+
+    // A compiled loop runs from the start; if its guard fails the loop is interpreted instead
+    if (JitState.State == EJitState::Compiled)
+    {
+        bool bEntered;
+        if (!RunJit(JitState.Region, 1, bEntered))
+        {
+            DEBUG_EXIT
+            return false;
+        }
+        if (bEntered)
+        {
+            DEBUG_EXIT
+            return true;
+        }
+    }
+
     TBoolValue bResult = true;
     int Count = 1;
+    const int MaxLoop = Runtime::GetContext().MaxLoop;
 
     while (bResult)
     {
@@ -366,12 +528,32 @@ bool Visitor::Visit(const AstWhile* Node)
         CHECK_ACCEPT(Node->Body)
 
         Count++;
-        if (Count == WHILE_MAX_LOOP)
+        if (Count == MaxLoop)
         {
-            Logging::Error("ERROR: Hit max loop count ({}).", WHILE_MAX_LOOP);
+            Logging::Error("ERROR: Hit max loop count ({}).", MaxLoop);
 
             CHECK_ERRORS
         }
+
+        // Once the loop is hot, compile it and run the remaining iterations as native code
+        if (JitCompiler && JitState.State == EJitState::Cold && ++JitState.HitCount >= Jit::HOT_LOOP_COUNT)
+        {
+            JitState.Region = JitCompiler->Compile(Node, CurrentFrame);
+            JitState.State = JitState.Region ? EJitState::Compiled : EJitState::Rejected;
+            if (JitState.Region)
+            {
+                bool bEntered;
+                if (!RunJit(JitState.Region, Count, bEntered))
+                {
+                    DEBUG_EXIT
+                    return false;
+                }
+                if (bEntered)
+                {
+                    break;
+                }
+            }
+        }
     }
 
     DEBUG_EXIT
@@ -380,11 +562,12 @@ bool Visitor::Visit(const AstWhile* Node)
 
 bool Visitor::Visit(AstFunction* Node)
 {
+    // Running the same declaration again, as a program run many times does, keeps it
     if (!Functions.contains(Node->Name))
     {
         Functions[Node->Name] = Node;
     }
-    else
+    else if (Functions.at(Node->Name) != Node)
     {
         Logging::Error("Function {} not defined.", Node->Name);
         CHECK_ERRORS
@@ -421,6 +604,11 @@ void Visitor::Dump() const
     std::cout << "Variables:\n";
     for (const auto& [K, V] : CurrentFrame->Identifiers)
     {
+        // Compiled code creates a null binding for each variable it names before the variable is assigned
+        if (!V)
+        {
+            continue;
+        }
         std::cout << K << " : " << V->ToString() << '\n';
     }
 }
@@ -504,6 +692,22 @@ AstNode* Ast::ParseIdentifier()
     const auto IdentifierToken = *CurrentToken;
     Accept(); // Consume the variable
 
+    // 'spawn f(a, b)' is spawn("f", a, b), which runs the call as a task
+    if (Identifier->Name == "spawn" && Expect(Name))
+    {
+        const auto Call = Cast<AstCall>(ParseIdentifier());
+        if (!Call || Call->Type != Function)
+        {
+            Logging::Error("Expected a function call after 'spawn'.");
+            DEBUG_EXIT
+            return nullptr;
+        }
+        std::vector<AstNode*> Args{new AstValue(TObject(Call->Identifier), Call->Context)};
+        Args.insert(Args.end(), Call->Args.begin(), Call->Args.end());
+        DEBUG_EXIT
+        return new AstCall(Identifier->Name, Function, Args, IdentifierToken);
+    }
+
     if (!ExpectAny({LParen, LBracket, Period}))
     {
         DEBUG_EXIT
@@ -524,7 +728,7 @@ AstNode* Ast::ParseIdentifier()
         CallType = Function;
         break;
     default :
-        Logging::Error("Token {} not supported.", TokenToStringMap[StartTok]);
+        Logging::Error("Token {} not supported.", GetTokenString(StartTok));
         DEBUG_EXIT
         return nullptr;
     }
@@ -563,14 +767,17 @@ AstNode* Ast::ParseUnaryExpr()
 {
     DEBUG_ENTER
 
-    AstNode* Expr = ParseValueExpr();
+    // A unary operator comes before its value; a '-' after a value is a binary minus, handled by the caller
     if (ExpectAny({Not, Minus}))
     {
         const auto Op = CurrentToken->Type;
+        const auto OpToken = *CurrentToken;
         Accept(); // Consume '!' or '-'
-        Expr = new AstUnaryExpr(Op, ParseValueExpr(), *CurrentToken);
+        DEBUG_EXIT
+        return new AstUnaryExpr(Op, ParseValueExpr(), OpToken);
     }
 
+    AstNode* Expr = ParseValueExpr();
     DEBUG_EXIT
     return Expr;
 }
@@ -622,6 +829,23 @@ AstNode* Ast::ParseEqualityExpr()
     return Expr;
 }
 
+EValueType Ast::ParseType()
+{
+    DEBUG_ENTER
+
+    if (!Expect(Type))
+    {
+        Logging::Error("Expected a type, got '{}'.", CurrentToken->Content);
+        DEBUG_EXIT
+        return Void;
+    }
+    const EValueType Result = StringTypeMap.at(CurrentToken->Content);
+    Accept(); // Consume type
+
+    DEBUG_EXIT
+    return Result;
+}
+
 AstNode* Ast::ParseAssignment()
 {
     DEBUG_ENTER
@@ -629,6 +853,26 @@ AstNode* Ast::ParseAssignment()
     const std::string Name = CurrentToken->Content; // Get the name
     const Token NameToken = *CurrentToken;
     Accept(); // Consume name
+
+    // MyVar: int = ...;
+    EValueType Annotation = Void;
+    if (Expect(Colon))
+    {
+        Accept(); // Consume ':'
+        Annotation = ParseType();
+        if (Annotation == Void)
+        {
+            DEBUG_EXIT
+            return nullptr;
+        }
+        if (!Expect(Assign))
+        {
+            Logging::Error("Expected '=' after the type of '{}', got '{}'.", Name, CurrentToken->Content);
+            DEBUG_EXIT
+            return nullptr;
+        }
+    }
+
     ETokenType Op = CurrentToken->Type; // Get the assignment operator
     Accept(); // Consume assignment operator
 
@@ -637,8 +881,10 @@ AstNode* Ast::ParseAssignment()
     {
         Expr = new AstBinOp(new AstIdentifier(Name, NameToken), Expr, Op, *CurrentToken);
     }
+    const auto Assignment = new AstAssignment(Name, Expr, NameToken);
+    Assignment->Annotation = Annotation;
     DEBUG_EXIT
-    return new AstAssignment(Name, Expr, NameToken);
+    return Assignment;
 }
 
 AstNode* Ast::ParseParenExpr()
@@ -859,6 +1105,7 @@ AstNode* Ast::ParseFunctionDecl()
     Accept(); // Consume '('
 
     std::vector<std::string> Args;
+    std::vector<EValueType> ArgTypes;
     while (!Expect(RParen))
     {
         if (Expect(Name))
@@ -872,6 +1119,19 @@ AstNode* Ast::ParseFunctionDecl()
             return nullptr;
         }
         Accept(); // Consume argument name
+
+        // Name: type
+        ArgTypes.push_back(Void);
+        if (Expect(Colon))
+        {
+            Accept(); // Consume ':'
+            ArgTypes.back() = ParseType();
+            if (ArgTypes.back() == Void)
+            {
+                DEBUG_EXIT
+                return nullptr;
+            }
+        }
         if (Expect(RParen))
         {
             break;
@@ -886,6 +1146,19 @@ AstNode* Ast::ParseFunctionDecl()
     }
     Accept(); // Consume ')'
 
+    // -> type
+    EValueType ReturnType = Void;
+    if (Expect(Arrow))
+    {
+        Accept(); // Consume '->'
+        ReturnType = ParseType();
+        if (ReturnType == Void)
+        {
+            DEBUG_EXIT
+            return nullptr;
+        }
+    }
+
     const auto Body = ParseCurlyExpr();
     if (!Body)
     {
@@ -894,8 +1167,11 @@ AstNode* Ast::ParseFunctionDecl()
         return nullptr;
     }
 
+    const auto Function = new AstFunction(FuncName, Args, Body, FuncToken);
+    Function->ArgTypes = ArgTypes;
+    Function->ReturnType = ReturnType;
     DEBUG_EXIT
-    return new AstFunction(FuncName, Args, Body, FuncToken);
+    return Function;
 }
 
 AstNode* Ast::ParseExpression()
@@ -910,7 +1186,8 @@ AstNode* Ast::ParseExpression()
     }
 
     // MyVar = ...;
-    if (Expect(Name) && ExpectAssignOperator(1))
+    // MyVar: int = ...;
+    if (Expect(Name) && (ExpectAssignOperator(1) || ExpectSequence({Colon, Type}, 1)))
     {
         Expr = ParseAssignment();
         if (Expect(Semicolon))
@@ -937,7 +1214,7 @@ AstNode* Ast::ParseExpression()
     }
     else if (ExpectAny({Not, Minus}))
     {
-        Expr = ParseUnaryExpr();
+        Expr = ParseEqualityExpr();
     }
     // 5 + ...;
     // "Test" + ...;
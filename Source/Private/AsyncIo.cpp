@@ -0,0 +1,555 @@
+#include "../Public/AsyncIo.h"
+#include "../Public/Core.h"
+
+#include <format>
+#include <fstream>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define ASYNC_IO_URING 1
+    #include <atomic>
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <unordered_set>
+#else
+    #define ASYNC_IO_URING 0
+#endif
+
+using namespace Io;
+
+// Threads in the fallback pool; they spend their time blocked on the disk, so there can be more than cores
+static constexpr int POOL_THREADS = 4;
+
+#if ASYNC_IO_URING
+
+// Operations queued on the ring at once, which bounds how many the completion queue must hold
+static constexpr unsigned RING_ENTRIES = 256;
+
+/// <summary>
+/// An io_uring, set up with raw system calls so no library is needed. Any thread may queue operations; one thread
+/// waits for their completions and finishes the requests they belong to.
+/// </summary>
+class Io::TUring
+{
+    TAsyncIo& Owner;
+    int Ring = -1;
+
+    void* SqMemory = MAP_FAILED;
+    size_t SqSize = 0;
+    void* CqMemory = MAP_FAILED;
+    size_t CqSize = 0;
+    io_uring_sqe* Entries = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t EntriesSize = 0;
+
+    unsigned* SqHead = nullptr;
+    unsigned* SqTail = nullptr;
+    unsigned SqMask = 0;
+    unsigned* SqArray = nullptr;
+    unsigned* CqHead = nullptr;
+    unsigned* CqTail = nullptr;
+    unsigned CqMask = 0;
+    io_uring_cqe* Completions = nullptr;
+
+    std::mutex SubmitMutex;
+    std::condition_variable SlotFreed;
+    unsigned InFlight = 0;
+    std::unordered_set<TRequest*> Outstanding; // Requests with an operation on the ring
+    bool bBroken = false;                      // Set once waiting for completions fails, after which none are queued
+    std::thread Reaper;
+
+    static unsigned Load(unsigned* Value) { return std::atomic_ref(*Value).load(std::memory_order_acquire); }
+    static void Store(unsigned* Value, unsigned New) { std::atomic_ref(*Value).store(New, std::memory_order_release); }
+
+    // Queues one operation and hands it to the kernel. The caller holds SubmitMutex. If the kernel did not take the
+    // operation, it is withdrawn again, so no later submission hands it over for a request the caller has finished.
+    bool Push(uint8_t Opcode, const TRequest* Request)
+    {
+        const unsigned Tail = *SqTail;
+        const unsigned Index = Tail & SqMask;
+        io_uring_sqe& Entry = Entries[Index];
+        std::memset(&Entry, 0, sizeof(Entry));
+        Entry.opcode = Opcode;
+        Entry.user_data = reinterpret_cast<uint64_t>(Request);
+        if (Request)
+        {
+            Entry.fd = Request->File;
+            Entry.off = Request->Done;
+            Entry.len = static_cast<unsigned>(std::min<size_t>(Request->Data.size() - Request->Done, 1u << 30));
+            Entry.addr = reinterpret_cast<uint64_t>(Request->Data.data() + Request->Done);
+        }
+        SqArray[Index] = Index;
+        Store(SqTail, Tail + 1);
+
+        while (true)
+        {
+            const long Submitted = syscall(__NR_io_uring_enter, Ring, 1, 0, 0, nullptr, 0);
+            if (Submitted < 0 && (errno == EINTR || errno == EAGAIN))
+            {
+                continue;
+            }
+            // The kernel only reads entries during io_uring_enter, so if it has not moved past this one it never will
+            if (Submitted > 0 || Load(SqHead) != Tail)
+            {
+                return true;
+            }
+            Store(SqTail, Tail);
+            return false;
+        }
+    }
+
+    static uint8_t GetOpcode(const TRequest* Request)
+    {
+        return Request->Operation == EOperation::Read ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+
+    void Reap()
+    {
+        while (true)
+        {
+            const long Waited = syscall(__NR_io_uring_enter, Ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (Waited < 0 && errno != EINTR)
+            {
+                FailOutstanding(errno);
+                return;
+            }
+
+            unsigned Head = *CqHead;
+            const unsigned Tail = Load(CqTail);
+            {
+                // Requests are queued under the mutex, so taking it orders what was written to them before they were
+                // queued before this thread reads them. The kernel already orders the two; thread sanitizers only
+                // cannot see that.
+                std::lock_guard Lock(SubmitMutex);
+            }
+            bool bStopped = false;
+            for (; Head != Tail; Head++)
+            {
+                const io_uring_cqe& Completion = Completions[Head & CqMask];
+                const auto Request = reinterpret_cast<TRequest*>(Completion.user_data);
+                if (!Request)
+                {
+                    bStopped = true;
+                    continue;
+                }
+                Complete(Request, Completion.res);
+            }
+            Store(CqHead, Head);
+            if (bStopped)
+            {
+                return;
+            }
+        }
+    }
+
+    // Finishes every request still on the ring with an error, once no more completions can be waited for, so nothing
+    // awaiting them waits forever
+    void FailOutstanding(int Error)
+    {
+        std::vector<TRequest*> Failed;
+        {
+            std::lock_guard Lock(SubmitMutex);
+            bBroken = true;
+            Failed.assign(Outstanding.begin(), Outstanding.end());
+            Outstanding.clear();
+            InFlight = 0;
+        }
+        SlotFreed.notify_all();
+        for (TRequest* Request : Failed)
+        {
+            close(Request->File);
+            Request->Error = std::format("Unable to {} '{}': {}.",
+                                         Request->Operation == EOperation::Read ? "read" : "write", Request->Path,
+                                         std::strerror(Error));
+            Owner.Finish(Request);
+        }
+    }
+
+    void Complete(TRequest* Request, int Result)
+    {
+        const bool bRead = Request->Operation == EOperation::Read;
+        if (Result < 0)
+        {
+            Request->Error = std::format("Unable to {} '{}': {}.", bRead ? "read" : "write", Request->Path,
+                                         std::strerror(-Result));
+        }
+        else if (Result == 0)
+        {
+            // A read stops early if the file shrank since it was opened; a write making no progress has failed
+            if (bRead)
+            {
+                Request->Data.resize(Request->Done);
+            }
+            else
+            {
+                Request->Error = std::format("Unable to write '{}'.", Request->Path);
+            }
+        }
+        else
+        {
+            Request->Done += Result;
+            if (Request->Done < Request->Data.size())
+            {
+                // A short transfer takes the slot of the one which just completed
+                std::lock_guard Lock(SubmitMutex);
+                if (Push(GetOpcode(Request), Request))
+                {
+                    return;
+                }
+                Request->Error = std::format("Unable to queue I/O for '{}'.", Request->Path);
+            }
+        }
+
+        close(Request->File);
+        {
+            std::lock_guard Lock(SubmitMutex);
+            Outstanding.erase(Request);
+            InFlight--;
+        }
+        SlotFreed.notify_all();
+        Owner.Finish(Request);
+    }
+
+public:
+    explicit TUring(TAsyncIo& InOwner)
+        : Owner(InOwner)
+    {
+        io_uring_params Params{};
+        Ring = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &Params));
+        if (Ring < 0)
+        {
+            return;
+        }
+
+        SqSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+        CqSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+        if (Params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            SqSize = CqSize = std::max(SqSize, CqSize);
+        }
+        SqMemory = mmap(nullptr, SqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring, IORING_OFF_SQ_RING);
+        if (SqMemory == MAP_FAILED)
+        {
+            return;
+        }
+        if (Params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            CqMemory = SqMemory;
+        }
+        else
+        {
+            CqMemory = mmap(nullptr, CqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, Ring,
+                            IORING_OFF_CQ_RING);
+            if (CqMemory == MAP_FAILED)
+            {
+                return;
+            }
+        }
+        EntriesSize = Params.sq_entries * sizeof(io_uring_sqe);
+        Entries = static_cast<io_uring_sqe*>(mmap(nullptr, EntriesSize, PROT_READ | PROT_WRITE,
+                                                  MAP_SHARED | MAP_POPULATE, Ring, IORING_OFF_SQES));
+        if (Entries == MAP_FAILED)
+        {
+            return;
+        }
+
+        const auto Sq = static_cast<char*>(SqMemory);
+        SqHead = reinterpret_cast<unsigned*>(Sq + Params.sq_off.head);
+        SqTail = reinterpret_cast<unsigned*>(Sq + Params.sq_off.tail);
+        SqMask = *reinterpret_cast<unsigned*>(Sq + Params.sq_off.ring_mask);
+        SqArray = reinterpret_cast<unsigned*>(Sq + Params.sq_off.array);
+        const auto Cq = static_cast<char*>(CqMemory);
+        CqHead = reinterpret_cast<unsigned*>(Cq + Params.cq_off.head);
+        CqTail = reinterpret_cast<unsigned*>(Cq + Params.cq_off.tail);
+        CqMask = *reinterpret_cast<unsigned*>(Cq + Params.cq_off.ring_mask);
+        Completions = reinterpret_cast<io_uring_cqe*>(Cq + Params.cq_off.cqes);
+
+        Reaper = std::thread(&TUring::Reap, this);
+    }
+
+    ~TUring()
+    {
+        if (Reaper.joinable())
+        {
+            // Operations in flight write into their requests, so they must finish before the ring goes
+            std::unique_lock Lock(SubmitMutex);
+            SlotFreed.wait(Lock, [this] { return InFlight == 0; });
+            if (!bBroken && !Push(IORING_OP_NOP, nullptr))
+            {
+                // Nothing can wake the completion thread, which may still be waiting on the ring, so both are left
+                Reaper.detach();
+                return;
+            }
+            Lock.unlock();
+            Reaper.join();
+        }
+        if (Entries != MAP_FAILED)
+        {
+            munmap(Entries, EntriesSize);
+        }
+        if (CqMemory != MAP_FAILED && CqMemory != SqMemory)
+        {
+            munmap(CqMemory, CqSize);
+        }
+        if (SqMemory != MAP_FAILED)
+        {
+            munmap(SqMemory, SqSize);
+        }
+        if (Ring >= 0)
+        {
+            close(Ring);
+        }
+    }
+
+    bool IsValid() const { return Reaper.joinable(); }
+
+    /// <summary>
+    /// Opens the request's file and queues its transfer.
+    /// </summary>
+    /// <returns>False if the file's size is unknown until it has been read, as for pipes or files which report a
+    /// size of 0, such as those under /proc, or once the ring has failed; the request is left for the caller.</returns>
+    bool Submit(TRequest* Request)
+    {
+        const bool bRead = Request->Operation == EOperation::Read;
+        Request->File = bRead
+                        ? open(Request->Path.c_str(), O_RDONLY | O_CLOEXEC)
+                        : open(Request->Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (Request->File < 0)
+        {
+            Request->Error = bRead
+                             ? std::format("File '{}' not found.", Request->Path)
+                             : std::format("Unable to open '{}' for writing.", Request->Path);
+            Owner.Finish(Request);
+            return true;
+        }
+        if (bRead)
+        {
+            struct stat Status{};
+            if (fstat(Request->File, &Status) != 0 || !S_ISREG(Status.st_mode) || Status.st_size == 0)
+            {
+                close(Request->File);
+                Request->File = -1;
+                return false;
+            }
+            Request->Data.resize(Status.st_size);
+        }
+        if (Request->Data.empty())
+        {
+            close(Request->File);
+            Owner.Finish(Request);
+            return true;
+        }
+
+        // Each operation is handed to the kernel as it is queued, so only the completion queue, twice the size of the
+        // submission queue, fills up; keeping to RING_ENTRIES in flight means it never overflows
+        std::unique_lock Lock(SubmitMutex);
+        SlotFreed.wait(Lock, [this] { return bBroken || InFlight < RING_ENTRIES; });
+        if (bBroken)
+        {
+            // The pool takes over once the ring has failed
+            Lock.unlock();
+            close(Request->File);
+            Request->File = -1;
+            return false;
+        }
+        InFlight++;
+        if (!Push(GetOpcode(Request), Request))
+        {
+            InFlight--;
+            Lock.unlock();
+            close(Request->File);
+            Request->Error = std::format("Unable to queue I/O for '{}'.", Request->Path);
+            Owner.Finish(Request);
+            return true;
+        }
+        Outstanding.insert(Request);
+        return true;
+    }
+};
+
+#else
+
+class Io::TUring
+{
+public:
+    explicit TUring(TAsyncIo&) {}
+    bool IsValid() const { return false; }
+    bool Submit(TRequest*) { return false; }
+};
+
+#endif
+
+TAsyncIo::TAsyncIo(EBackend Preferred)
+    : Backend(EBackend::Threads)
+{
+    if (Preferred == EBackend::Uring)
+    {
+        Uring = std::make_unique<TUring>(*this);
+        if (Uring->IsValid())
+        {
+            Backend = EBackend::Uring;
+        }
+        else
+        {
+            Uring.reset();
+        }
+    }
+}
+
+TAsyncIo::~TAsyncIo()
+{
+    Uring.reset();
+    {
+        std::lock_guard Lock(PoolMutex);
+        bStopping = true;
+    }
+    PoolSignal.notify_all();
+    for (std::thread& Thread : Pool)
+    {
+        Thread.join();
+    }
+}
+
+void TAsyncIo::Submit(TRequest* Request)
+{
+    if (Uring && Uring->Submit(Request))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard Lock(PoolMutex);
+        if (Pool.empty())
+        {
+            for (int Index = 0; Index < POOL_THREADS; Index++)
+            {
+                Pool.emplace_back(&TAsyncIo::RunPool, this);
+            }
+        }
+        Pending.push_back(Request);
+    }
+    PoolSignal.notify_one();
+}
+
+void TAsyncIo::RunPool()
+{
+    while (true)
+    {
+        TRequest* Request;
+        {
+            std::unique_lock Lock(PoolMutex);
+            PoolSignal.wait(Lock, [this] { return bStopping || !Pending.empty(); });
+            if (Pending.empty())
+            {
+                return;
+            }
+            Request = Pending.front();
+            Pending.pop_front();
+        }
+        Transfer(*Request);
+        Finish(Request);
+    }
+}
+
+void TAsyncIo::Transfer(TRequest& Request)
+{
+    if (Request.Operation == EOperation::Read)
+    {
+        std::optional<std::string> Contents = Core::ReadFile(Request.Path);
+        if (!Contents)
+        {
+            Request.Error = std::format("File '{}' not found.", Request.Path);
+            return;
+        }
+        Request.Data = std::move(*Contents);
+        Request.Done = Request.Data.size();
+        return;
+    }
+
+    std::ofstream Stream(Request.Path, std::ios::binary | std::ios::trunc);
+    if (!Stream.good())
+    {
+        Request.Error = std::format("Unable to open '{}' for writing.", Request.Path);
+        return;
+    }
+    if (!Stream.write(Request.Data.data(), static_cast<std::streamsize>(Request.Data.size())))
+    {
+        Request.Error = std::format("Unable to write '{}'.", Request.Path);
+        return;
+    }
+    Request.Done = Request.Data.size();
+}
+
+void TAsyncIo::Finish(TRequest* Request)
+{
+    Request->bDone.store(true, std::memory_order_release);
+    Finished.Notify();
+}
+
+int TAsyncIo::Read(const std::string& Path)
+{
+    auto Request = std::make_unique<TRequest>();
+    Request->Operation = EOperation::Read;
+    Request->Path = Path;
+    TRequest* Started = Request.get();
+    int Handle;
+    {
+        std::lock_guard Lock(RequestsMutex);
+        Handle = NextHandle++;
+        Requests.emplace(Handle, std::move(Request));
+    }
+    Submit(Started);
+    return Handle;
+}
+
+int TAsyncIo::Write(const std::string& Path, const std::string& Data)
+{
+    auto Request = std::make_unique<TRequest>();
+    Request->Operation = EOperation::Write;
+    Request->Path = Path;
+    Request->Data = Data;
+    TRequest* Started = Request.get();
+    int Handle;
+    {
+        std::lock_guard Lock(RequestsMutex);
+        Handle = NextHandle++;
+        Requests.emplace(Handle, std::move(Request));
+    }
+    Submit(Started);
+    return Handle;
+}
+
+std::unique_ptr<TRequest> TAsyncIo::Await(int Handle)
+{
+    std::unique_ptr<TRequest> Request;
+    {
+        std::lock_guard Lock(RequestsMutex);
+        const auto It = Requests.find(Handle);
+        if (It == Requests.end())
+        {
+            return nullptr;
+        }
+        Request = std::move(It->second);
+        Requests.erase(It);
+    }
+
+    Finished.Wait([&Request] { return Request->bDone.load(std::memory_order_acquire); });
+    return Request;
+}
+
+static EBackend PreferredBackend = EBackend::Uring;
+
+void Io::SetBackend(EBackend Backend)
+{
+    PreferredBackend = Backend;
+}
+
+TAsyncIo& Io::GetAsyncIo()
+{
+    static TAsyncIo AsyncIo(PreferredBackend);
+    return AsyncIo;
+}
@@ -1,234 +1,662 @@
-#include <fstream>
-#include <iostream>
+#include <chrono>
 
+#include "../Public/AsyncIo.h"
 #include "../Public/BuiltIns.h"
+#include "../Public/Channel.h"
+#include "../Public/Context.h"
 #include "../Public/Core.h"
+#include "../Public/LineReader.h"
+#include "../Public/Output.h"
+#include "../Public/Simd.h"
+#include "../Public/Tasks.h"
 
 using namespace BuiltIns;
 
-#define CHECK_MIN_ARG_COUNT(Args, Count)                                                            \
-    if ((Args)->size() < (Count))                                                                       \
-    {                                                                                               \
-        Logging::Error("Invalid argument count. Wanted at least {}, got {}.", Count, (Args)->size()); \
-        bResult = false;                                                                            \
-        return;                                                                                     \
+void BuiltIns::Print(const TObject& Value)
+{
+    Runtime::GetContext().Output.WriteLine(Value.ToString());
+}
+
+std::optional<TObject> BuiltIns::Printf(const std::string& Format, TArgumentList Values)
+{
+    // Compiled on the first call with this format, so later calls only copy its text and format the values
+    const Formatting::TFormat& Compiled = Runtime::GetContext().Formats.Get(Format);
+    if (!Compiled.IsValid())
+    {
+        Logging::Error("{}", Compiled.GetError());
+        return std::nullopt;
+    }
+    if (Compiled.GetFieldCount() != Values.size())
+    {
+        Logging::Error("Printf argument count mismatch. Wanted {}, got {}.", Compiled.GetFieldCount(), Values.size());
+        return std::nullopt;
     }
-#define CHECK_EXACT_ARG_COUNT(Args, Count)                                                 \
-    if ((Args)->size() != (Count))                                                             \
-    {                                                                                      \
-        Logging::Error("Invalid argument count. Wanted {}, got {}.", Count, (Args)->size()); \
-        bResult = false;                                                                   \
-        return;                                                                            \
+
+    if (!Runtime::GetContext().Output.BuildLine([&](std::string& Out) { return Compiled.Write(Out, Values); }))
+    {
+        return std::nullopt;
     }
+    return TObject();
+}
+
+void BuiltIns::Flush()
+{
+    Runtime::GetContext().Output.Flush();
+}
 
-void BuiltIns::Print_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+void BuiltIns::Append(TArrayValue& Array, const TObject& Value)
 {
-    CHECK_EXACT_ARG_COUNT(Arguments, 1)
+    Array.Append(Value);
+}
 
-    std::vector<TObject> Objects;
-    for (const std::shared_ptr<TIdentifier>& Arg : *Arguments)
+std::optional<std::string> BuiltIns::ReadFile(const std::string& FileName)
+{
+    std::optional<std::string> Contents = Core::ReadFile(FileName);
+    if (!Contents)
     {
-        if (!Arg->IsValid())
-        {
-            Logging::Error("{}", Arg->ToString());
-            bResult = false;
-            return;
-        }
-        TObject Value = Arg->GetValue();
-        Objects.emplace_back(Value);
+        Logging::Error("File '{}' not found.", FileName);
     }
-    const std::string Out = TStringValue::Join(Objects, ",");
-    std::cout << Out << '\n';
+    return Contents;
+}
 
-    bResult = true;
+int BuiltIns::ReadAsync(const std::string& FileName)
+{
+    return Io::GetAsyncIo().Read(FileName);
 }
 
-void BuiltIns::Printf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+int BuiltIns::WriteAsync(const std::string& FileName, const std::string& Text)
 {
-    CHECK_MIN_ARG_COUNT(Arguments, 2)
+    return Io::GetAsyncIo().Write(FileName, Text);
+}
 
-    TObject Arg1 = Arguments->at(0)->GetValue();
-    if (Arg1.GetType() != StringType)
+std::optional<TObject> BuiltIns::Await(int Handle)
+{
+    // A task waiting on the disk is suspended, so its worker runs other tasks meanwhile
+    const auto Request = Io::GetAsyncIo().Await(Handle);
+    if (!Request)
+    {
+        Logging::Error("I/O request {} does not exist.", Handle);
+        return std::nullopt;
+    }
+    if (!Request->Error.empty())
     {
-        Logging::Error("Wanted 'string' for first argument, got ", Arg1.ToString());
-        bResult = false;
-        return;
+        Logging::Error("{}", Request->Error);
+        return std::nullopt;
     }
+    // The request is ours, so the contents are moved out of it rather than copied
+    if (Request->Operation == Io::EOperation::Read)
+    {
+        TObject Contents;
+        Contents.SetString(std::move(Request->Data));
+        return Contents;
+    }
+    return TObject(static_cast<int>(Request->Done));
+}
 
-    // Get the format string (first argument)
-    std::string Fmt = Arg1.GetString().GetValue();
-    size_t ArgCount = 0;
-    std::string::size_type Pos = 0;
+std::optional<TObject> BuiltIns::OpenFile(const std::string& FileName)
+{
+    std::shared_ptr<Io::TLineReader> Reader = Io::TLineReader::Open(FileName);
+    if (!Reader)
+    {
+        Logging::Error("File '{}' not found.", FileName);
+        return std::nullopt;
+    }
+    return TFileValue(std::move(Reader));
+}
 
-    while ((Pos = Fmt.find("{}", Pos)) != std::string::npos)
+bool BuiltIns::NextLine(const TFileValue& File, TObject& Line)
+{
+    // Reading into the string the variable already holds reuses its buffer, so a loop over lines does not allocate
+    std::string Text;
+    if (Line.GetType() == StringType)
     {
-        ArgCount++;
-        Pos += 2;
+        Text = Line.AsString()->TakeValue();
     }
+    const bool bRead = File.GetValue().Next(Text);
+    Line.SetString(std::move(Text));
+    return bRead;
+}
+
+void BuiltIns::CloseFile(const TFileValue& File)
+{
+    File.GetValue().Close();
+}
 
-    if (ArgCount != Arguments->size() - 1)
+std::optional<TObject> BuiltIns::IndexOf(const TObject& Container, int Index)
+{
+    size_t Size;
+    switch (Container.GetType())
+    {
+    case StringType :
+        Size = Container.RawString().size();
+        break;
+    case ArrayType :
+        Size = Container.AsArray()->GetValue().size();
+        break;
+    default :
+        Logging::Error("Type does not have an 'index'.");
+        return std::nullopt;
+    }
+    if (Index < 0 || static_cast<size_t>(Index) >= Size)
     {
-        Logging::Error("Printf argument count mismatch. Wanted {}, got {}.", ArgCount, Arguments->size() - 1);
-        bResult = false;
-        return;
+        Logging::Error("Index {} is out of range for size {}.", Index, Size);
+        return std::nullopt;
+    }
+
+    if (Container.GetType() == StringType)
+    {
+        return TObject(Container.RawString()[Index]);
+    }
+    return Container.AsArray()->GetValue()[Index];
+}
+
+std::optional<int> BuiltIns::SizeOf(const TObject& Container)
+{
+    size_t Size = 0;
+    switch (Container.GetType())
+    {
+    case StringType :
+        Size = Container.AsString()->GetValue().size();
+        break;
+    case ArrayType :
+        Size = Container.AsArray()->GetValue().size();
+        break;
+    case MapType :
+        Size = Container.AsMap()->GetValue().Size();
+        break;
+    default :
+        Logging::Error("Type does not have a 'size'.");
+        return std::nullopt;
     }
 
-    // Pop the first argument off so we can loop through the rest
-    // Arguments->erase(Arguments->begin(), Arguments->begin());
+    return static_cast<int>(Size);
+}
 
-    std::vector<TObject> Objects;
-    for (auto [Index, Arg] : Enumerate(*Arguments))
+std::optional<bool> BuiltIns::Contains(const TObject& Container, const TObject& Value)
+{
+    switch (Container.GetType())
     {
-        // Skip the first argument
-        if (Index == 0)
+    case StringType :
+    case MapType :
+        if (Value.GetType() != StringType)
+        {
+            Logging::Error("Wanted a string to search for.");
+            return std::nullopt;
+        }
+        if (Container.GetType() == StringType)
         {
-            continue;
+            return Container.RawString().find(Value.RawString()) != std::string::npos;
         }
+        // Looks up the key in place, without copying it out of the argument
+        return Container.AsMap()->HasKey(Value.RawString());
+    case ArrayType :
+        return Container.AsArray()->Contains(Value);
+    default :
+        Logging::Error("Type is not a 'container'.");
+        return std::nullopt;
+    }
+}
 
-        if (!Arg->IsValid())
+std::optional<TObject> BuiltIns::Range(int Count)
+{
+    if (Count < 0)
+    {
+        Logging::Error("Range size must not be negative, got {}.", Count);
+        return std::nullopt;
+    }
+    TArray Elements;
+    Elements.reserve(Count);
+    for (int Index = 0; Index < Count; Index++)
+    {
+        Elements.emplace_back(Index);
+    }
+    return TArrayValue(std::move(Elements));
+}
+
+/////////////////
+// SIMD arrays //
+/////////////////
+
+// A numeric array unboxed into contiguous memory so it can be handed to the SIMD kernels. Arrays of only ints stay
+// ints; any float element promotes the whole array to floats, matching the implicit casting of the operators.
+struct TPackedArray
+{
+    EValueType Type = IntType;
+    std::vector<int> Ints;
+    std::vector<float> Floats;
+
+    size_t Size() const { return Type == IntType ? Ints.size() : Floats.size(); }
+
+    void PromoteToFloat()
+    {
+        if (Type == FloatType)
         {
-            Logging::Error("{}", Arg->ToString());
-            bResult = false;
             return;
         }
-        TObject Value = Arg->GetValue();
-        Objects.emplace_back(Value.ToString());
+        Floats.assign(Ints.begin(), Ints.end());
+        Ints.clear();
+        Type = FloatType;
     }
 
-    int Index = 0; // Start at the second argument as the first is the fmt string itself
-    std::string Out = Fmt;
-    while (Out.find("{}") != std::string::npos)
+    TObject Box() const
     {
-        const auto First = Out.find_first_of("{}");
-        auto Offset = Out.begin() + First;
-        Out.replace(Offset, Offset + 2, Objects.at(Index).ToString().c_str());
-        Index++;
+        TArray Result;
+        Result.reserve(Size());
+        if (Type == IntType)
+        {
+            for (const int V : Ints)
+            {
+                Result.emplace_back(V);
+            }
+        }
+        else
+        {
+            for (const float V : Floats)
+            {
+                Result.emplace_back(V);
+            }
+        }
+        return TArrayValue(std::move(Result));
     }
-    std::cout << Out << '\n';
-    bResult = true;
 };
 
-void BuiltIns::Append_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+static bool IsNumber(const TObject* Object)
+{
+    return Object->GetType() == IntType || Object->GetType() == FloatType;
+}
+
+// Unboxes in a single pass. The elements' types were just checked, so their values are read without casting.
+static bool PackArray(const TObject* Object, TPackedArray& Out)
+{
+    if (Object->GetType() != ArrayType)
+    {
+        return false;
+    }
+
+    const TArray& Elements = Object->AsArray()->GetValue();
+    Out.Type = IntType;
+    Out.Ints.reserve(Elements.size());
+    for (const TObject& Element : Elements)
+    {
+        const EValueType Type = Element.GetType();
+        if (Type == IntType)
+        {
+            if (Out.Type == IntType)
+            {
+                Out.Ints.push_back(Element.RawInt());
+            }
+            else
+            {
+                Out.Floats.push_back(static_cast<float>(Element.RawInt()));
+            }
+        }
+        else if (Type == FloatType)
+        {
+            if (Out.Type == IntType)
+            {
+                Out.PromoteToFloat();
+                Out.Floats.reserve(Elements.size());
+            }
+            Out.Floats.push_back(Element.RawFloat());
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::optional<TObject> ArrayBinaryOp(Simd::EArrayOp Op, const TObject& LeftArg, const TObject& RightArg)
+{
+    const TObject* Left = &LeftArg;
+    const TObject* Right = &RightArg;
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    TPackedArray A;
+    TPackedArray Out;
+
+    // Array op array
+    if (Left->GetType() == ArrayType && Right->GetType() == ArrayType)
+    {
+        TPackedArray B;
+        if (!PackArray(Left, A) || !PackArray(Right, B))
+        {
+            Logging::Error("Wanted numeric arrays.");
+            return std::nullopt;
+        }
+        if (A.Size() != B.Size())
+        {
+            Logging::Error("Array size mismatch. Got {} and {}.", A.Size(), B.Size());
+            return std::nullopt;
+        }
+        if (A.Type == FloatType || B.Type == FloatType)
+        {
+            A.PromoteToFloat();
+            B.PromoteToFloat();
+            Out.Type = FloatType;
+            Out.Floats.resize(A.Size());
+            Kernels.Float.Binary[Op](A.Floats.data(), B.Floats.data(), Out.Floats.data(), A.Size());
+        }
+        else
+        {
+            if (Op == Simd::Div)
+            {
+                for (size_t Index = 0; Index < A.Size(); Index++)
+                {
+                    if (!CanDivide(A.Ints[Index], B.Ints[Index]))
+                    {
+                        return std::nullopt;
+                    }
+                }
+            }
+            Out.Ints.resize(A.Size());
+            Kernels.Int.Binary[Op](A.Ints.data(), B.Ints.data(), Out.Ints.data(), A.Size());
+        }
+        return Out.Box();
+    }
+
+    // Array op scalar, or scalar op array
+    const bool bReversed = Left->GetType() != ArrayType;
+    const TObject* Array = bReversed ? Right : Left;
+    const TObject* Scalar = bReversed ? Left : Right;
+    if (!PackArray(Array, A) || !IsNumber(Scalar))
+    {
+        Logging::Error("Wanted a numeric array and a number.");
+        return std::nullopt;
+    }
+
+    if (A.Type == FloatType || Scalar->GetType() == FloatType)
+    {
+        A.PromoteToFloat();
+        const float S = Scalar->GetType() == IntType ? static_cast<float>(Scalar->AsInt()->GetValue())
+                                                     : Scalar->AsFloat()->GetValue();
+        Out.Type = FloatType;
+        Out.Floats.resize(A.Size());
+        const auto Kernel = bReversed ? Kernels.Float.BroadcastReversed[Op] : Kernels.Float.Broadcast[Op];
+        Kernel(A.Floats.data(), S, Out.Floats.data(), A.Size());
+    }
+    else
+    {
+        const int S = Scalar->AsInt()->GetValue();
+        if (Op == Simd::Div)
+        {
+            for (const int Element : A.Ints)
+            {
+                if (!(bReversed ? CanDivide(S, Element) : CanDivide(Element, S)))
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+        Out.Ints.resize(A.Size());
+        const auto Kernel = bReversed ? Kernels.Int.BroadcastReversed[Op] : Kernels.Int.Broadcast[Op];
+        Kernel(A.Ints.data(), S, Out.Ints.data(), A.Size());
+    }
+    return Out.Box();
+}
+
+std::optional<TObject> BuiltIns::VecAdd(const TObject& Left, const TObject& Right)
 {
-    CHECK_EXACT_ARG_COUNT(Arguments, 2)
+    return ArrayBinaryOp(Simd::Add, Left, Right);
+}
 
-    const auto Arg1 = Cast<TVariable>(Arguments->at(0).get());
-    const auto Arg2 = Arguments->at(1);
+std::optional<TObject> BuiltIns::VecSub(const TObject& Left, const TObject& Right)
+{
+    return ArrayBinaryOp(Simd::Sub, Left, Right);
+}
 
-    const TObject Value = Arg2->GetValue();
+std::optional<TObject> BuiltIns::VecMul(const TObject& Left, const TObject& Right)
+{
+    return ArrayBinaryOp(Simd::Mul, Left, Right);
+}
 
-    Arg1->GetValuePtr()->AsArray()->Append(Value);
-    bResult = true;
+std::optional<TObject> BuiltIns::VecDiv(const TObject& Left, const TObject& Right)
+{
+    return ArrayBinaryOp(Simd::Div, Left, Right);
 }
 
-void BuiltIns::ReadFile_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+// Packs the single array argument shared by the reductions. Min and max have no identity, so they also need at least
+// one element.
+static bool PackSingleArray(const TObject& Array, TPackedArray& Packed, bool bNonEmpty)
 {
-    CHECK_EXACT_ARG_COUNT(Arguments, 1)
+    if (!PackArray(&Array, Packed))
+    {
+        Logging::Error("Wanted a numeric array.");
+        return false;
+    }
+    if (bNonEmpty && Packed.Size() == 0)
+    {
+        Logging::Error("Array is empty.");
+        return false;
+    }
+    return true;
+}
 
-    auto Arg1 = Arguments->at(0)->GetValue();
-    if (Arg1.GetType() != StringType)
+std::optional<TObject> BuiltIns::Sum(const TObject& Array)
+{
+    TPackedArray A;
+    if (!PackSingleArray(Array, A, false))
     {
-        bResult = false;
-        Logging::Error("Wanted a string as the first argument.");
-        return;
+        return std::nullopt;
     }
 
-    const auto FileName = Arg1.GetString();
-    std::ifstream Stream(FileName.GetValue().c_str());
-    if (!Stream.good())
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    if (A.Type == IntType)
+    {
+        return Kernels.Int.Sum(A.Ints.data(), A.Size());
+    }
+    else
     {
-        bResult = false;
-        Logging::Error("File '{}' not found.", FileName.GetValue());
-        return;
+        return Kernels.Float.Sum(A.Floats.data(), A.Size());
     }
+}
 
-    const auto Content = std::string(std::istreambuf_iterator<char>(Stream), std::istreambuf_iterator<char>());
-    *ReturnValue = Content;
+std::optional<TObject> BuiltIns::Min(const TObject& Array)
+{
+    TPackedArray A;
+    if (!PackSingleArray(Array, A, true))
+    {
+        return std::nullopt;
+    }
 
-    bResult = true;
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    if (A.Type == IntType)
+    {
+        return Kernels.Int.Min(A.Ints.data(), A.Size());
+    }
+    else
+    {
+        return Kernels.Float.Min(A.Floats.data(), A.Size());
+    }
 }
 
-void BuiltIns::IndexOf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+std::optional<TObject> BuiltIns::Max(const TObject& Array)
 {
-    // size_of ( container, index, out )
-    CHECK_EXACT_ARG_COUNT(Arguments, 2)
+    TPackedArray A;
+    if (!PackSingleArray(Array, A, true))
+    {
+        return std::nullopt;
+    }
 
-    auto Container = Arguments->at(0)->GetValue();
-    const auto Index = Arguments->at(1)->GetValue().GetInt().GetValue();
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    if (A.Type == IntType)
+    {
+        return Kernels.Int.Max(A.Ints.data(), A.Size());
+    }
+    else
+    {
+        return Kernels.Float.Max(A.Floats.data(), A.Size());
+    }
+}
 
-    TObject Value;
-    switch (Container.GetType())
+std::optional<TObject> BuiltIns::PrefixSum(const TObject& Array)
+{
+    TPackedArray A;
+    if (!PackSingleArray(Array, A, false))
     {
-    case StringType :
-        Value = Container.GetString().GetValue().at(Index);
-        break;
-    case ArrayType :
-        Value = Container.GetArray().GetValue().at(Index);
-        break;
-    default :
-        bResult = false;
-        Logging::Error("Type does not have an 'index'.");
-        return;
+        return std::nullopt;
     }
 
-    *ReturnValue = Value;
-    bResult = true;
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    TPackedArray Out;
+    Out.Type = A.Type;
+    if (A.Type == IntType)
+    {
+        Out.Ints.resize(A.Size());
+        Kernels.Int.PrefixSum(A.Ints.data(), Out.Ints.data(), A.Size());
+    }
+    else
+    {
+        Out.Floats.resize(A.Size());
+        Kernels.Float.PrefixSum(A.Floats.data(), Out.Floats.data(), A.Size());
+    }
+    return Out.Box();
 }
 
-void BuiltIns::SizeOf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+std::optional<TObject> BuiltIns::Dot(const TObject& Left, const TObject& Right)
 {
-    CHECK_EXACT_ARG_COUNT(Arguments, 1)
+    TPackedArray A;
+    TPackedArray B;
+    if (!PackArray(&Left, A) || !PackArray(&Right, B))
+    {
+        Logging::Error("Wanted numeric arrays.");
+        return std::nullopt;
+    }
+    if (A.Size() != B.Size())
+    {
+        Logging::Error("Array size mismatch. Got {} and {}.", A.Size(), B.Size());
+        return std::nullopt;
+    }
 
-    auto Container = Arguments->at(0)->GetValue();
+    const Simd::TKernels& Kernels = Simd::GetKernels();
+    if (A.Type == IntType && B.Type == IntType)
+    {
+        return Kernels.Int.Dot(A.Ints.data(), B.Ints.data(), A.Size());
+    }
+    else
+    {
+        A.PromoteToFloat();
+        B.PromoteToFloat();
+        return Kernels.Float.Dot(A.Floats.data(), B.Floats.data(), A.Size());
+    }
+}
 
-    size_t Size = 0;
-    switch (Container.GetType())
+//////////
+// Time //
+//////////
+
+float BuiltIns::Clock()
+{
+    // Milliseconds since the first call; only differences between two calls are meaningful.
+    static const auto Start = std::chrono::steady_clock::now();
+    const std::chrono::duration<float, std::milli> Elapsed = std::chrono::steady_clock::now() - Start;
+    return Elapsed.count();
+}
+
+///////////
+// Tasks //
+///////////
+
+std::optional<int> BuiltIns::Spawn(const std::string& Function, TArgumentList Arguments)
+{
+    Tasks::TScheduler* Scheduler = Runtime::GetContext().Scheduler;
+    if (!Scheduler)
     {
-    case StringType :
-        Size = Container.AsString()->GetValue().size();
-        break;
-    case ArrayType :
-        Size = Container.AsArray()->GetValue().size();
-        break;
-    case MapType :
-        Size = Container.AsMap()->GetValue().size();
-        break;
-    default :
-        bResult = false;
-        Logging::Error("Type does not have a 'size'.");
-        return;
+        Logging::Error("Tasks can only be spawned by scripts.");
+        return std::nullopt;
     }
+    return Scheduler->Spawn(Function, Arguments);
+}
 
-    *ReturnValue = static_cast<int>(Size);
-    bResult = true;
+std::optional<TObject> BuiltIns::Join(int Handle)
+{
+    Tasks::TScheduler* Scheduler = Runtime::GetContext().Scheduler;
+    if (!Scheduler)
+    {
+        Logging::Error("Tasks can only be joined by scripts.");
+        return std::nullopt;
+    }
+    TObject Result;
+    if (!Scheduler->Join(Handle, Result))
+    {
+        return std::nullopt;
+    }
+    return Result;
 }
 
-void BuiltIns::Contains_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult)
+static Tasks::TScheduler* GetParallelScheduler(const std::string& Name)
 {
-    CHECK_EXACT_ARG_COUNT(Arguments, 2)
+    Tasks::TScheduler* Scheduler = Runtime::GetContext().Scheduler;
+    if (!Scheduler)
+    {
+        Logging::Error("'{}' can only be called by scripts.", Name);
+    }
+    return Scheduler;
+}
 
-    auto Container = Arguments->at(0)->GetValue();
-    const auto Value = Arguments->at(1)->GetValue();
+std::optional<TObject> BuiltIns::ParMap(const std::string& Function, const TArrayValue& Array)
+{
+    Tasks::TScheduler* Scheduler = GetParallelScheduler("par_map");
+    if (!Scheduler)
+    {
+        return std::nullopt;
+    }
+    return Scheduler->Map(Function, Array.GetValue());
+}
 
-    bool bContainsValue;
-    switch (Container.GetType())
+std::optional<TObject> BuiltIns::ParFilter(const std::string& Function, const TArrayValue& Array)
+{
+    Tasks::TScheduler* Scheduler = GetParallelScheduler("par_filter");
+    if (!Scheduler)
     {
-    case StringType :
-        bContainsValue = Container.AsString()->GetValue().find(Value.GetString().GetValue()) != std::string::npos;
-        break;
-    case ArrayType :
-        bContainsValue = Container.AsArray()->Contains(Value);
-        break;
-    case MapType :
-        bContainsValue = Container.AsMap()->HasKey(Value.AsString()->GetValue());
-        break;
-    default :
-        bResult = false;
-        Logging::Error("Type is not a 'container'.");
-        return;
+        return std::nullopt;
+    }
+    return Scheduler->Filter(Function, Array.GetValue());
+}
+
+std::optional<TObject> BuiltIns::ParReduce(const std::string& Function, const TArrayValue& Array,
+                                           const TObject& Initial)
+{
+    Tasks::TScheduler* Scheduler = GetParallelScheduler("par_reduce");
+    if (!Scheduler)
+    {
+        return std::nullopt;
     }
-    *ReturnValue = bContainsValue;
-    bResult = true;
+    return Scheduler->Reduce(Function, Array.GetValue(), Initial);
+}
+
+//////////////
+// Channels //
+//////////////
+
+std::optional<TObject> BuiltIns::Channel(int Capacity)
+{
+    if (Capacity < 1)
+    {
+        Logging::Error("Channel capacity must be at least 1, got {}.", Capacity);
+        return std::nullopt;
+    }
+    if (static_cast<size_t>(Capacity) > Tasks::MAX_CHANNEL_CAPACITY)
+    {
+        Logging::Error("Channel capacity must be at most {}, got {}.", Tasks::MAX_CHANNEL_CAPACITY, Capacity);
+        return std::nullopt;
+    }
+    return TChannelValue(std::make_shared<Tasks::TChannel>(Capacity));
+}
+
+bool BuiltIns::Send(const TChannelValue& Channel, const TObject& Value)
+{
+    return Channel.GetValue().Send(Value);
+}
+
+bool BuiltIns::Receive(const TChannelValue& Channel, TObject& Value)
+{
+    return Channel.GetValue().Receive(Value);
+}
+
+void BuiltIns::Close(const TChannelValue& Channel)
+{
+    Channel.GetValue().Close();
 }
 
 // Initialize the function map of keywords to actual C++ functions
@@ -237,15 +665,56 @@ TFunctionMap BuiltIns::InitFunctionMap()
     TFunctionMap Map;
 
     // Containers
-    Map["size_of"] = &SizeOf_Internal;
-    Map["index_of"] = &IndexOf_Internal;
-    Map["append"] = &Append_Internal;
-    Map["contains"] = &Contains_Internal;
+    Map.Register("size_of", &SizeOf, EPurity::Pure);
+    Map.Register("index_of", &IndexOf, EPurity::Pure);
+    Map.Register("append", &Append, EPurity::Mutating);
+    Map.Register("contains", &Contains, EPurity::Pure);
+    Map.Register("range", &Range, EPurity::Pure);
+
+    // Arrays (SIMD)
+    Map.Register("vec_add", &VecAdd, EPurity::Pure);
+    Map.Register("vec_sub", &VecSub, EPurity::Pure);
+    Map.Register("vec_mul", &VecMul, EPurity::Pure);
+    Map.Register("vec_div", &VecDiv, EPurity::Pure);
+    Map.Register("sum", &Sum, EPurity::Pure);
+    Map.Register("min", &Min, EPurity::Pure);
+    Map.Register("max", &Max, EPurity::Pure);
+    Map.Register("dot", &Dot, EPurity::Pure);
+    Map.Register("prefix_sum", &PrefixSum, EPurity::Pure);
 
     // IO
-    Map["print"] = &Print_Internal;
-    Map["printf"] = &Printf_Internal;
-    Map["read_file"] = &ReadFile_Internal;
+    Map.Register("print", &Print, EPurity::Effectful);
+    Map.Register("printf", &Printf, EPurity::Effectful);
+    Map.Register("flush", &Flush, EPurity::Effectful);
+    Map.Register("read_file", &ReadFile, EPurity::Volatile);
+    Map.Register("read_async", &ReadAsync, EPurity::Effectful);
+    Map.Register("write_async", &WriteAsync, EPurity::Effectful);
+    Map.Register("await", &Await, EPurity::Effectful);
+    Map.Register("open_file", &OpenFile, EPurity::Volatile);
+    Map.Register("next_line", &NextLine, EPurity::Mutating);
+    Map.Register("close_file", &CloseFile, EPurity::Effectful);
+
+    // Time
+    Map.Register("clock", &Clock, EPurity::Volatile);
+
+    // Tasks
+    Map.Register("spawn", &Spawn, EPurity::Effectful);
+    Map.Register("join", &Join, EPurity::Effectful);
+    Map.Register("par_map", &ParMap, EPurity::Effectful);
+    Map.Register("par_filter", &ParFilter, EPurity::Effectful);
+    Map.Register("par_reduce", &ParReduce, EPurity::Effectful);
+
+    // Channels
+    Map.Register("channel", &Channel, EPurity::Volatile);
+    Map.Register("send", &Send, EPurity::Effectful);
+    Map.Register("recv", &Receive, EPurity::Mutating);
+    Map.Register("close", &Close, EPurity::Effectful);
 
     return Map;
 }
+
+TFunctionMap& BuiltIns::GetFunctionMap()
+{
+    static TFunctionMap Map = InitFunctionMap();
+    return Map;
+}
@@ -0,0 +1,153 @@
+#include "../Public/Channel.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace Tasks;
+
+TChannel::TChannel(size_t InCapacity)
+    : Cells(std::make_unique<TCell[]>(std::bit_ceil(std::max<size_t>(InCapacity, 2))))
+      , Mask(std::bit_ceil(std::max<size_t>(InCapacity, 2)) - 1)
+      , Capacity(InCapacity)
+{
+    // A cell is free for the sender at the position equal to its sequence, and full for the receiver at the position
+    // one less
+    for (size_t Index = 0; Index <= Mask; Index++)
+    {
+        Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+    }
+}
+
+bool TChannel::IsFull(size_t Position) const
+{
+    // The ring may have room while the channel is full. A send position read before receivers moved past it is stale,
+    // and the send claiming it fails anyway.
+    const auto Waiting = static_cast<std::ptrdiff_t>(Position - ReceivePosition.load(std::memory_order_seq_cst));
+    return Waiting >= static_cast<std::ptrdiff_t>(Capacity);
+}
+
+bool TChannel::TrySend(const TObject& Value)
+{
+    size_t Position = SendPosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        TCell& Cell = Cells[Position & Mask];
+        const size_t Sequence = Cell.Sequence.load(std::memory_order_acquire);
+        const auto Lap = static_cast<std::ptrdiff_t>(Sequence - Position);
+        if (Lap == 0)
+        {
+            if (IsFull(Position))
+            {
+                return false;
+            }
+            if (SendPosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+            {
+                Cell.Value = Value;
+                Cell.Sequence.store(Position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (Lap < 0)
+        {
+            // The receivers have not emptied this cell since the last lap
+            return false;
+        }
+        else
+        {
+            Position = SendPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TChannel::TryReceive(TObject& Value)
+{
+    size_t Position = ReceivePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+        TCell& Cell = Cells[Position & Mask];
+        const size_t Sequence = Cell.Sequence.load(std::memory_order_acquire);
+        const auto Lap = static_cast<std::ptrdiff_t>(Sequence - (Position + 1));
+        if (Lap == 0)
+        {
+            if (ReceivePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+            {
+                Value = Cell.Value;
+                Cell.Value.SetNull();
+                Cell.Sequence.store(Position + Mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (Lap < 0)
+        {
+            // No sender has filled this cell yet
+            return false;
+        }
+        else
+        {
+            Position = ReceivePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TChannel::CanSend() const
+{
+    const size_t Position = SendPosition.load(std::memory_order_seq_cst);
+    return Cells[Position & Mask].Sequence.load(std::memory_order_seq_cst) == Position && !IsFull(Position);
+}
+
+bool TChannel::CanReceive() const
+{
+    const size_t Position = ReceivePosition.load(std::memory_order_seq_cst);
+    return Cells[Position & Mask].Sequence.load(std::memory_order_seq_cst) == Position + 1;
+}
+
+void TChannel::Park(bool bSending)
+{
+    Parked.Wait([this, bSending]
+    {
+        return bClosed.load(std::memory_order_seq_cst) || (bSending ? CanSend() : CanReceive());
+    });
+}
+
+bool TChannel::Send(const TObject& Value)
+{
+    while (!bClosed.load(std::memory_order_acquire))
+    {
+        if (TrySend(Value))
+        {
+            Parked.Notify();
+            return true;
+        }
+        Park(true);
+    }
+    return false;
+}
+
+bool TChannel::Receive(TObject& Value)
+{
+    while (true)
+    {
+        if (TryReceive(Value))
+        {
+            Parked.Notify();
+            return true;
+        }
+        if (bClosed.load(std::memory_order_acquire))
+        {
+            // Values sent before the channel closed are still received
+            if (TryReceive(Value))
+            {
+                Parked.Notify();
+                return true;
+            }
+            return false;
+        }
+        Park(false);
+    }
+}
+
+void TChannel::Close()
+{
+    bClosed.store(true, std::memory_order_seq_cst);
+    Parked.Notify();
+}
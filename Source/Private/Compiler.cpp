@@ -0,0 +1,1236 @@
+#include "../Public/Compiler.h"
+
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <set>
+
+#include "../Public/Ast.h"
+
+using namespace Vm;
+
+int TCompiler::Emit(EOpCode Op, int32_t A, int32_t B, int32_t C)
+{
+    Chunk->Code.push_back({Op, A, B, C});
+    return Here() - 1;
+}
+
+void TCompiler::PatchJump(int Index, int Target)
+{
+    TInstruction& Instruction = Chunk->Code[Index];
+    switch (Instruction.Op)
+    {
+    case EOpCode::Jump :
+    case EOpCode::JumpIfFalse :
+        Instruction.A = Target;
+        break;
+    default :
+        Instruction.C = Target;
+        break;
+    }
+}
+
+// Tracks the operand stack depth so the VM can allocate the whole stack up front
+void TCompiler::Adjust(int Delta)
+{
+    Depth += Delta;
+    Chunk->MaxStackDepth = std::max(Chunk->MaxStackDepth, Depth);
+}
+
+int TCompiler::NewSite()
+{
+    Chunk->Sites.emplace_back();
+    return static_cast<int>(Chunk->Sites.size() - 1);
+}
+
+int TCompiler::VariableCell(const std::string& Name)
+{
+    if (const auto It = VariableCells.find(Name); It != VariableCells.end())
+    {
+        return It->second;
+    }
+    // Map nodes never move, so the cell stays valid; a null binding reads as undefined, as if it were missing
+    Chunk->Cells.push_back(&CurrentFrame->Identifiers[Name]);
+    Chunk->CellNames.push_back(Name);
+    const int Index = static_cast<int>(Chunk->Cells.size() - 1);
+    VariableCells[Name] = Index;
+    return Index;
+}
+
+int TCompiler::ConstantCell(TObject* Value)
+{
+    Chunk->Constants.push_back(Value);
+    Chunk->Cells.push_back(&Chunk->Constants.back());
+    Chunk->CellNames.emplace_back();
+    return static_cast<int>(Chunk->Cells.size() - 1);
+}
+
+// Returns the cell for a literal or variable, or -1 for any other node
+int TCompiler::LeafCell(AstNode* Node)
+{
+    if (const auto Value = Cast<AstValue>(Node))
+    {
+        return ConstantCell(&Value->Value);
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        return VariableCell(Identifier->Name);
+    }
+    return -1;
+}
+
+void TCompiler::CompileEval(AstNode* Node, bool bValue)
+{
+    Chunk->Nodes.push_back(Node);
+    Emit(EOpCode::Eval, static_cast<int32_t>(Chunk->Nodes.size() - 1), bValue);
+    if (bValue)
+    {
+        Adjust(1);
+    }
+}
+
+void TCompiler::CompileExpression(AstNode* Node)
+{
+    if (const int Cell = LeafCell(Node); Cell >= 0)
+    {
+        Emit(EOpCode::Load, Cell);
+        Adjust(1);
+        return;
+    }
+
+    if (const auto Unary = Cast<AstUnaryExpr>(Node); Unary && (Unary->Op == Not || Unary->Op == Minus))
+    {
+        CompileExpression(Unary->Right);
+        Emit(Unary->Op == Not ? EOpCode::Not : EOpCode::Negate, NewSite());
+        return;
+    }
+
+    if (const auto BinOp = Cast<AstBinOp>(Node); BinOp && BinOp->BinaryOp != EBinaryOp::Count)
+    {
+        CompileExpression(BinOp->Left);
+        CompileExpression(BinOp->Right);
+        Emit(EOpCode::Binary, static_cast<int32_t>(BinOp->BinaryOp), NewSite());
+        Adjust(-1);
+        return;
+    }
+
+    if (const auto Call = Cast<AstCall>(Node); Call && Call->Type == IndexOf && Call->Args.size() == 1)
+    {
+        if (const int Index = LeafCell(Call->Args[0]); Index >= 0)
+        {
+            Emit(EOpCode::LoadIndex, VariableCell(Call->Identifier), Index, NewSite());
+            Adjust(1);
+            return;
+        }
+    }
+
+    // Function calls, and anything else, run in the tree-walking interpreter
+    CompileEval(Node, true);
+}
+
+// Compiles a condition, returning the jump which must be patched with the target for when it is false
+int TCompiler::CompileCondition(AstNode* Node)
+{
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        EOpCode Op = EOpCode::Count;
+        switch (BinOp->BinaryOp)
+        {
+        case EBinaryOp::Less :
+            Op = EOpCode::JumpUnlessLess;
+            break;
+        case EBinaryOp::Greater :
+            Op = EOpCode::JumpUnlessGreater;
+            break;
+        case EBinaryOp::Equal :
+            Op = EOpCode::JumpUnlessEqual;
+            break;
+        case EBinaryOp::NotEqual :
+            Op = EOpCode::JumpUnlessNotEqual;
+            break;
+        default :
+            break;
+        }
+        const bool bLeaves = (Cast<AstValue>(BinOp->Left) || Cast<AstIdentifier>(BinOp->Left))
+            && (Cast<AstValue>(BinOp->Right) || Cast<AstIdentifier>(BinOp->Right));
+        if (Op != EOpCode::Count && bLeaves)
+        {
+            return Emit(Op, LeafCell(BinOp->Left), LeafCell(BinOp->Right));
+        }
+    }
+
+    CompileExpression(Node);
+    Adjust(-1);
+    return Emit(EOpCode::JumpIfFalse);
+}
+
+void TCompiler::CompileStatement(AstNode* Node)
+{
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            CompileStatement(Expression);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node); Assignment && Assignment->Annotation == Void)
+    {
+        const int Cell = VariableCell(Assignment->Name);
+
+        // 'x += c' and 'x = x + c'
+        const auto BinOp = Cast<AstBinOp>(Assignment->Right);
+        const auto Left = BinOp ? Cast<AstIdentifier>(BinOp->Left) : nullptr;
+        const auto Constant = BinOp ? Cast<AstValue>(BinOp->Right) : nullptr;
+        if (BinOp && BinOp->BinaryOp == EBinaryOp::Add && Left && Left->Name == Assignment->Name && Constant)
+        {
+            Emit(EOpCode::AddConst, Cell, ConstantCell(&Constant->Value), NewSite());
+            return;
+        }
+
+        CompileExpression(Assignment->Right);
+        Emit(EOpCode::Store, Cell, NewSite());
+        Adjust(-1);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        const int ElseJump = CompileCondition(If->Cond);
+        CompileStatement(If->TrueBody);
+        if (!If->FalseBody)
+        {
+            PatchJump(ElseJump, Here());
+            return;
+        }
+        const int EndJump = Emit(EOpCode::Jump);
+        PatchJump(ElseJump, Here());
+        CompileStatement(If->FalseBody);
+        PatchJump(EndJump, Here());
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        const int Counter = Chunk->LoopCount++;
+        Emit(EOpCode::LoopEnter, Counter);
+        const int Head = Here();
+        const int ExitJump = CompileCondition(While->Cond);
+        CompileStatement(While->Body);
+        Emit(EOpCode::LoopBack, Counter, Head);
+        PatchJump(ExitJump, Here());
+    }
+    else if (Cast<AstValue>(Node) || Cast<AstIdentifier>(Node) || Cast<AstUnaryExpr>(Node) || Cast<AstBinOp>(Node))
+    {
+        CompileExpression(Node);
+        Emit(EOpCode::Pop);
+        Adjust(-1);
+    }
+    else
+    {
+        // Declarations, calls, annotated assignments and anything else the VM has no instructions for
+        CompileEval(Node, false);
+    }
+}
+
+std::unique_ptr<TChunk> TCompiler::Compile(AstBody* Program)
+{
+    auto Result = std::make_unique<TChunk>();
+    Chunk = Result.get();
+    VariableCells.clear();
+    Depth = 0;
+
+    CompileStatement(Program);
+    Emit(EOpCode::Halt);
+
+    Chunk = nullptr;
+    return Result;
+}
+
+int TRegisterCompiler::Emit(ERegisterOp Op, int32_t A, int32_t B, int32_t C)
+{
+    Code->Code.push_back({Op, A, B, C});
+    return Here() - 1;
+}
+
+void TRegisterCompiler::PatchJump(int Index, int Target)
+{
+    TRegisterInstruction& Instruction = Code->Code[Index];
+    switch (Instruction.Op)
+    {
+    case ERegisterOp::Jump :
+        Instruction.A = Target;
+        break;
+    case ERegisterOp::JumpIfFalse :
+        Instruction.B = Target;
+        break;
+    default :
+        Instruction.C = Target;
+        break;
+    }
+}
+
+void TRegisterCompiler::AddVariable(const std::string& Name)
+{
+    if (Variables.contains(Name))
+    {
+        return;
+    }
+    Variables[Name] = static_cast<int>(Code->Cells.size());
+    Code->Cells.push_back(&CurrentFrame->Identifiers[Name]);
+    Code->Names.push_back(Name);
+}
+
+// Finds every variable and constant the unit uses, including those of the calls it inlines, so they can take the
+// first registers
+void TRegisterCompiler::Collect(AstNode* Node)
+{
+    if (const auto Value = Cast<AstValue>(Node))
+    {
+        // A function inlined at several sites shares its constants between them
+        if (!Constants.contains(Value))
+        {
+            Constants[Value] = static_cast<int>(ConstantNodes.size());
+            ConstantNodes.push_back(Value);
+        }
+    }
+    else if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        AddVariable(Identifier->Name);
+    }
+    else if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Collect(Expression);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        AddVariable(Assignment->Name);
+        Collect(Assignment->Right);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        CollectDepth++;
+        Collect(If->Cond);
+        Collect(If->TrueBody);
+        Collect(If->FalseBody);
+        CollectDepth--;
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        CollectDepth++;
+        Collect(While->Cond);
+        Collect(While->Body);
+        CollectDepth--;
+    }
+    else if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        Collect(BinOp->Left);
+        Collect(BinOp->Right);
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        Collect(Unary->Right);
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        if (Call->Type == IndexOf)
+        {
+            AddVariable(Call->Identifier);
+        }
+        for (AstNode* Arg : Call->Args)
+        {
+            Collect(Arg);
+        }
+        if (Call->Type == Function)
+        {
+            CollectCall(Call);
+        }
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        Collect(Return->Expr);
+    }
+    else if (const auto Declaration = Cast<AstFunction>(Node))
+    {
+        // Function bodies are compiled separately, when they are first called. A declaration at the top of the program
+        // defines its function before any later statement runs, unless the name is taken, in which case it fails and
+        // the first definition stays.
+        if (!bFunction && CollectDepth == 0 && !Functions.contains(Declaration->Name)
+            && !Declared.contains(Declaration->Name))
+        {
+            Declared[Declaration->Name] = Declaration;
+        }
+    }
+}
+
+// Counts the nodes of a function body, to judge whether it is small enough to inline
+static int CountNodes(AstNode* Node)
+{
+    if (!Node)
+    {
+        return 0;
+    }
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        int Count = 0;
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Count += CountNodes(Expression);
+        }
+        return Count;
+    }
+    if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        return 1 + CountNodes(Assignment->Right);
+    }
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        return 1 + CountNodes(BinOp->Left) + CountNodes(BinOp->Right);
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return 1 + CountNodes(Unary->Right);
+    }
+    if (const auto Return = Cast<AstReturn>(Node))
+    {
+        return 1 + CountNodes(Return->Expr);
+    }
+    if (const auto Call = Cast<AstCall>(Node))
+    {
+        int Count = 1;
+        for (AstNode* Arg : Call->Args)
+        {
+            Count += CountNodes(Arg);
+        }
+        return Count;
+    }
+    return 1;
+}
+
+// The statements of a function body, which may be a single statement rather than a block
+static std::vector<AstNode*> GetStatements(AstNode* Body)
+{
+    if (const auto Block = Cast<AstBody>(Body))
+    {
+        return Block->Expressions;
+    }
+    return {Body};
+}
+
+// Whether a statement leaves a value, so that it may be the function's result
+static bool IsValueStatement(AstNode* Node)
+{
+    return Cast<AstValue>(Node) || Cast<AstIdentifier>(Node) || Cast<AstUnaryExpr>(Node) || Cast<AstBinOp>(Node)
+        || Cast<AstCall>(Node) || Cast<AstReturn>(Node);
+}
+
+// Returns why a call cannot be inlined from the function, or an empty string if it can
+std::string TRegisterCompiler::CheckInline(const AstCall* Call, const AstFunction* Function) const
+{
+    if (Call->Args.size() != Function->Args.size())
+    {
+        return "argument count mismatch";
+    }
+    if (Function == UnitFunction || std::ranges::find(Inlining, Function) != Inlining.end())
+    {
+        return "recursive";
+    }
+    if (Inlining.size() >= INLINE_MAX_DEPTH)
+    {
+        return "nested too deep";
+    }
+    const std::vector<AstNode*> Statements = GetStatements(Function->Body);
+    if (!std::ranges::all_of(Statements, [](AstNode* Statement)
+    {
+        return Cast<AstAssignment>(Statement) || IsValueStatement(Statement);
+    }))
+    {
+        return "not straight-line code";
+    }
+    if (const int Size = CountNodes(Function->Body); Size > INLINE_MAX_NODES)
+    {
+        return std::format("too large ({} nodes)", Size);
+    }
+    return {};
+}
+
+// Finds the function a call could be inlined from and collects its body into the unit
+void TRegisterCompiler::CollectCall(AstCall* Call)
+{
+    if (Runtime::GetContext().BuiltIns.contains(Call->Identifier) || Candidates.contains(Call))
+    {
+        return;
+    }
+
+    TInlineCandidate& Candidate = Candidates[Call];
+    if (const auto It = Functions.find(Call->Identifier); It != Functions.end())
+    {
+        Candidate.Function = It->second;
+    }
+    else if (const auto Declaration = Declared.find(Call->Identifier); Declaration != Declared.end())
+    {
+        Candidate.Function = Declaration->second;
+    }
+    else
+    {
+        Candidate.Reason = "not declared before the call";
+        return;
+    }
+
+    Candidate.Reason = CheckInline(Call, Candidate.Function);
+    if (!Candidate.Reason.empty())
+    {
+        return;
+    }
+    const AstFunction* Function = Candidate.Function;
+    Inlining.push_back(Function);
+    for (const std::string& Param : Function->Args)
+    {
+        AddVariable(Param);
+    }
+    Collect(Function->Body);
+    Inlining.pop_back();
+}
+
+int TRegisterCompiler::Variable(const std::string& Name) const
+{
+    return Variables.at(Name);
+}
+
+// Returns the register of a literal or variable, or -1 for any other node
+int TRegisterCompiler::LeafRegister(AstNode* Node) const
+{
+    if (const auto Value = Cast<AstValue>(Node))
+    {
+        return static_cast<int>(Code->Cells.size()) + Constants.at(Value);
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        return Variable(Identifier->Name);
+    }
+    return -1;
+}
+
+// Temporaries are allocated and freed in stack order, so the register file only grows to the deepest expression
+int TRegisterCompiler::AllocateTemp()
+{
+    const int Register = NextTemp++;
+    Code->RegisterCount = std::max(Code->RegisterCount, NextTemp);
+    return Register;
+}
+
+void TRegisterCompiler::Free(int Register)
+{
+    if (IsTemp(Register))
+    {
+        NextTemp--;
+    }
+}
+
+// Whether evaluating the node may call a function, which could change any variable
+static bool HasCall(AstNode* Node)
+{
+    if (const auto Call = Cast<AstCall>(Node))
+    {
+        return Call->Type == Function || std::ranges::any_of(Call->Args, HasCall);
+    }
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        return HasCall(BinOp->Left) || HasCall(BinOp->Right);
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return HasCall(Unary->Right);
+    }
+    return false;
+}
+
+// Calls the callback for a node and every node under it, in the order they run. Function declarations run none of
+// their body.
+static void ForEachNode(AstNode* Node, const std::function<void(AstNode*)>& Callback)
+{
+    if (!Node)
+    {
+        return;
+    }
+    Callback(Node);
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            ForEachNode(Expression, Callback);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        ForEachNode(Assignment->Right, Callback);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        ForEachNode(If->Cond, Callback);
+        ForEachNode(If->TrueBody, Callback);
+        ForEachNode(If->FalseBody, Callback);
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        ForEachNode(While->Cond, Callback);
+        ForEachNode(While->Body, Callback);
+    }
+    else if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        ForEachNode(BinOp->Left, Callback);
+        ForEachNode(BinOp->Right, Callback);
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        ForEachNode(Unary->Right, Callback);
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        ForEachNode(Return->Expr, Callback);
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        for (AstNode* Arg : Call->Args)
+        {
+            ForEachNode(Arg, Callback);
+        }
+    }
+}
+
+// Whether the node calls a user function or a built-in which changes its arguments, either of which could change any
+// variable
+static bool HasOpaqueCall(AstNode* Node)
+{
+    bool bOpaque = false;
+    const TFunctionMap& BuiltIns = Runtime::GetContext().BuiltIns;
+    ForEachNode(Node, [&bOpaque, &BuiltIns](AstNode* Child)
+    {
+        if (const auto Call = Cast<AstCall>(Child); Call && Call->Type == Function)
+        {
+            const auto BuiltIn = BuiltIns.find(Call->Identifier);
+            bOpaque |= BuiltIn == BuiltIns.end() || BuiltIn->second.GetPurity() == EPurity::Mutating;
+        }
+    });
+    return bOpaque;
+}
+
+// Proves which variables hold one type wherever the unit reads them. Only the unit's own code may change them, so a
+// unit with an opaque call proves nothing.
+void TRegisterCompiler::InferVariables(AstNode* Body, const std::vector<std::string>& Params)
+{
+    using namespace Inference;
+    TypedVariables.clear();
+    if (HasOpaqueCall(Body))
+    {
+        return;
+    }
+    std::vector<const AstAssignment*> Assignments;
+    ForEachNode(Body, [&Assignments](AstNode* Node)
+    {
+        if (const auto Assignment = Cast<AstAssignment>(Node))
+        {
+            Assignments.push_back(Assignment);
+        }
+    });
+
+    // Annotated parameters are checked on entry. Other variables must be assigned by a statement of the body itself,
+    // rather than one nested in a conditional or loop, before anything reads them.
+    std::set<std::string> Defined;
+    for (size_t Index = 0; UnitFunction && Index < Params.size(); Index++)
+    {
+        if (UnitFunction->ArgTypes[Index] != Void)
+        {
+            Defined.insert(Params[Index]);
+            TypedVariables[Params[Index]] = TType::Of(UnitFunction->ArgTypes[Index]);
+        }
+    }
+    std::set<std::string> Undefined;
+    for (AstNode* Statement : GetStatements(Body))
+    {
+        ForEachNode(Statement, [&Defined, &Undefined](AstNode* Node)
+        {
+            const auto Identifier = Cast<AstIdentifier>(Node);
+            const auto Call = Cast<AstCall>(Node);
+            const std::string* Name = Identifier ? &Identifier->Name
+                : Call && Call->Type == IndexOf ? &Call->Identifier : nullptr;
+            if (Name && !Defined.contains(*Name))
+            {
+                Undefined.insert(*Name);
+            }
+        });
+        if (const auto Assignment = Cast<AstAssignment>(Statement); Assignment && !Undefined.contains(Assignment->Name))
+        {
+            Defined.insert(Assignment->Name);
+            TypedVariables.try_emplace(Assignment->Name);
+        }
+    }
+
+    // A variable's type joins the types of every assignment to it, which only grow along the lattice
+    bool bChanged;
+    do
+    {
+        bChanged = false;
+        for (const AstAssignment* Assignment : Assignments)
+        {
+            const auto It = TypedVariables.find(Assignment->Name);
+            if (It == TypedVariables.end())
+            {
+                continue;
+            }
+            const TType Assigned = Assignment->Annotation != Void
+                ? TType::Of(Assignment->Annotation)
+                : StaticType(Assignment->Right);
+            const TType Joined = It->second.Join(Assigned);
+            if (Joined != It->second)
+            {
+                It->second = Joined;
+                bChanged = true;
+            }
+        }
+    }
+    while (bChanged);
+    std::erase_if(TypedVariables, [](const auto& Entry) { return !Entry.second.IsProven(); });
+}
+
+// The type of every value an expression can have, as far as the unit proves it
+Inference::TType TRegisterCompiler::StaticType(AstNode* Node) const
+{
+    using namespace Inference;
+    if (const auto Value = Cast<AstValue>(Node))
+    {
+        return TType::Of(Value->Value.GetType());
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        const auto It = TypedVariables.find(Identifier->Name);
+        return It == TypedVariables.end() ? TType::Dynamic() : It->second;
+    }
+    if (const auto BinOp = Cast<AstBinOp>(Node); BinOp && BinOp->BinaryOp != EBinaryOp::Count)
+    {
+        return GetResultType(BinOp->BinaryOp, StaticType(BinOp->Left), StaticType(BinOp->Right));
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return GetUnaryType(Unary->Op, StaticType(Unary->Right));
+    }
+    return TType::Dynamic();
+}
+
+// A tail call leaves no frame to check the unit's declared return type in, unless it calls the unit itself, whose
+// own return checks the value
+bool TRegisterCompiler::CanTailCall(const AstCall* Call) const
+{
+    return bFunction && (UnitFunction->ReturnType == Void || Call->Identifier == UnitFunction->Name);
+}
+
+// Checks the value an annotated assignment left in its variable
+void TRegisterCompiler::CompileCheck(const AstAssignment* Assignment)
+{
+    if (Assignment->Annotation != Void)
+    {
+        Emit(ERegisterOp::CheckAssignment, Variable(Assignment->Name), Assignment->Annotation);
+    }
+}
+
+// Checks an annotated parameter or result of a function, which the instruction names in its message
+void TRegisterCompiler::CompileCheck(ERegisterOp Op, int Register, EValueType Type, const AstFunction* Function)
+{
+    auto It = std::ranges::find(Code->Signatures, Function);
+    if (It == Code->Signatures.end())
+    {
+        Code->Signatures.push_back(Function);
+        It = Code->Signatures.end() - 1;
+    }
+    Emit(Op, Register, Type, static_cast<int32_t>(It - Code->Signatures.begin()));
+}
+
+void TRegisterCompiler::CompileEval(AstNode* Node, int Target, bool bRequired)
+{
+    Code->Nodes.push_back(Node);
+    Emit(ERegisterOp::Eval, Target, static_cast<int32_t>(Code->Nodes.size() - 1), bRequired);
+}
+
+void TRegisterCompiler::CompileCall(AstCall* Call, int Target, bool bRequired, bool bTail)
+{
+    // Built-ins, and calls the tree would reject, run in the tree-walking interpreter
+    const bool bLeaves = std::ranges::all_of(Call->Args, [this](AstNode* Arg) { return LeafRegister(Arg) >= 0; });
+    if (Runtime::GetContext().BuiltIns.contains(Call->Identifier) || !bLeaves)
+    {
+        CompileEval(Call, Target, bRequired);
+        return;
+    }
+
+    if (CompileInline(Call, Target, bRequired))
+    {
+        return;
+    }
+
+    TCallSite Site;
+    Site.Name = Call->Identifier;
+    for (AstNode* Arg : Call->Args)
+    {
+        Site.Args.push_back(LeafRegister(Arg));
+    }
+    Site.Literals.resize(Site.Args.size());
+    Code->Calls.push_back(std::move(Site));
+    Emit(bTail ? ERegisterOp::TailCall : ERegisterOp::Call, Target, static_cast<int32_t>(Code->Calls.size() - 1),
+         bRequired);
+}
+
+void TRegisterCompiler::Report(const AstCall* Call, bool bInlined, const std::string& Detail)
+{
+    if (InlineReport)
+    {
+        InlineReport->push_back({Call->Identifier, Call->Context.Line, Call->Context.Column, bInlined, Detail});
+    }
+}
+
+// Compiles a statement of an inlined body which leaves a value into Target, discarding the value if Target is -1
+void TRegisterCompiler::CompileValue(AstNode* Node, int Target, bool bRequired)
+{
+    if (const auto Return = Cast<AstReturn>(Node))
+    {
+        Node = Return->Expr;
+    }
+    if (const auto Call = Cast<AstCall>(Node); Call && Call->Type == Function)
+    {
+        CompileCall(Call, Target, bRequired);
+    }
+    else if (Target < 0)
+    {
+        Free(CompileExpression(Node, -1));
+    }
+    else
+    {
+        CompileExpression(Node, Target);
+    }
+}
+
+// Compiles the body of the called function in place of the call, if it was found to be inlinable. The value of its
+// last value statement goes into Target, as the call's result would.
+bool TRegisterCompiler::CompileInline(AstCall* Call, int Target, bool bRequired)
+{
+    const auto It = Candidates.find(Call);
+    if (It == Candidates.end())
+    {
+        return false;
+    }
+    const AstFunction* Function = It->second.Function;
+    std::string Reason = It->second.Reason;
+    const std::vector<AstNode*> Statements = Function ? GetStatements(Function->Body) : std::vector<AstNode*>();
+    const auto Last = std::ranges::find_if(Statements.rbegin(), Statements.rend(), IsValueStatement);
+    if (Reason.empty())
+    {
+        // The candidate was found in one calling context; a site reached through other inlined calls may be recursive
+        Reason = CheckInline(Call, Function);
+    }
+    if (Reason.empty() && (bRequired || Function->ReturnType != Void) && Last == Statements.rend())
+    {
+        Reason = "leaves no value";
+    }
+    if (!Reason.empty())
+    {
+        Report(Call, false, Reason);
+        return false;
+    }
+    Report(Call, true, std::format("{} nodes", CountNodes(Function->Body)));
+
+    // A declared return type is checked even where the caller discards the value
+    int CheckTemp = -1;
+    if (Function->ReturnType != Void && Target < 0)
+    {
+        CheckTemp = AllocateTemp();
+        Target = CheckTemp;
+    }
+
+    // Bind the parameters as a call does: to the argument variable itself, or to a copy of a literal. The arguments
+    // are all read first, through temporaries if a parameter is also an argument.
+    std::vector<std::pair<int, int>> Bindings;
+    for (size_t Index = 0; Index < Call->Args.size(); Index++)
+    {
+        const int Param = Variable(Function->Args[Index]);
+        const int Arg = LeafRegister(Call->Args[Index]);
+        if (Param != Arg)
+        {
+            Bindings.emplace_back(Param, Arg);
+        }
+    }
+    const bool bOverlap = std::ranges::any_of(Bindings, [&Bindings](const std::pair<int, int>& Binding)
+    {
+        return std::ranges::any_of(Bindings, [&Binding](const std::pair<int, int>& Other)
+        {
+            return Other.first == Binding.second;
+        });
+    });
+    const int VariableCount = static_cast<int>(Code->Cells.size());
+    std::vector<int> Temps;
+    for (std::pair<int, int>& Binding : Bindings)
+    {
+        const ERegisterOp Op = Binding.second < VariableCount ? ERegisterOp::Move : ERegisterOp::Copy;
+        if (bOverlap)
+        {
+            Temps.push_back(AllocateTemp());
+            Emit(Op, Temps.back(), Binding.second);
+            Binding.second = Temps.back();
+        }
+        else
+        {
+            Emit(Op, Binding.first, Binding.second);
+        }
+    }
+    if (bOverlap)
+    {
+        for (const auto& [Param, Temp] : Bindings)
+        {
+            Emit(ERegisterOp::Move, Param, Temp);
+        }
+        for (auto Temp = Temps.rbegin(); Temp != Temps.rend(); ++Temp)
+        {
+            Free(*Temp);
+        }
+    }
+    // The inlined body runs straight through, so unless it has an opaque call, its parameters keep their checked
+    // types until it assigns them, and its variables have the type of their last assignment
+    const std::map<std::string, Inference::TType> Outer = TypedVariables;
+    const bool bTyped = !HasOpaqueCall(Function->Body);
+    for (size_t Index = 0; Index < Function->Args.size(); Index++)
+    {
+        const std::string& Param = Function->Args[Index];
+        TypedVariables.erase(Param);
+        if (const EValueType Type = Function->ArgTypes[Index]; Type != Void)
+        {
+            CompileCheck(ERegisterOp::CheckArgument, Variable(Param), Type, Function);
+            if (bTyped)
+            {
+                TypedVariables[Param] = Inference::TType::Of(Type);
+            }
+        }
+    }
+
+    Inlining.push_back(Function);
+    const size_t ResultIndex = Last == Statements.rend() ? Statements.size() : Statements.rend() - Last - 1;
+    int ResultTemp = -1;
+    for (size_t Index = 0; Index < Statements.size(); Index++)
+    {
+        AstNode* Statement = Statements[Index];
+        if (const auto Assignment = Cast<AstAssignment>(Statement))
+        {
+            CompileExpression(Assignment->Right, Variable(Assignment->Name));
+            CompileCheck(Assignment);
+            const Inference::TType Type = Assignment->Annotation != Void
+                ? Inference::TType::Of(Assignment->Annotation)
+                : StaticType(Assignment->Right);
+            if (bTyped && Type.IsProven())
+            {
+                TypedVariables[Assignment->Name] = Type;
+            }
+            else
+            {
+                TypedVariables.erase(Assignment->Name);
+            }
+        }
+        else if (Index != ResultIndex || Target < 0)
+        {
+            CompileValue(Statement, -1, false);
+        }
+        else if (Index == Statements.size() - 1)
+        {
+            CompileValue(Statement, Target, bRequired);
+        }
+        else
+        {
+            // Assignments follow the result, and may change the variables it was computed from
+            ResultTemp = AllocateTemp();
+            CompileValue(Statement, ResultTemp, bRequired);
+        }
+    }
+    Inlining.pop_back();
+
+    // Afterwards only what the caller proved holds, for the variables the body left alone
+    std::map<std::string, Inference::TType> Proven;
+    if (bTyped)
+    {
+        std::ranges::copy_if(Outer, std::inserter(Proven, Proven.end()), [Function](const auto& Entry)
+        {
+            return std::ranges::find(Function->Args, Entry.first) == Function->Args.end()
+                && std::ranges::none_of(GetStatements(Function->Body), [&Entry](AstNode* Statement)
+                {
+                    const auto Assignment = Cast<AstAssignment>(Statement);
+                    return Assignment && Assignment->Name == Entry.first;
+                });
+        });
+    }
+    TypedVariables = std::move(Proven);
+    if (ResultTemp >= 0)
+    {
+        Emit(ERegisterOp::Move, Target, ResultTemp);
+        Free(ResultTemp);
+    }
+    if (Function->ReturnType != Void)
+    {
+        CompileCheck(ERegisterOp::CheckResult, Target, Function->ReturnType, Function);
+    }
+    Free(CheckTemp);
+    return true;
+}
+
+// The instruction for a binary operator: a typed one for arithmetic on two ints or two floats
+ERegisterOp TRegisterCompiler::GetArithmeticOp(const AstBinOp* BinOp) const
+{
+    const int Offset = static_cast<int>(BinOp->BinaryOp);
+    if (BinOp->BinaryOp <= EBinaryOp::Div)
+    {
+        const Inference::TType Left = StaticType(BinOp->Left);
+        if (Left.IsProven() && Left == StaticType(BinOp->Right) && (Left.Type == IntType || Left.Type == FloatType))
+        {
+            const ERegisterOp First = Left.Type == IntType ? ERegisterOp::AddInt : ERegisterOp::AddFloat;
+            return static_cast<ERegisterOp>(static_cast<int>(First) + Offset);
+        }
+    }
+    return static_cast<ERegisterOp>(static_cast<int>(ERegisterOp::Add) + Offset);
+}
+
+// Compiles an expression into Target, or into whichever register is cheapest if Target is -1, returning the register
+int TRegisterCompiler::CompileExpression(AstNode* Node, int Target)
+{
+    if (const int Leaf = LeafRegister(Node); Leaf >= 0)
+    {
+        if (Target < 0 || Target == Leaf)
+        {
+            return Leaf;
+        }
+        Emit(ERegisterOp::Copy, Target, Leaf);
+        return Target;
+    }
+
+    if (const auto Unary = Cast<AstUnaryExpr>(Node); Unary && (Unary->Op == Not || Unary->Op == Minus))
+    {
+        const int Operand = CompileExpression(Unary->Right, -1);
+        Free(Operand);
+        const int Result = Target >= 0 ? Target : AllocateTemp();
+        ERegisterOp Op = Unary->Op == Not ? ERegisterOp::Not : ERegisterOp::Negate;
+        if (Unary->Op == Minus && StaticType(Unary->Right).Is(IntType))
+        {
+            Op = ERegisterOp::NegateInt;
+        }
+        else if (Unary->Op == Minus && StaticType(Unary->Right).Is(FloatType))
+        {
+            Op = ERegisterOp::NegateFloat;
+        }
+        Emit(Op, Result, Operand);
+        return Result;
+    }
+
+    if (const auto BinOp = Cast<AstBinOp>(Node); BinOp && BinOp->BinaryOp != EBinaryOp::Count)
+    {
+        int Left = CompileExpression(BinOp->Left, -1);
+        if (!IsTemp(Left) && HasCall(BinOp->Right))
+        {
+            // The tree reads the left operand before the call on the right can change it
+            const int Copy = AllocateTemp();
+            Emit(ERegisterOp::Copy, Copy, Left);
+            Left = Copy;
+        }
+        const int Right = CompileExpression(BinOp->Right, -1);
+        Free(Right);
+        Free(Left);
+        const int Result = Target >= 0 ? Target : AllocateTemp();
+        Emit(GetArithmeticOp(BinOp), Result, Left, Right);
+        return Result;
+    }
+
+    const auto Call = Cast<AstCall>(Node);
+    if (Call && Call->Type == IndexOf && Call->Args.size() == 1)
+    {
+        const int Index = CompileExpression(Call->Args[0], -1);
+        Free(Index);
+        const int Result = Target >= 0 ? Target : AllocateTemp();
+        Emit(ERegisterOp::LoadIndex, Result, Variable(Call->Identifier), Index);
+        return Result;
+    }
+
+    const int Result = Target >= 0 ? Target : AllocateTemp();
+    if (Call && Call->Type == Function)
+    {
+        CompileCall(Call, Result, true);
+    }
+    else
+    {
+        CompileEval(Node, Result, true);
+    }
+    return Result;
+}
+
+// Compiles a condition, returning the jump which must be patched with the target for when it is false
+int TRegisterCompiler::CompileCondition(AstNode* Node)
+{
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        ERegisterOp Op = ERegisterOp::Count;
+        switch (BinOp->BinaryOp)
+        {
+        case EBinaryOp::Less :
+            Op = ERegisterOp::JumpUnlessLess;
+            break;
+        case EBinaryOp::Greater :
+            Op = ERegisterOp::JumpUnlessGreater;
+            break;
+        case EBinaryOp::Equal :
+            Op = ERegisterOp::JumpUnlessEqual;
+            break;
+        case EBinaryOp::NotEqual :
+            Op = ERegisterOp::JumpUnlessNotEqual;
+            break;
+        default :
+            break;
+        }
+        if (Op != ERegisterOp::Count && !HasCall(BinOp->Right))
+        {
+            const Inference::TType Type = StaticType(BinOp->Left);
+            if (Type.IsProven() && Type == StaticType(BinOp->Right) && (Type.Type == IntType || Type.Type == FloatType))
+            {
+                const int Offset = static_cast<int>(Op) - static_cast<int>(ERegisterOp::JumpUnlessLess);
+                const ERegisterOp First = Type.Type == IntType
+                    ? ERegisterOp::JumpUnlessLessInt
+                    : ERegisterOp::JumpUnlessLessFloat;
+                Op = static_cast<ERegisterOp>(static_cast<int>(First) + Offset);
+            }
+            const int Left = CompileExpression(BinOp->Left, -1);
+            const int Right = CompileExpression(BinOp->Right, -1);
+            Free(Right);
+            Free(Left);
+            return Emit(Op, Left, Right);
+        }
+    }
+
+    const int Value = CompileExpression(Node, -1);
+    Free(Value);
+    return Emit(ERegisterOp::JumpIfFalse, Value);
+}
+
+// A statement is in tail position if nothing in its function runs after it; a call there is compiled to a tail call
+void TRegisterCompiler::CompileStatement(AstNode* Node, bool bTail)
+{
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (size_t Index = 0; Index < Body->Expressions.size(); Index++)
+        {
+            CompileStatement(Body->Expressions[Index], bTail && Index == Body->Expressions.size() - 1);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        // Operators compute straight into the variable's register, with no store
+        CompileExpression(Assignment->Right, Variable(Assignment->Name));
+        CompileCheck(Assignment);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        const int ElseJump = CompileCondition(If->Cond);
+        CompileStatement(If->TrueBody, bTail);
+        if (!If->FalseBody)
+        {
+            PatchJump(ElseJump, Here());
+            return;
+        }
+        const int EndJump = Emit(ERegisterOp::Jump);
+        PatchJump(ElseJump, Here());
+        CompileStatement(If->FalseBody, bTail);
+        PatchJump(EndJump, Here());
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        const int Counter = Code->LoopCount++;
+        Emit(ERegisterOp::LoopEnter, Counter);
+        const int Head = Here();
+        const int ExitJump = CompileCondition(While->Cond);
+        CompileStatement(While->Body);
+        Emit(ERegisterOp::LoopBack, Counter, Head);
+        PatchJump(ExitJump, Here());
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        // As in the tree, 'return' leaves its value as the function's result without leaving the function
+        if (const auto Call = Cast<AstCall>(Return->Expr); Call && Call->Type == Function)
+        {
+            CompileCall(Call, Code->ResultRegister, true, bTail && CanTailCall(Call));
+            return;
+        }
+        CompileExpression(Return->Expr, Code->ResultRegister);
+    }
+    else if (const auto Call = Cast<AstCall>(Node); Call && Call->Type == Function)
+    {
+        CompileCall(Call, Code->ResultRegister, false, bTail && CanTailCall(Call));
+    }
+    else if (Cast<AstValue>(Node) || Cast<AstIdentifier>(Node) || Cast<AstUnaryExpr>(Node) || Cast<AstBinOp>(Node)
+        || Cast<AstCall>(Node))
+    {
+        // The value of the last expression statement is a function's result, as the last value left on the stack is
+        // in the tree
+        CompileExpression(Node, Code->ResultRegister);
+    }
+    else
+    {
+        // Declarations and anything else the machine has no instructions for
+        CompileEval(Node, Code->ResultRegister, false);
+    }
+}
+
+std::unique_ptr<TRegisterCode> TRegisterCompiler::CompileUnit(AstNode* Body, const std::vector<std::string>& Params)
+{
+    auto Result = std::make_unique<TRegisterCode>();
+    Code = Result.get();
+    Variables.clear();
+    Constants.clear();
+    ConstantNodes.clear();
+    Declared.clear();
+    Candidates.clear();
+
+    // Lay out the register file: parameters and other variables, constants, the result, then temporaries
+    for (const std::string& Param : Params)
+    {
+        AddVariable(Param);
+    }
+    Code->ParamCount = static_cast<int>(Params.size());
+    Collect(Body);
+    for (AstValue* Value : ConstantNodes)
+    {
+        Code->Constants.push_back(&Value->Value);
+    }
+    Code->ResultRegister = static_cast<int>(Code->Cells.size() + Code->Constants.size());
+    NextTemp = Code->ResultRegister + 1;
+    Code->RegisterCount = NextTemp;
+
+    InferVariables(Body, Params);
+    for (size_t Index = 0; UnitFunction && Index < Params.size(); Index++)
+    {
+        if (const EValueType Type = UnitFunction->ArgTypes[Index]; Type != Void)
+        {
+            CompileCheck(ERegisterOp::CheckArgument, Variable(Params[Index]), Type, UnitFunction);
+        }
+    }
+    CompileStatement(Body, true);
+    if (UnitFunction && UnitFunction->ReturnType != Void)
+    {
+        CompileCheck(ERegisterOp::CheckResult, Code->ResultRegister, UnitFunction->ReturnType, UnitFunction);
+    }
+    Emit(ERegisterOp::Return, Code->ResultRegister);
+    Code->Sites.resize(Code->Code.size());
+
+    Code = nullptr;
+    return Result;
+}
+
+std::unique_ptr<TRegisterCode> TRegisterCompiler::Compile(AstBody* Program)
+{
+    bFunction = false;
+    UnitFunction = nullptr;
+    return CompileUnit(Program, {});
+}
+
+std::unique_ptr<TRegisterCode> TRegisterCompiler::Compile(const AstFunction* Function)
+{
+    bFunction = true;
+    UnitFunction = Function;
+    return CompileUnit(Function->Body, Function->Args);
+}
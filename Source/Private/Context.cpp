@@ -0,0 +1,20 @@
+#include "../Public/Context.h"
+
+#include "../Public/Ast.h"
+
+thread_local constinit Runtime::TContext* Runtime::CurrentContext = nullptr;
+
+Runtime::TContext& Runtime::UseThreadContext()
+{
+    thread_local TContext Context;
+    CurrentContext = &Context;
+    return Context;
+}
+
+Runtime::TNodeArena::~TNodeArena()
+{
+    for (const AstNode* Node : Nodes)
+    {
+        delete Node;
+    }
+}
@@ -1,11 +1,131 @@
+#include <algorithm>
+#include <cerrno>
 #include <string>
 #include <fstream>
 #include <format>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #define CORE_POSIX_FILES 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define CORE_POSIX_FILES 0
+#endif
+
 #include "../Public/Core.h"
 
-std::string Core::ReadFile(const std::string& FileName)
+#if CORE_POSIX_FILES
+
+// Files at least this large are mapped rather than read, which spares zeroing the string before reading into it
+static constexpr size_t MMAP_THRESHOLD = 1 << 20;
+
+// Reads a file whose size is unknown until it has been read, such as a pipe or a file under /proc
+static bool ReadUnsized(int File, std::string& Contents)
+{
+    char Block[64 * 1024];
+    while (true)
+    {
+        const ssize_t Count = read(File, Block, sizeof(Block));
+        if (Count == 0)
+        {
+            return true;
+        }
+        if (Count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        Contents.append(Block, Count);
+    }
+}
+
+static bool ReadSized(int File, size_t Size, std::string& Contents)
+{
+    if (Size >= MMAP_THRESHOLD)
+    {
+        void* Mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0);
+        if (Mapped != MAP_FAILED)
+        {
+            madvise(Mapped, Size, MADV_SEQUENTIAL);
+            Contents.assign(static_cast<const char*>(Mapped), Size);
+            munmap(Mapped, Size);
+            return true;
+        }
+    }
+
+    Contents.resize(Size);
+    size_t Done = 0;
+    while (Done < Size)
+    {
+        const ssize_t Count = read(File, Contents.data() + Done, Size - Done);
+        if (Count == 0)
+        {
+            // The file shrank since its size was read
+            Contents.resize(Done);
+            return true;
+        }
+        if (Count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        Done += Count;
+    }
+
+    // Anything appended since its size was read
+    return ReadUnsized(File, Contents);
+}
+
+std::optional<std::string> Core::ReadFile(const std::string& FileName)
 {
-    std::ifstream Stream(FileName.c_str());
-    return std::string(std::istreambuf_iterator(Stream), std::istreambuf_iterator<char>());
-};
+    const int File = open(FileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (File < 0)
+    {
+        return std::nullopt;
+    }
+
+    std::string Contents;
+    struct stat Status{};
+    bool bRead;
+    if (fstat(File, &Status) == 0 && S_ISREG(Status.st_mode) && Status.st_size > 0)
+    {
+        bRead = ReadSized(File, Status.st_size, Contents);
+    }
+    else
+    {
+        bRead = ReadUnsized(File, Contents);
+    }
+    close(File);
+    if (!bRead)
+    {
+        return std::nullopt;
+    }
+    return Contents;
+}
+
+#else
+
+std::optional<std::string> Core::ReadFile(const std::string& FileName)
+{
+    std::ifstream Stream(FileName, std::ios::binary | std::ios::ate);
+    if (!Stream.good())
+    {
+        return std::nullopt;
+    }
+    const std::streamsize Size = Stream.tellg();
+    Stream.seekg(0);
+    std::string Contents(static_cast<size_t>(std::max<std::streamsize>(Size, 0)), '\0');
+    Stream.read(Contents.data(), Size);
+    Contents.resize(Stream.gcount());
+    return Contents;
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include "../Public/Embed.h"
+
+#include "../Public/Resolver.h"
+
+using namespace Embed;
+
+std::shared_ptr<const TProgram> TProgram::Compile(const std::string& Source, const std::vector<std::string>& InInputs)
+{
+    std::shared_ptr<TProgram> Program(new TProgram());
+    Program->Inputs = InInputs;
+
+    Runtime::TContext Context;
+    Runtime::TScope Scope(Context);
+    Lexer Lex(Source);
+    const std::vector<Token> Tokens = Lex.Tokenize();
+    if (Tokens.empty())
+    {
+        Program->Errors.push_back("Zero tokens");
+        return Program;
+    }
+
+    const Ast Parser(Tokens);
+    AstBody* Tree = Parser.GetTree();
+    if (Tree)
+    {
+        // Inputs are defined, since the host binds them before every run. Executions bind the names in the order the
+        // resolver bound them here, so each gets the slots the tree is bound to.
+        Frame Layout;
+        TObject Placeholder;
+        for (const std::string& Name : InInputs)
+        {
+            Layout.SetIdentifier(Name, &Placeholder);
+        }
+        const std::map<std::string, AstFunction*> Functions;
+        Resolver::TResolver Resolver(&Layout, Functions, true);
+        Resolver.Run(Tree);
+        Program->SlotNames = Layout.GetSlotNames();
+    }
+    else
+    {
+        Logging::Error("Unable to parse the program.");
+    }
+    Program->Errors = Context.Logger.GetMessages(Logging::LogLevel::Error);
+    if (Program->IsValid())
+    {
+        Program->Tree = Tree;
+    }
+
+    // The tree was made in the context, and outlives it
+    Program->Nodes = std::move(Context.Nodes);
+    return Program;
+}
+
+TExecution::TExecution(std::shared_ptr<const TProgram> InProgram, bool bJit)
+    : Program(std::move(InProgram))
+{
+    if (bJit && Jit::IsSupported())
+    {
+        Interpreter.JitCompiler = std::make_unique<Jit::TJit>();
+    }
+    for (const std::string& Name : Program->GetInputs())
+    {
+        Inputs[Name] = TObject();
+    }
+
+    // Binding the names in the order the program was resolved in gives them the slots its tree is bound to
+    Frame* Root = Interpreter.CurrentFrame;
+    const std::vector<std::string>& SlotNames = Program->GetSlotNames();
+    for (size_t Slot = 0; Slot < SlotNames.size(); Slot++)
+    {
+        if (Root->Bind(SlotNames[Slot]).Slot != static_cast<int>(Slot))
+        {
+            bBound = false;
+        }
+    }
+    for (auto& [Name, Value] : Inputs)
+    {
+        Root->SetIdentifier(Name, &Value);
+    }
+}
+
+bool TExecution::Set(const std::string& Name, const TObject& Value)
+{
+    const auto It = Inputs.find(Name);
+    if (It == Inputs.end())
+    {
+        return false;
+    }
+    It->second = Value;
+    return true;
+}
+
+bool TExecution::CheckBound() const
+{
+    if (!bBound)
+    {
+        Logging::Error("The program's names were bound to slots other than those its tree is bound to.");
+    }
+    return bBound;
+}
+
+void TExecution::Reset()
+{
+    // Entries stay in the frame, since the tree is bound to them
+    Frame* Root = Interpreter.CurrentFrame;
+    Root->Stack.clear();
+    for (TObject*& Value : Root->Identifiers | std::views::values)
+    {
+        Value = nullptr;
+    }
+    for (auto& [Name, Value] : Inputs)
+    {
+        Root->SetIdentifier(Name, &Value);
+    }
+}
+
+bool TExecution::Run()
+{
+    Runtime::TScope Scope(Context);
+    Context.Logger.Clear();
+    Result = nullptr;
+    AstBody* Tree = Program->GetTree();
+    if (!Tree || !CheckBound())
+    {
+        return false;
+    }
+    for (const auto& [Name, Value] : Inputs)
+    {
+        if (Value.GetType() == NullType)
+        {
+            Logging::Error("Input '{}' is not set.", Name);
+            return false;
+        }
+    }
+
+    Reset();
+    Interpreter.Visit(Tree);
+    Context.Output.Flush();
+    Frame* Root = Interpreter.CurrentFrame;
+    if (!Root->Stack.empty())
+    {
+        Result = Root->Stack.back();
+    }
+    return Context.Logger.GetCount(Logging::LogLevel::Error) == 0;
+}
+
+bool TExecution::Call(const std::string& Name, TArgumentList Arguments, TObject& CallResult)
+{
+    Runtime::TScope Scope(Context);
+    Context.Logger.Clear();
+    Result = nullptr;
+    CallResult.SetNull();
+    const AstBody* Tree = Program->GetTree();
+    if (!Tree || !CheckBound())
+    {
+        return false;
+    }
+
+    // Functions are declared as the program runs, so declare those at the top level without running anything else
+    if (!bDeclared)
+    {
+        for (AstNode* Node : Tree->Expressions)
+        {
+            if (const auto Function = Cast<AstFunction>(Node))
+            {
+                Interpreter.Visit(Function);
+            }
+        }
+        bDeclared = true;
+    }
+    const auto Declared = Interpreter.Functions.find(Name);
+    if (Declared == Interpreter.Functions.end())
+    {
+        Logging::Error("Function '{}' is undeclared.", Name);
+        return false;
+    }
+    if (Declared->second->Args.size() != Arguments.size())
+    {
+        Logging::Error("Argument count mismatch for '{}'. Got {}, wanted {}.", Name, Arguments.size(),
+                       Declared->second->Args.size());
+        return false;
+    }
+
+    // The function gets copies of the arguments, as it would of literals, since it may change them
+    CallArguments.resize(Arguments.size());
+    CallArgumentValues.resize(Arguments.size());
+    for (size_t Index = 0; Index < Arguments.size(); Index++)
+    {
+        CallArguments[Index] = *Arguments[Index];
+        CallArgumentValues[Index] = &CallArguments[Index];
+    }
+
+    Reset();
+    Interpreter.CallFunction(Declared->second, CallArgumentValues);
+    Context.Output.Flush();
+    Frame* Root = Interpreter.CurrentFrame;
+    if (!Root->Stack.empty() && Root->Stack.back())
+    {
+        CallResult = *Root->Stack.back();
+    }
+    return Context.Logger.GetCount(Logging::LogLevel::Error) == 0;
+}
+
+TObject* TExecution::Get(const std::string& Name)
+{
+    return Interpreter.CurrentFrame->GetIdentifier(Name);
+}
+
+std::vector<std::string> TExecution::GetErrors()
+{
+    if (!Program->IsValid())
+    {
+        return Program->GetErrors();
+    }
+    return Context.Logger.GetMessages(Logging::LogLevel::Error);
+}
@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <string_view>
+
+#include "../Public/Format.h"
+#include "../Public/Logging.h"
+
+using namespace Formatting;
+
+// The largest precision and width a spec may ask for, which bound the buffers values are formatted in
+static constexpr int MAX_PRECISION = 100;
+static constexpr int MAX_WIDTH = 4096;
+
+static bool IsAlign(char C)
+{
+    return C == '<' || C == '>' || C == '^';
+}
+
+static bool IsFloatType(char Type)
+{
+    return Type == 'e' || Type == 'E' || Type == 'f' || Type == 'F' || Type == 'g' || Type == 'G';
+}
+
+static bool IsIntType(char Type)
+{
+    return Type == 'd' || Type == 'b' || Type == 'B' || Type == 'o' || Type == 'x' || Type == 'X';
+}
+
+// Parses the part of a field after its ':', returning false if it is not a valid spec
+static bool ParseSpec(std::string_view Text, TSpec& Spec)
+{
+    Spec.bEmpty = Text.empty();
+    size_t I = 0;
+    if (Text.size() >= 2 && IsAlign(Text[1]))
+    {
+        Spec.Fill = Text[0];
+        Spec.Align = Text[1];
+        I = 2;
+    }
+    else if (!Text.empty() && IsAlign(Text[0]))
+    {
+        Spec.Align = Text[0];
+        I = 1;
+    }
+    if (I < Text.size() && (Text[I] == '+' || Text[I] == '-' || Text[I] == ' '))
+    {
+        Spec.Sign = Text[I++];
+    }
+    if (I < Text.size() && Text[I] == '0')
+    {
+        Spec.bZeroPad = true;
+        I++;
+    }
+    while (I < Text.size() && Text[I] >= '0' && Text[I] <= '9')
+    {
+        Spec.Width = Spec.Width * 10 + (Text[I++] - '0');
+        if (Spec.Width > MAX_WIDTH)
+        {
+            return false;
+        }
+    }
+    if (I < Text.size() && Text[I] == '.')
+    {
+        I++;
+        if (I == Text.size() || Text[I] < '0' || Text[I] > '9')
+        {
+            return false;
+        }
+        Spec.Precision = 0;
+        while (I < Text.size() && Text[I] >= '0' && Text[I] <= '9')
+        {
+            Spec.Precision = Spec.Precision * 10 + (Text[I++] - '0');
+            if (Spec.Precision > MAX_PRECISION)
+            {
+                return false;
+            }
+        }
+    }
+    if (I < Text.size() && (Text[I] == 's' || IsIntType(Text[I]) || IsFloatType(Text[I])))
+    {
+        Spec.Type = Text[I++];
+    }
+    return I == Text.size();
+}
+
+TFormat::TFormat(const std::string& InText)
+    : Text(InText)
+{
+    size_t Start = 0;
+    size_t Pos = 0;
+    while ((Pos = Text.find('{', Pos)) != std::string::npos && Pos + 1 < Text.size())
+    {
+        TSpec Spec;
+        size_t Close;
+        if (Text[Pos + 1] == '}')
+        {
+            Close = Pos + 1;
+        }
+        else if (Text[Pos + 1] == ':' && (Close = Text.find('}', Pos + 2)) != std::string::npos)
+        {
+            const std::string_view SpecText = std::string_view(Text).substr(Pos + 2, Close - Pos - 2);
+            if (!ParseSpec(SpecText, Spec))
+            {
+                Error = std::format("Invalid format spec '{}' in '{}'.", SpecText, Text);
+                return;
+            }
+        }
+        else
+        {
+            // Not a field, so the brace is literal text
+            Pos++;
+            continue;
+        }
+        Fields.push_back({Start, Pos - Start, Close + 1 - Pos, Spec});
+        Start = Close + 1;
+        Pos = Start;
+    }
+    TailOffset = Start;
+}
+
+// Appends the sign and digits of a value padded out to the spec's width
+static void Pad(std::string& Out, std::string_view Sign, std::string_view Body, const TSpec& Spec, bool bNumber)
+{
+    const size_t Length = Sign.size() + Body.size();
+    if (static_cast<size_t>(Spec.Width) <= Length)
+    {
+        Out += Sign;
+        Out += Body;
+        return;
+    }
+    const size_t Padding = Spec.Width - Length;
+    if (bNumber && Spec.bZeroPad && !Spec.Align)
+    {
+        Out += Sign;
+        Out.append(Padding, '0');
+        Out += Body;
+        return;
+    }
+
+    const char Align = Spec.Align ? Spec.Align : bNumber ? '>' : '<';
+    const size_t Before = Align == '>' ? Padding : Align == '^' ? Padding / 2 : 0;
+    Out.append(Before, Spec.Fill);
+    Out += Sign;
+    Out += Body;
+    Out.append(Padding - Before, Spec.Fill);
+}
+
+static std::string_view GetSign(bool bNegative, const TSpec& Spec)
+{
+    if (bNegative)
+    {
+        return "-";
+    }
+    return Spec.Sign == '+' ? "+" : Spec.Sign == ' ' ? " " : "";
+}
+
+static void WriteInt(std::string& Out, int Value, const TSpec& Spec)
+{
+    int Base = 10;
+    switch (Spec.Type)
+    {
+    case 'b' :
+    case 'B' :
+        Base = 2;
+        break;
+    case 'o' :
+        Base = 8;
+        break;
+    case 'x' :
+    case 'X' :
+        Base = 16;
+        break;
+    default :
+        break;
+    }
+
+    // The magnitude is formatted on its own so the sign can go before any zero padding
+    const bool bNegative = Value < 0;
+    const unsigned Magnitude = bNegative ? 0u - static_cast<unsigned>(Value) : static_cast<unsigned>(Value);
+    char Digits[40];
+    char* End = std::to_chars(Digits, Digits + sizeof(Digits), Magnitude, Base).ptr;
+    if (Spec.Type == 'X' || Spec.Type == 'B')
+    {
+        std::transform(Digits, End, Digits, [](char C) { return static_cast<char>(std::toupper(C)); });
+    }
+    Pad(Out, GetSign(bNegative, Spec), std::string_view(Digits, End - Digits), Spec, true);
+}
+
+// Takes a float as a float, so its shortest form has no more digits than a float holds, and an int as a double
+template <typename T>
+static void WriteFloat(std::string& Out, T Value, const TSpec& Spec)
+{
+    const bool bNegative = std::signbit(Value);
+    const T Magnitude = std::fabs(Value);
+    const int Precision = Spec.Precision < 0 ? 6 : Spec.Precision;
+    char Digits[MAX_PRECISION + 64];
+    char* const Last = Digits + sizeof(Digits);
+    char* End;
+    switch (Spec.Type)
+    {
+    case 'e' :
+    case 'E' :
+        End = std::to_chars(Digits, Last, Magnitude, std::chars_format::scientific, Precision).ptr;
+        break;
+    case 'f' :
+    case 'F' :
+        End = std::to_chars(Digits, Last, Magnitude, std::chars_format::fixed, Precision).ptr;
+        break;
+    case 'g' :
+    case 'G' :
+        End = std::to_chars(Digits, Last, Magnitude, std::chars_format::general, Precision).ptr;
+        break;
+    default :
+        End = Spec.Precision < 0 ? std::to_chars(Digits, Last, Magnitude).ptr
+                                 : std::to_chars(Digits, Last, Magnitude, std::chars_format::general, Precision).ptr;
+        break;
+    }
+    if (Spec.Type == 'E' || Spec.Type == 'F' || Spec.Type == 'G')
+    {
+        std::transform(Digits, End, Digits, [](char C) { return static_cast<char>(std::toupper(C)); });
+    }
+    Pad(Out, GetSign(bNegative, Spec), std::string_view(Digits, End - Digits), Spec, true);
+}
+
+// Appends one value as its field's spec says, returning false if the spec does not apply to its type
+static bool WriteValue(std::string& Out, const TObject& Value, const TSpec& Spec)
+{
+    const EValueType Type = Value.GetType();
+    if (Spec.bEmpty)
+    {
+        switch (Type)
+        {
+        case StringType :
+            Out += Value.RawString();
+            break;
+        case IntType :
+        {
+            char Digits[16];
+            Out.append(Digits, std::to_chars(Digits, Digits + sizeof(Digits), Value.RawInt()).ptr);
+            break;
+        }
+        default :
+            Out += Value.ToString();
+            break;
+        }
+        return true;
+    }
+
+    if (Type == FloatType && (Spec.Type == 0 || IsFloatType(Spec.Type)))
+    {
+        WriteFloat(Out, Value.RawFloat(), Spec);
+        return true;
+    }
+    if (Type == IntType && IsFloatType(Spec.Type))
+    {
+        WriteFloat(Out, static_cast<double>(Value.RawInt()), Spec);
+        return true;
+    }
+    if (Type == IntType && (Spec.Type == 0 || IsIntType(Spec.Type)) && Spec.Precision < 0)
+    {
+        WriteInt(Out, Value.RawInt(), Spec);
+        return true;
+    }
+    if (Type != IntType && Type != FloatType && (Spec.Type == 0 || Spec.Type == 's'))
+    {
+        const std::string Text = Value.ToString();
+        std::string_view Body = Text;
+        if (Spec.Precision >= 0)
+        {
+            Body = Body.substr(0, Spec.Precision);
+        }
+        Pad(Out, "", Body, Spec, false);
+        return true;
+    }
+    return false;
+}
+
+bool TFormat::Write(std::string& Out, TArgumentList Values) const
+{
+    for (size_t Index = 0; Index < Fields.size(); Index++)
+    {
+        const TSegment& Field = Fields[Index];
+        Out.append(Text, Field.Offset, Field.Length);
+        const TObject& Value = *Values[Index];
+        if (!WriteValue(Out, Value, Field.Spec))
+        {
+            const std::string FieldText = Text.substr(Field.Offset + Field.Length, Field.FieldLength);
+            Logging::Error("Field '{}' cannot format {} '{}'.", FieldText, GetTypeName(Value.GetType()),
+                           Value.ToString());
+            return false;
+        }
+    }
+    Out.append(Text, TailOffset);
+    return true;
+}
+
+const TFormat& TFormatCache::Get(const std::string& Text)
+{
+    if (const TFormat* Format = Formats.Find(Text))
+    {
+        return *Format;
+    }
+    if (Formats.Size() < CAPACITY)
+    {
+        return Formats[Text] = TFormat(Text);
+    }
+    Uncached = TFormat(Text);
+    return Uncached;
+}
@@ -0,0 +1,352 @@
+#include "../Public/Inference.h"
+
+#include <functional>
+
+#include "../Public/Ast.h"
+
+using namespace Inference;
+
+TType TType::Join(const TType& Other) const
+{
+    if (Kind == EKind::Unknown)
+    {
+        return Other;
+    }
+    if (Other.Kind == EKind::Unknown || *this == Other)
+    {
+        return *this;
+    }
+    return Dynamic();
+}
+
+// The type of a value, which is dynamic for null: the frame refuses to push null, so it never reaches an operator
+static TType OfValue(EValueType Type)
+{
+    return Type == NullType || Type == Void ? TType::Dynamic() : TType::Of(Type);
+}
+
+static bool IsNumber(EValueType Type)
+{
+    return Type == IntType || Type == FloatType;
+}
+
+// Whether operators on two operands of this type can run their kernel without checking the operands
+static bool IsSpecializable(EValueType Type)
+{
+    return Type == BoolType || IsNumber(Type) || Type == StringType;
+}
+
+// The type of a binary operator's result for operands of proven types. Pairs the kernel table does not support give
+// null, so they are dynamic.
+static TType GetProvenResultType(EBinaryOp Op, EValueType Left, EValueType Right)
+{
+    switch (Op)
+    {
+    case EBinaryOp::Add :
+        if (Left == StringType && Right == StringType)
+        {
+            return TType::Of(StringType);
+        }
+        [[fallthrough]];
+    case EBinaryOp::Sub :
+    case EBinaryOp::Mul :
+    case EBinaryOp::Div :
+        // Division by zero also gives null, but it logs an error, so nothing reads the result
+        if (IsNumber(Left) && IsNumber(Right))
+        {
+            return TType::Of(Left == IntType && Right == IntType ? IntType : FloatType);
+        }
+        return TType::Dynamic();
+    case EBinaryOp::Less :
+    case EBinaryOp::Greater :
+        return Left == Right && IsSpecializable(Left) ? TType::Of(BoolType) : TType::Dynamic();
+    default :
+        return TType::Dynamic();
+    }
+}
+
+TType Inference::GetResultType(EBinaryOp Op, const TType& Left, const TType& Right)
+{
+    // Equality is defined for every pair of types
+    if (Op == EBinaryOp::Equal || Op == EBinaryOp::NotEqual)
+    {
+        return TType::Of(BoolType);
+    }
+    if (Left.Kind == EKind::Unknown || Right.Kind == EKind::Unknown)
+    {
+        return {};
+    }
+    if (!Left.IsProven() || !Right.IsProven())
+    {
+        return TType::Dynamic();
+    }
+    return GetProvenResultType(Op, Left.Type, Right.Type);
+}
+
+TType Inference::GetUnaryType(ETokenType Op, const TType& Operand)
+{
+    if (Operand.Kind == EKind::Unknown)
+    {
+        return {};
+    }
+    if (Op == Not)
+    {
+        return Operand.Is(BoolType) ? Operand : TType::Dynamic();
+    }
+    return Op == Minus && (Operand.Is(IntType) || Operand.Is(FloatType)) ? Operand : TType::Dynamic();
+}
+
+static void ForEachChild(AstNode* Node, const std::function<void(AstNode*)>& Callback)
+{
+    auto Visit = [&Callback](AstNode* Child)
+    {
+        if (Child)
+        {
+            Callback(Child);
+        }
+    };
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Visit(Expression);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        Visit(Assignment->Right);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        Visit(If->Cond);
+        Visit(If->TrueBody);
+        Visit(If->FalseBody);
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        Visit(While->Cond);
+        Visit(While->Body);
+    }
+    else if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        Visit(BinOp->Left);
+        Visit(BinOp->Right);
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        Visit(Unary->Right);
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        Visit(Return->Expr);
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        for (AstNode* Arg : Call->Args)
+        {
+            Visit(Arg);
+        }
+    }
+    else if (const auto Function = Cast<AstFunction>(Node))
+    {
+        Visit(Function->Body);
+    }
+}
+
+void TTypeInference::Declare(AstNode* Node)
+{
+    if (const auto Function = Cast<AstFunction>(Node))
+    {
+        Declarations.emplace(Function->Name, Function);
+    }
+    ForEachChild(Node, [this](AstNode* Child) { Declare(Child); });
+}
+
+void TTypeInference::Bind(const std::string& Name, const TType& Type)
+{
+    TType& Variable = Variables[Name];
+    const TType Joined = Variable.Join(Type);
+    if (Joined != Variable)
+    {
+        Variable = Joined;
+        bChanged = true;
+    }
+}
+
+void TTypeInference::Infer(AstNode* Node)
+{
+    // Function bodies are inferred on their own, whether or not this declaration is the one calls run
+    if (Cast<AstFunction>(Node))
+    {
+        return;
+    }
+    ForEachChild(Node, [this](AstNode* Child) { Infer(Child); });
+
+    if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        const EValueType Annotation = Assignment->Annotation;
+        Bind(Assignment->Name, Annotation != Void ? TType::Of(Annotation) : TypeOf(Assignment->Right));
+    }
+    else if (const auto Call = Cast<AstCall>(Node); Call && Call->Type == Function)
+    {
+        const auto BuiltIn = Runtime::GetContext().BuiltIns.find(Call->Identifier);
+        if (BuiltIn != Runtime::GetContext().BuiltIns.end())
+        {
+            // A mutating built-in may store a value of any type in a variable passed to it, as recv and next_line do
+            if (BuiltIn->second.GetPurity() == EPurity::Mutating)
+            {
+                for (AstNode* Arg : Call->Args)
+                {
+                    if (const auto Identifier = Cast<AstIdentifier>(Arg))
+                    {
+                        Bind(Identifier->Name, TType::Dynamic());
+                    }
+                }
+            }
+            return;
+        }
+
+        // Parameters are bound to the arguments of every call which could reach them
+        const auto [First, Last] = Declarations.equal_range(Call->Identifier);
+        for (auto It = First; It != Last; ++It)
+        {
+            const AstFunction* Declaration = It->second;
+            if (Declaration->Args.size() != Call->Args.size())
+            {
+                continue;
+            }
+            for (size_t Index = 0; Index < Call->Args.size(); Index++)
+            {
+                const EValueType ArgType = Declaration->ArgTypes[Index];
+                Bind(Declaration->Args[Index], ArgType != Void ? TType::Of(ArgType) : TypeOf(Call->Args[Index]));
+            }
+        }
+    }
+}
+
+TType TTypeInference::TypeOf(AstNode* Node)
+{
+    if (const auto Value = Cast<AstValue>(Node))
+    {
+        return OfValue(Value->Value.GetType());
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        const auto It = Variables.find(Identifier->Name);
+        return It == Variables.end() ? TType() : It->second;
+    }
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        if (BinOp->BinaryOp == EBinaryOp::Count)
+        {
+            return TType::Dynamic();
+        }
+        return GetResultType(BinOp->BinaryOp, TypeOf(BinOp->Left), TypeOf(BinOp->Right));
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return GetUnaryType(Unary->Op, TypeOf(Unary->Right));
+    }
+    const auto Call = Cast<AstCall>(Node);
+    if (Call && Call->Type == Function && !Runtime::GetContext().BuiltIns.contains(Call->Identifier))
+    {
+        // A call returns the type its function declares, if every function it could run declares the same one
+        TType Result = TType::Dynamic();
+        const auto [First, Last] = Declarations.equal_range(Call->Identifier);
+        for (auto It = First; It != Last; ++It)
+        {
+            const AstFunction* Declaration = It->second;
+            if (Declaration->Args.size() != Call->Args.size())
+            {
+                continue;
+            }
+            if (Declaration->ReturnType == Void || (Result.IsProven() && Result.Type != Declaration->ReturnType))
+            {
+                return TType::Dynamic();
+            }
+            Result = TType::Of(Declaration->ReturnType);
+        }
+        return Result;
+    }
+
+    // Other calls return whatever their function leaves on the stack, and elements may be of any type
+    return TType::Dynamic();
+}
+
+void TTypeInference::Specialize(AstNode* Node, TReport* Report)
+{
+    ForEachChild(Node, [this, Report](AstNode* Child) { Specialize(Child, Report); });
+
+    bool bSpecialized;
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        if (BinOp->BinaryOp == EBinaryOp::Count)
+        {
+            return;
+        }
+        const TType Left = TypeOf(BinOp->Left);
+        const TType Right = TypeOf(BinOp->Right);
+        bSpecialized = Left.IsProven() && Left == Right && IsSpecializable(Left.Type);
+        // A node proven before goes back to quickening if a later program assigns one of its operands another type
+        BinOp->ProvenKernel = bSpecialized ? TObject::GetBinaryKernel(BinOp->BinaryOp, Left.Type, Right.Type) : nullptr;
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        const TType Operand = TypeOf(Unary->Right);
+        bSpecialized = Unary->Op == Not
+            ? Operand.Is(BoolType)
+            : Unary->Op == Minus && (Operand.Is(IntType) || Operand.Is(FloatType));
+        Unary->ProvenType = bSpecialized ? Operand.Type : NullType;
+    }
+    else
+    {
+        return;
+    }
+
+    if (Report)
+    {
+        Report->Operations++;
+        Report->Specialized += bSpecialized;
+    }
+}
+
+TReport TTypeInference::Run(AstBody* Program)
+{
+    Variables.clear();
+    Declarations.clear();
+
+    // Variables keep their values between the programs of a session
+    for (const auto& [Name, Value] : CurrentFrame->Identifiers)
+    {
+        if (Value && Value->GetType() != NullType)
+        {
+            Bind(Name, OfValue(Value->GetType()));
+        }
+    }
+
+    for (const auto& [Name, Function] : Functions)
+    {
+        Declare(Function);
+    }
+    Declare(Program);
+
+    // Types only grow along the lattice, so this ends once a pass binds nothing new
+    do
+    {
+        bChanged = false;
+        Infer(Program);
+        for (const auto& [Name, Function] : Declarations)
+        {
+            Infer(Function->Body);
+        }
+    }
+    while (bChanged);
+
+    for (const auto& [Name, Function] : Functions)
+    {
+        Specialize(Function->Body, nullptr);
+    }
+    TReport Report;
+    Specialize(Program, &Report);
+    return Report;
+}
@@ -0,0 +1,823 @@
+#include "../Public/Jit.h"
+
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+#include "../Public/Ast.h"
+
+#if defined(_WIN32)
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+using namespace Jit;
+
+////////////////////////
+// Executable memory //
+////////////////////////
+
+TExecutableMemory::~TExecutableMemory()
+{
+    if (!Memory)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree(Memory, 0, MEM_RELEASE);
+#else
+    munmap(Memory, Size);
+#endif
+}
+
+bool TExecutableMemory::Load(const std::vector<uint8_t>& Code)
+{
+#if defined(_WIN32)
+    void* Block = VirtualAlloc(nullptr, Code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!Block)
+    {
+        return false;
+    }
+    std::memcpy(Block, Code.data(), Code.size());
+    DWORD OldProtect;
+    if (!VirtualProtect(Block, Code.size(), PAGE_EXECUTE_READ, &OldProtect))
+    {
+        VirtualFree(Block, 0, MEM_RELEASE);
+        return false;
+    }
+    FlushInstructionCache(GetCurrentProcess(), Block, Code.size());
+#else
+    void* Block = mmap(nullptr, Code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Block == MAP_FAILED)
+    {
+        return false;
+    }
+    std::memcpy(Block, Code.data(), Code.size());
+    if (mprotect(Block, Code.size(), PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(Block, Code.size());
+        return false;
+    }
+#endif
+    Memory = Block;
+    Size = Code.size();
+    return true;
+}
+
+/////////////
+// Regions //
+/////////////
+
+EStatus TRegion::Run(Frame* InFrame, int Count)
+{
+    // Check every variable still has the type the code was specialized to before touching anything
+    for (TSlotVariable& Variable : Variables)
+    {
+        const TObject* Value = InFrame->GetIdentifier(Variable.Name);
+        if (!Value || Value->GetType() != Variable.Type)
+        {
+            return EStatus::GuardFailed;
+        }
+        Slots[Variable.Slot] = Variable.Type == IntType
+                                   ? static_cast<int64_t>(Value->RawInt())
+                                   : static_cast<int64_t>(std::bit_cast<uint32_t>(Value->RawFloat()));
+        if (Variable.DirtySlot >= 0)
+        {
+            Slots[Variable.DirtySlot] = 0;
+        }
+    }
+    if (CounterSlot >= 0)
+    {
+        Slots[CounterSlot] = Count;
+    }
+
+    const int Status = reinterpret_cast<TEntryPoint>(Code.GetCode())(Slots.data());
+
+    // The code only ever writes the low 32 bits of a slot
+    for (TSlotVariable& Variable : Variables)
+    {
+        if (Variable.DirtySlot < 0 || Slots[Variable.DirtySlot] == 0)
+        {
+            continue;
+        }
+        const uint32_t Bits = static_cast<uint32_t>(Slots[Variable.Slot]);
+        if (Variable.Type == IntType)
+        {
+            Variable.Storage.SetInt(static_cast<int32_t>(Bits));
+        }
+        else
+        {
+            Variable.Storage.SetFloat(std::bit_cast<float>(Bits));
+        }
+        InFrame->SetIdentifier(Variable.Name, &Variable.Storage);
+    }
+    if (ResultSlot >= 0)
+    {
+        const uint32_t Bits = static_cast<uint32_t>(Slots[ResultSlot]);
+        if (ResultType == IntType)
+        {
+            Result.SetInt(static_cast<int32_t>(Bits));
+        }
+        else
+        {
+            Result.SetFloat(std::bit_cast<float>(Bits));
+        }
+    }
+
+    return static_cast<EStatus>(Status);
+}
+
+//////////////
+// Compiler //
+//////////////
+
+namespace Jit
+{
+    // The second byte of a two-byte jcc rel32
+    enum ECondition : uint8_t
+    {
+        Below = 0x82,
+        Equal = 0x84,
+        NotEqual = 0x85,
+        BelowEqual = 0x86,
+        Parity = 0x8A,
+        Less = 0x8C,
+        GreaterEqual = 0x8D,
+        LessEqual = 0x8E,
+        Greater = 0x8F,
+    };
+
+    /// <summary>
+    /// Generates x86-64 code for a region in a single pass over the tree.
+    /// <para>
+    /// Every variable lives in an 8-byte slot in an array pointed to by rbx. Expressions are evaluated into eax for
+    /// ints and xmm0 for floats, with the right operand of a binary operator in ecx or xmm1; intermediate values of
+    /// nested expressions are pushed to the native stack. Ints are 32 bits wide and floats are single precision, the
+    /// same as the interpreter's values.
+    /// </para>
+    /// </summary>
+    class TCompiler
+    {
+        TRegion* Region;
+        Frame* CurrentFrame;
+        std::vector<uint8_t> Code;
+        std::vector<size_t> Labels;                   // Code offset of each label once bound
+        std::vector<std::pair<size_t, int>> Fixups;   // Offset of a rel32 and the label it targets
+        int SlotCount = 0;
+        int MaxLoopLabel;
+        int DivideByZeroLabel;
+        int DivideOverflowLabel;
+        int EpilogueLabel;
+
+    public:
+        std::string Reason; // Why the region was rejected
+
+        TCompiler(TRegion* InRegion, Frame* InFrame)
+            : Region(InRegion)
+              , CurrentFrame(InFrame)
+        {
+            MaxLoopLabel = NewLabel();
+            DivideByZeroLabel = NewLabel();
+            DivideOverflowLabel = NewLabel();
+            EpilogueLabel = NewLabel();
+        }
+
+        bool Compile(const AstWhile* Loop, const AstFunction* Function);
+
+    private:
+        bool Fail(std::string_view InReason)
+        {
+            if (Reason.empty())
+            {
+                Reason = InReason;
+            }
+            return false;
+        }
+
+        int NewSlot() { return SlotCount++; }
+        int FindVariable(const std::string& Name);
+        EValueType TypeOf(const AstNode* Node);
+
+        // Emitting
+
+        void Emit(std::initializer_list<uint8_t> Bytes) { Code.insert(Code.end(), Bytes); }
+        void Emit32(uint32_t Value)
+        {
+            for (int Shift = 0; Shift < 32; Shift += 8)
+            {
+                Code.push_back(static_cast<uint8_t>(Value >> Shift));
+            }
+        }
+        // Emits an instruction whose last operand is [rbx + disp32]
+        void EmitSlot(std::initializer_list<uint8_t> Bytes, int Slot)
+        {
+            Emit(Bytes);
+            Emit32(static_cast<uint32_t>(Slot * 8));
+        }
+
+        int NewLabel()
+        {
+            Labels.push_back(SIZE_MAX);
+            return static_cast<int>(Labels.size() - 1);
+        }
+        void Bind(int Label) { Labels[Label] = Code.size(); }
+        void EmitJump(int Label)
+        {
+            Emit({0xE9}); // jmp rel32
+            Fixups.emplace_back(Code.size(), Label);
+            Emit32(0);
+        }
+        void EmitBranch(ECondition Condition, int Label)
+        {
+            Emit({0x0F, Condition}); // jcc rel32
+            Fixups.emplace_back(Code.size(), Label);
+            Emit32(0);
+        }
+        void PatchJumps();
+
+        void EmitLeaf(const AstNode* Node, EValueType Type, bool bSecond);
+        bool EmitExpr(const AstNode* Node, EValueType Type);
+        bool EmitOperands(const AstBinOp* Node, EValueType Type);
+        bool EmitCondition(const AstNode* Node, int FalseLabel);
+        bool EmitStatement(const AstNode* Node);
+        bool EmitWhile(const AstWhile* Node, int CounterSlot, bool bResume);
+    };
+} // namespace Jit
+
+static bool IsLeaf(const AstNode* Node)
+{
+    return Cast<const AstValue>(Node) || Cast<const AstIdentifier>(Node);
+}
+
+static bool IsComparison(EBinaryOp Op)
+{
+    return Op == EBinaryOp::Less || Op == EBinaryOp::Greater || Op == EBinaryOp::Equal || Op == EBinaryOp::NotEqual;
+}
+
+int TCompiler::FindVariable(const std::string& Name)
+{
+    for (int Index = 0; Index < static_cast<int>(Region->Variables.size()); Index++)
+    {
+        if (Region->Variables[Index].Name == Name)
+        {
+            return Index;
+        }
+    }
+
+    // Variables are typed by their current value, so each one must already exist when the region is compiled
+    const TObject* Value = CurrentFrame->GetIdentifier(Name);
+    if (!Value || (Value->GetType() != IntType && Value->GetType() != FloatType))
+    {
+        Fail(std::format("'{}' is not an int or float", Name));
+        return -1;
+    }
+    TSlotVariable& Variable = Region->Variables.emplace_back();
+    Variable.Name = Name;
+    Variable.Type = Value->GetType();
+    Variable.Slot = NewSlot();
+    return static_cast<int>(Region->Variables.size() - 1);
+}
+
+EValueType TCompiler::TypeOf(const AstNode* Node)
+{
+    if (const auto Value = Cast<const AstValue>(Node))
+    {
+        const EValueType Type = Value->Value.GetType();
+        if (Type != IntType && Type != FloatType)
+        {
+            Fail("literal is not an int or float");
+            return NullType;
+        }
+        return Type;
+    }
+    if (const auto Identifier = Cast<const AstIdentifier>(Node))
+    {
+        const int Index = FindVariable(Identifier->Name);
+        return Index < 0 ? NullType : Region->Variables[Index].Type;
+    }
+    if (const auto Unary = Cast<const AstUnaryExpr>(Node))
+    {
+        if (Unary->Op != Minus)
+        {
+            Fail("unsupported unary operator");
+            return NullType;
+        }
+        return TypeOf(Unary->Right);
+    }
+    if (const auto BinOp = Cast<const AstBinOp>(Node))
+    {
+        if (BinOp->BinaryOp == EBinaryOp::Count || IsComparison(BinOp->BinaryOp))
+        {
+            Fail("comparison used as a value");
+            return NullType;
+        }
+        const EValueType Left = TypeOf(BinOp->Left);
+        const EValueType Right = TypeOf(BinOp->Right);
+        if (Left == NullType || Right == NullType)
+        {
+            return NullType;
+        }
+        // Mixed arithmetic converts the int to a float, as the interpreter's kernels do
+        return Left == IntType && Right == IntType ? IntType : FloatType;
+    }
+    Fail("unsupported expression");
+    return NullType;
+}
+
+void TCompiler::PatchJumps()
+{
+    for (const auto& [Offset, Label] : Fixups)
+    {
+        const auto Relative = static_cast<int32_t>(Labels[Label] - (Offset + 4));
+        std::memcpy(Code.data() + Offset, &Relative, sizeof(Relative));
+    }
+}
+
+// Loads a literal or variable into eax/xmm0, or ecx/xmm1 if bSecond is set, converting an int to a float if Type is
+// FloatType. The node must already have been typed.
+void TCompiler::EmitLeaf(const AstNode* Node, EValueType Type, bool bSecond)
+{
+    if (const auto Value = Cast<const AstValue>(Node))
+    {
+        uint32_t Bits;
+        if (Type == IntType)
+        {
+            Bits = static_cast<uint32_t>(Value->Value.RawInt());
+        }
+        else if (Value->Value.GetType() == IntType)
+        {
+            Bits = std::bit_cast<uint32_t>(static_cast<float>(Value->Value.RawInt()));
+        }
+        else
+        {
+            Bits = std::bit_cast<uint32_t>(Value->Value.RawFloat());
+        }
+        Emit({static_cast<uint8_t>(bSecond ? 0xB9 : 0xB8)}); // mov eax/ecx, imm32
+        Emit32(Bits);
+        if (Type == FloatType)
+        {
+            Emit({0x66, 0x0F, 0x6E, static_cast<uint8_t>(bSecond ? 0xC9 : 0xC0)}); // movd xmm0/xmm1, eax/ecx
+        }
+        return;
+    }
+
+    const TSlotVariable& Variable = Region->Variables[FindVariable(Cast<const AstIdentifier>(Node)->Name)];
+    if (Variable.Type == FloatType)
+    {
+        EmitSlot({0xF3, 0x0F, 0x10, static_cast<uint8_t>(bSecond ? 0x8B : 0x83)}, Variable.Slot); // movss xmm, [slot]
+        return;
+    }
+    EmitSlot({0x8B, static_cast<uint8_t>(bSecond ? 0x8B : 0x83)}, Variable.Slot); // mov eax/ecx, [slot]
+    if (Type == FloatType)
+    {
+        Emit({0xF3, 0x0F, 0x2A, static_cast<uint8_t>(bSecond ? 0xC9 : 0xC0)}); // cvtsi2ss xmm0/xmm1, eax/ecx
+    }
+}
+
+// Evaluates both operands of a binary operator as Type, leaving the left in eax/xmm0 and the right in ecx/xmm1
+bool TCompiler::EmitOperands(const AstBinOp* Node, EValueType Type)
+{
+    if (!EmitExpr(Node->Left, Type))
+    {
+        return false;
+    }
+    if (IsLeaf(Node->Right))
+    {
+        EmitLeaf(Node->Right, Type, true);
+        return true;
+    }
+
+    if (Type == IntType)
+    {
+        Emit({0x50}); // push rax
+    }
+    else
+    {
+        Emit({0x48, 0x83, 0xEC, 0x08});       // sub rsp, 8
+        Emit({0xF3, 0x0F, 0x11, 0x04, 0x24}); // movss [rsp], xmm0
+    }
+    if (!EmitExpr(Node->Right, Type))
+    {
+        return false;
+    }
+    if (Type == IntType)
+    {
+        Emit({0x89, 0xC1}); // mov ecx, eax
+        Emit({0x58});       // pop rax
+    }
+    else
+    {
+        Emit({0x0F, 0x28, 0xC8});             // movaps xmm1, xmm0
+        Emit({0xF3, 0x0F, 0x10, 0x04, 0x24}); // movss xmm0, [rsp]
+        Emit({0x48, 0x83, 0xC4, 0x08});       // add rsp, 8
+    }
+    return true;
+}
+
+// Evaluates an expression into eax if Type is IntType, or xmm0 if it is FloatType
+bool TCompiler::EmitExpr(const AstNode* Node, EValueType Type)
+{
+    const EValueType NodeType = TypeOf(Node);
+    if (NodeType == NullType)
+    {
+        return false;
+    }
+    if (IsLeaf(Node))
+    {
+        EmitLeaf(Node, Type, false);
+        return true;
+    }
+
+    if (const auto Unary = Cast<const AstUnaryExpr>(Node))
+    {
+        // The interpreter negates by multiplying by -1, which keeps the sign of a NaN
+        if (!EmitExpr(Unary->Right, NodeType))
+        {
+            return false;
+        }
+        if (NodeType == IntType)
+        {
+            Emit({0xF7, 0xD8}); // neg eax
+        }
+        else
+        {
+            Emit({0xB9});                         // mov ecx, -1.0f
+            Emit32(std::bit_cast<uint32_t>(-1.0f));
+            Emit({0x66, 0x0F, 0x6E, 0xC9});       // movd xmm1, ecx
+            Emit({0xF3, 0x0F, 0x59, 0xC1});       // mulss xmm0, xmm1
+        }
+    }
+    else
+    {
+        const auto BinOp = Cast<const AstBinOp>(Node);
+        if (!EmitOperands(BinOp, NodeType))
+        {
+            return false;
+        }
+        if (NodeType == IntType)
+        {
+            switch (BinOp->BinaryOp)
+            {
+            case EBinaryOp::Add :
+                Emit({0x01, 0xC8}); // add eax, ecx
+                break;
+            case EBinaryOp::Sub :
+                Emit({0x29, 0xC8}); // sub eax, ecx
+                break;
+            case EBinaryOp::Mul :
+                Emit({0x0F, 0xAF, 0xC1}); // imul eax, ecx
+                break;
+            default :
+            {
+                Emit({0x85, 0xC9}); // test ecx, ecx
+                EmitBranch(Equal, DivideByZeroLabel);
+                // INT_MIN / -1 overflows and traps like a division by zero
+                const int DivideLabel = NewLabel();
+                Emit({0x83, 0xF9, 0xFF}); // cmp ecx, -1
+                EmitBranch(NotEqual, DivideLabel);
+                Emit({0x3D});             // cmp eax, INT_MIN
+                Emit32(0x80000000);
+                EmitBranch(Equal, DivideOverflowLabel);
+                Bind(DivideLabel);
+                Emit({0x99});       // cdq
+                Emit({0xF7, 0xF9}); // idiv ecx
+                break;
+            }
+            }
+        }
+        else
+        {
+            switch (BinOp->BinaryOp)
+            {
+            case EBinaryOp::Add :
+                Emit({0xF3, 0x0F, 0x58, 0xC1}); // addss xmm0, xmm1
+                break;
+            case EBinaryOp::Sub :
+                Emit({0xF3, 0x0F, 0x5C, 0xC1}); // subss xmm0, xmm1
+                break;
+            case EBinaryOp::Mul :
+                Emit({0xF3, 0x0F, 0x59, 0xC1}); // mulss xmm0, xmm1
+                break;
+            default :
+                Emit({0xF3, 0x0F, 0x5E, 0xC1}); // divss xmm0, xmm1
+                break;
+            }
+        }
+    }
+
+    if (NodeType == IntType && Type == FloatType)
+    {
+        Emit({0xF3, 0x0F, 0x2A, 0xC0}); // cvtsi2ss xmm0, eax
+    }
+    return true;
+}
+
+// Evaluates a comparison and jumps to FalseLabel if it is false
+bool TCompiler::EmitCondition(const AstNode* Node, int FalseLabel)
+{
+    const auto BinOp = Cast<const AstBinOp>(Node);
+    if (!BinOp || !IsComparison(BinOp->BinaryOp))
+    {
+        return Fail("condition is not a comparison");
+    }
+    const EValueType Left = TypeOf(BinOp->Left);
+    const EValueType Right = TypeOf(BinOp->Right);
+    if (Left == NullType || Right == NullType)
+    {
+        return false;
+    }
+    // The interpreter only compares values of the same type
+    if (Left != Right)
+    {
+        return Fail("comparison of an int with a float");
+    }
+    if (!EmitOperands(BinOp, Left))
+    {
+        return false;
+    }
+
+    if (Left == IntType)
+    {
+        Emit({0x39, 0xC8}); // cmp eax, ecx
+        switch (BinOp->BinaryOp)
+        {
+        case EBinaryOp::Less :
+            EmitBranch(GreaterEqual, FalseLabel);
+            break;
+        case EBinaryOp::Greater :
+            EmitBranch(LessEqual, FalseLabel);
+            break;
+        case EBinaryOp::Equal :
+            EmitBranch(NotEqual, FalseLabel);
+            break;
+        default :
+            EmitBranch(Equal, FalseLabel);
+            break;
+        }
+        return true;
+    }
+
+    // comiss sets ZF, PF and CF for an unordered result, so every branch below treats NaN as the interpreter does
+    switch (BinOp->BinaryOp)
+    {
+    case EBinaryOp::Less :
+        Emit({0x0F, 0x2F, 0xC8}); // comiss xmm1, xmm0
+        EmitBranch(BelowEqual, FalseLabel);
+        break;
+    case EBinaryOp::Greater :
+        Emit({0x0F, 0x2F, 0xC1}); // comiss xmm0, xmm1
+        EmitBranch(BelowEqual, FalseLabel);
+        break;
+    case EBinaryOp::Equal :
+        Emit({0x0F, 0x2F, 0xC1}); // comiss xmm0, xmm1
+        EmitBranch(Parity, FalseLabel);
+        EmitBranch(NotEqual, FalseLabel);
+        break;
+    default :
+        {
+            const int TrueLabel = NewLabel();
+            Emit({0x0F, 0x2F, 0xC1}); // comiss xmm0, xmm1
+            EmitBranch(Parity, TrueLabel);
+            EmitBranch(Equal, FalseLabel);
+            Bind(TrueLabel);
+            break;
+        }
+    }
+    return true;
+}
+
+bool TCompiler::EmitStatement(const AstNode* Node)
+{
+    if (const auto Body = Cast<const AstBody>(Node))
+    {
+        for (const AstNode* Expression : Body->Expressions)
+        {
+            if (!EmitStatement(Expression))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (const auto Assignment = Cast<const AstAssignment>(Node))
+    {
+        const int Index = FindVariable(Assignment->Name);
+        if (Index < 0)
+        {
+            return false;
+        }
+        const EValueType Type = TypeOf(Assignment->Right);
+        if (Type == NullType)
+        {
+            return false;
+        }
+        if (Type != Region->Variables[Index].Type)
+        {
+            return Fail(std::format("assignment changes the type of '{}'", Assignment->Name));
+        }
+        if (Assignment->Annotation != Void && Type != Assignment->Annotation)
+        {
+            return Fail(std::format("assignment to '{}' does not match its annotation", Assignment->Name));
+        }
+        if (!EmitExpr(Assignment->Right, Type))
+        {
+            return false;
+        }
+        TSlotVariable& Variable = Region->Variables[Index];
+        if (Variable.DirtySlot < 0)
+        {
+            Variable.DirtySlot = NewSlot();
+        }
+        if (Type == IntType)
+        {
+            EmitSlot({0x89, 0x83}, Variable.Slot); // mov [slot], eax
+        }
+        else
+        {
+            EmitSlot({0xF3, 0x0F, 0x11, 0x83}, Variable.Slot); // movss [slot], xmm0
+        }
+        EmitSlot({0xC7, 0x83}, Variable.DirtySlot); // mov dword [dirty], 1
+        Emit32(1);
+        return true;
+    }
+    if (const auto While = Cast<const AstWhile>(Node))
+    {
+        return EmitWhile(While, NewSlot(), false);
+    }
+    if (const auto If = Cast<const AstIf>(Node))
+    {
+        const int ElseLabel = NewLabel();
+        if (!EmitCondition(If->Cond, ElseLabel) || !EmitStatement(If->TrueBody))
+        {
+            return false;
+        }
+        if (!If->FalseBody)
+        {
+            Bind(ElseLabel);
+            return true;
+        }
+        const int EndLabel = NewLabel();
+        EmitJump(EndLabel);
+        Bind(ElseLabel);
+        if (!EmitStatement(If->FalseBody))
+        {
+            return false;
+        }
+        Bind(EndLabel);
+        return true;
+    }
+    return Fail("unsupported statement");
+}
+
+// Emits a loop which counts its iterations in CounterSlot and exits with MaxLoop when the count reaches the context's
+// loop limit, exactly as the interpreter does. A resumed loop starts from the count already in the slot.
+bool TCompiler::EmitWhile(const AstWhile* Node, int CounterSlot, bool bResume)
+{
+    if (!bResume)
+    {
+        EmitSlot({0xC7, 0x83}, CounterSlot); // mov dword [counter], 1
+        Emit32(1);
+    }
+    const int HeadLabel = NewLabel();
+    const int ExitLabel = NewLabel();
+    Bind(HeadLabel);
+    if (!EmitCondition(Node->Cond, ExitLabel) || !EmitStatement(Node->Body))
+    {
+        return false;
+    }
+    EmitSlot({0x8B, 0x83}, CounterSlot); // mov eax, [counter]
+    Emit({0x83, 0xC0, 0x01});            // add eax, 1
+    EmitSlot({0x89, 0x83}, CounterSlot); // mov [counter], eax
+    Emit({0x3D});                        // cmp eax, imm32
+    Emit32(static_cast<uint32_t>(Runtime::GetContext().MaxLoop));
+    EmitBranch(Equal, MaxLoopLabel);
+    EmitJump(HeadLabel);
+    Bind(ExitLabel);
+    return true;
+}
+
+bool TCompiler::Compile(const AstWhile* Loop, const AstFunction* Function)
+{
+    // Prologue: rbx is callee-saved under both calling conventions and holds the slot array. rbp keeps the stack
+    // pointer as it was here, so an exit from inside a nested expression drops the operands it pushed.
+    Emit({0x55});             // push rbp
+    Emit({0x48, 0x89, 0xE5}); // mov rbp, rsp
+    Emit({0x53});             // push rbx
+#if defined(_WIN32)
+    Emit({0x48, 0x89, 0xCB}); // mov rbx, rcx
+#else
+    Emit({0x48, 0x89, 0xFB}); // mov rbx, rdi
+#endif
+
+    if (Loop)
+    {
+        Region->CounterSlot = NewSlot();
+        if (!EmitWhile(Loop, Region->CounterSlot, true))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        const auto Body = Cast<const AstBody>(Function->Body);
+        if (!Body)
+        {
+            return Fail("function body is not a block");
+        }
+        for (size_t Index = 0; Index < Body->Expressions.size(); Index++)
+        {
+            const AstNode* Expression = Body->Expressions[Index];
+            // A function returns the value of its last expression
+            const bool bValue = Cast<const AstValue>(Expression) || Cast<const AstIdentifier>(Expression)
+                || Cast<const AstUnaryExpr>(Expression) || Cast<const AstBinOp>(Expression);
+            if (!bValue)
+            {
+                if (!EmitStatement(Expression))
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (Index != Body->Expressions.size() - 1)
+            {
+                return Fail("expression statement before the end of the function");
+            }
+            Region->ResultType = TypeOf(Expression);
+            if (Region->ResultType == NullType || !EmitExpr(Expression, Region->ResultType))
+            {
+                return false;
+            }
+            Region->ResultSlot = NewSlot();
+            if (Region->ResultType == IntType)
+            {
+                EmitSlot({0x89, 0x83}, Region->ResultSlot); // mov [result], eax
+            }
+            else
+            {
+                EmitSlot({0xF3, 0x0F, 0x11, 0x83}, Region->ResultSlot); // movss [result], xmm0
+            }
+        }
+    }
+
+    Emit({0x31, 0xC0}); // xor eax, eax
+    Bind(EpilogueLabel);
+    Emit({0x48, 0x8D, 0x65, 0xF8}); // lea rsp, [rbp - 8]
+    Emit({0x5B});                   // pop rbx
+    Emit({0x5D});                   // pop rbp
+    Emit({0xC3});                   // ret
+
+    Bind(MaxLoopLabel);
+    Emit({0xB8}); // mov eax, imm32
+    Emit32(static_cast<uint32_t>(EStatus::MaxLoop));
+    EmitJump(EpilogueLabel);
+
+    Bind(DivideByZeroLabel);
+    Emit({0xB8}); // mov eax, imm32
+    Emit32(static_cast<uint32_t>(EStatus::DivideByZero));
+    EmitJump(EpilogueLabel);
+
+    Bind(DivideOverflowLabel);
+    Emit({0xB8}); // mov eax, imm32
+    Emit32(static_cast<uint32_t>(EStatus::DivideOverflow));
+    EmitJump(EpilogueLabel);
+
+    PatchJumps();
+    Region->Slots.assign(SlotCount, 0);
+    if (!Region->Code.Load(Code))
+    {
+        return Fail("unable to allocate executable memory");
+    }
+    return true;
+}
+
+/////////
+// JIT //
+/////////
+
+TRegion* TJit::Compile(const AstWhile* Loop, const AstFunction* Function, Frame* InFrame)
+{
+    auto Region = std::make_unique<TRegion>();
+    TCompiler Compiler(Region.get(), InFrame);
+    if (!IsSupported())
+    {
+        Compiler.Reason = "unsupported platform";
+    }
+    else if (Compiler.Compile(Loop, Function))
+    {
+        Stats.Compiled++;
+        Regions.push_back(std::move(Region));
+        return Regions.back().get();
+    }
+
+    Stats.Rejected++;
+    Logging::Debug("JIT: {} not compiled: {}", Function ? "'" + Function->Name + "'" : "loop", Compiler.Reason);
+    return nullptr;
+}
+
+bool Jit::IsSupported()
+{
+    return JIT_SUPPORTED == 1;
+}
@@ -0,0 +1,113 @@
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LINE_READER_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define LINE_READER_SSE2 0
+#endif
+
+#include "../Public/LineReader.h"
+
+using namespace Io;
+
+// Returns the first '\n' in [First, Last), or Last if there is none. Lines are usually short, so this compares 16
+// bytes at a time rather than setting up for long runs as memchr does.
+static const char* FindNewline(const char* First, const char* Last)
+{
+#if LINE_READER_SSE2
+    const __m128i Newline = _mm_set1_epi8('\n');
+    while (Last - First >= 16)
+    {
+        const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(First));
+        const uint32_t Mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, Newline)));
+        if (Mask != 0)
+        {
+            return First + std::countr_zero(Mask);
+        }
+        First += 16;
+    }
+#endif
+    const void* Found = std::memchr(First, '\n', Last - First);
+    return Found != nullptr ? static_cast<const char*>(Found) : Last;
+}
+
+std::shared_ptr<TLineReader> TLineReader::Open(const std::string& Path)
+{
+    std::FILE* File = std::fopen(Path.c_str(), "rb");
+    if (File == nullptr)
+    {
+        return nullptr;
+    }
+    // The reader's own buffer is the only one needed
+    std::setvbuf(File, nullptr, _IONBF, 0);
+    return std::make_shared<TLineReader>(File);
+}
+
+TLineReader::TLineReader(std::FILE* InFile)
+    : File(InFile)
+    , Buffer(std::make_unique<char[]>(BUFFER_SIZE))
+{
+}
+
+TLineReader::~TLineReader()
+{
+    if (File != nullptr)
+    {
+        std::fclose(File);
+    }
+}
+
+bool TLineReader::Fill()
+{
+    if (File == nullptr)
+    {
+        return false;
+    }
+    Begin = 0;
+    End = std::fread(Buffer.get(), 1, BUFFER_SIZE, File);
+    return End > 0;
+}
+
+bool TLineReader::Next(std::string& Line)
+{
+    std::lock_guard Lock(Mutex);
+    Line.clear();
+    bool bPartial = false;
+    while (true)
+    {
+        if (Begin == End && !Fill())
+        {
+            // A last line without a newline still counts
+            return bPartial;
+        }
+
+        const char* First = Buffer.get() + Begin;
+        const char* Last = Buffer.get() + End;
+        const char* Newline = FindNewline(First, Last);
+        Line.append(First, Newline);
+        if (Newline != Last)
+        {
+            Begin += Newline - First + 1;
+            return true;
+        }
+
+        // The line goes on past the buffer
+        Begin = End;
+        bPartial = true;
+    }
+}
+
+void TLineReader::Close()
+{
+    std::lock_guard Lock(Mutex);
+    if (File != nullptr)
+    {
+        std::fclose(File);
+        File = nullptr;
+    }
+    Begin = 0;
+    End = 0;
+}
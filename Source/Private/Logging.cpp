@@ -1,14 +1,10 @@
 #include "../Public/Logging.h"
 
-Logging::Logger* Logging::Logger::Instance = GetInstance();
+#include "../Public/Context.h"
 
-Logging::Logger* Logging::Logger::GetInstance()
+Logging::Logger* Logging::GetLogger()
 {
-    if (Instance == nullptr)
-    {
-        Instance = new Logger();
-    }
-    return Instance;
+    return &Runtime::GetContext().Logger;
 }
 
 int Logging::Logger::GetCount(const LogLevel Level)
@@ -0,0 +1,340 @@
+#include "../Public/Optimizer.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+
+#include "../Public/Ast.h"
+
+using namespace Optimizer;
+
+// Rewrites an expression node, returning the node itself or its replacement
+using TRewriter = std::function<AstNode*(AstNode*)>;
+
+// What a loop does to the variables it could read
+struct TLoopInfo
+{
+    std::set<std::string> Written;
+    bool bOpaque = false; // Calls something which could change any variable
+};
+
+static bool IsLeaf(AstNode* Node)
+{
+    return Cast<AstValue>(Node) || Cast<AstIdentifier>(Node);
+}
+
+static bool IsPureBuiltIn(const std::string& Name)
+{
+    const TFunctionMap& BuiltIns = Runtime::GetContext().BuiltIns;
+    const auto It = BuiltIns.find(Name);
+    return It != BuiltIns.end() && It->second.GetPurity() == EPurity::Pure;
+}
+
+static void Scan(AstNode* Node, TLoopInfo& Info)
+{
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Scan(Expression, Info);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        Info.Written.insert(Assignment->Name);
+        Scan(Assignment->Right, Info);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        Scan(If->Cond, Info);
+        Scan(If->TrueBody, Info);
+        Scan(If->FalseBody, Info);
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        Scan(While->Cond, Info);
+        Scan(While->Body, Info);
+    }
+    else if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        Scan(BinOp->Left, Info);
+        Scan(BinOp->Right, Info);
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        Scan(Unary->Right, Info);
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        Scan(Return->Expr, Info);
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        // User functions bind their parameters to the arguments and may assign any variable
+        const TFunctionMap& BuiltIns = Runtime::GetContext().BuiltIns;
+        const auto BuiltIn = BuiltIns.find(Call->Identifier);
+        const bool bUser = BuiltIn == BuiltIns.end();
+        if (Call->Type == Function && (bUser || BuiltIn->second.GetPurity() == EPurity::Mutating))
+        {
+            Info.bOpaque = true;
+        }
+        for (AstNode* Arg : Call->Args)
+        {
+            Scan(Arg, Info);
+        }
+    }
+    // Declaring a function runs none of its body
+}
+
+// Whether evaluating an expression calls nothing but pure built-ins, so evaluating it again changes nothing
+static bool IsPure(AstNode* Node)
+{
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        return IsPure(BinOp->Left) && IsPure(BinOp->Right);
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return IsPure(Unary->Right);
+    }
+    if (const auto Call = Cast<AstCall>(Node))
+    {
+        return (Call->Type == IndexOf || IsPureBuiltIn(Call->Identifier)) && std::ranges::all_of(Call->Args, IsPure);
+    }
+    return IsLeaf(Node);
+}
+
+// Whether an expression is pure and has the same value on every iteration of the loop
+static bool IsInvariant(AstNode* Node, const TLoopInfo& Info)
+{
+    if (Cast<AstValue>(Node))
+    {
+        return true;
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        return !Info.Written.contains(Identifier->Name);
+    }
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        return BinOp->BinaryOp != EBinaryOp::Count && IsInvariant(BinOp->Left, Info)
+            && IsInvariant(BinOp->Right, Info);
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        return (Unary->Op == Not || Unary->Op == Minus) && IsInvariant(Unary->Right, Info);
+    }
+    if (const auto Call = Cast<AstCall>(Node))
+    {
+        const bool bPure = Call->Type == IndexOf ? !Info.Written.contains(Call->Identifier)
+                                                 : IsPureBuiltIn(Call->Identifier);
+        return bPure && std::ranges::all_of(Call->Args, [&Info](AstNode* Arg) { return IsInvariant(Arg, Info); });
+    }
+    return false;
+}
+
+static bool IsSameExpression(AstNode* A, AstNode* B)
+{
+    if (const auto Value = Cast<AstValue>(A))
+    {
+        const auto Other = Cast<AstValue>(B);
+        return Other && Value->Value.GetType() == Other->Value.GetType() && Value->Value == Other->Value;
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(A))
+    {
+        const auto Other = Cast<AstIdentifier>(B);
+        return Other && Identifier->Name == Other->Name;
+    }
+    if (const auto BinOp = Cast<AstBinOp>(A))
+    {
+        const auto Other = Cast<AstBinOp>(B);
+        return Other && BinOp->BinaryOp == Other->BinaryOp && IsSameExpression(BinOp->Left, Other->Left)
+            && IsSameExpression(BinOp->Right, Other->Right);
+    }
+    if (const auto Unary = Cast<AstUnaryExpr>(A))
+    {
+        const auto Other = Cast<AstUnaryExpr>(B);
+        return Other && Unary->Op == Other->Op && IsSameExpression(Unary->Right, Other->Right);
+    }
+    if (const auto Call = Cast<AstCall>(A))
+    {
+        const auto Other = Cast<AstCall>(B);
+        return Other && Call->Identifier == Other->Identifier && Call->Type == Other->Type
+            && std::ranges::equal(Call->Args, Other->Args, IsSameExpression);
+    }
+    return false;
+}
+
+static AstNode* RewriteExpression(AstNode* Node, const TRewriter& Rewriter);
+
+// Rewrites the operands of an expression, copying the node if any of them changed
+static AstNode* RewriteOperands(AstNode* Node, const TRewriter& Rewriter)
+{
+    if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        AstNode* Left = RewriteExpression(BinOp->Left, Rewriter);
+        AstNode* Right = RewriteExpression(BinOp->Right, Rewriter);
+        if (Left != BinOp->Left || Right != BinOp->Right)
+        {
+            return new AstBinOp(Left, Right, BinOp->Op, BinOp->GetContext());
+        }
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        if (AstNode* Right = RewriteExpression(Unary->Right, Rewriter); Right != Unary->Right)
+        {
+            return new AstUnaryExpr(Unary->Op, Right, Unary->Context);
+        }
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        std::vector<AstNode*> Args;
+        for (AstNode* Arg : Call->Args)
+        {
+            Args.push_back(RewriteExpression(Arg, Rewriter));
+        }
+        if (Args != Call->Args)
+        {
+            return new AstCall(Call->Identifier, Call->Type, Args, Call->Context);
+        }
+    }
+    return Node;
+}
+
+// Rewrites an expression top-down. Nodes above a replacement are copied rather than changed, since the original
+// loop condition is still evaluated once in front of the loop.
+static AstNode* RewriteExpression(AstNode* Node, const TRewriter& Rewriter)
+{
+    if (AstNode* Replacement = Rewriter(Node); Replacement != Node)
+    {
+        return Replacement;
+    }
+    return RewriteOperands(Node, Rewriter);
+}
+
+// Rewrites the expressions of a statement evaluated every time the statement runs, leaving out the bodies of
+// conditionals and loops
+static void RewriteStatement(AstNode*& Statement, const TRewriter& Rewriter)
+{
+    if (const auto Body = Cast<AstBody>(Statement))
+    {
+        for (AstNode*& Expression : Body->Expressions)
+        {
+            RewriteStatement(Expression, Rewriter);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Statement))
+    {
+        Assignment->Right = RewriteExpression(Assignment->Right, Rewriter);
+    }
+    else if (const auto Return = Cast<AstReturn>(Statement))
+    {
+        Return->Expr = RewriteExpression(Return->Expr, Rewriter);
+    }
+    else if (const auto If = Cast<AstIf>(Statement))
+    {
+        If->Cond = RewriteExpression(If->Cond, Rewriter);
+    }
+    else if (const auto While = Cast<AstWhile>(Statement))
+    {
+        While->Cond = RewriteExpression(While->Cond, Rewriter);
+    }
+    else if (!Cast<AstFunction>(Statement))
+    {
+        // An expression statement whose operands do not fit leaves nothing on the stack rather than failing, as an
+        // assignment would, so the statement itself stays where it is
+        Statement = RewriteOperands(Statement, Rewriter);
+    }
+}
+
+std::string TLoopOptimizer::NewVariable(const std::string& Kind)
+{
+    // The lexer never produces a '$', so these cannot clash with the program's own variables
+    return std::format("${}{}", Kind, NextVariable++);
+}
+
+// Optimizes the loops in a statement, innermost first, returning the statement or its replacement
+AstNode* TLoopOptimizer::Rewrite(AstNode* Node)
+{
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode*& Statement : Body->Expressions)
+        {
+            Statement = Rewrite(Statement);
+        }
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        If->TrueBody = Rewrite(If->TrueBody);
+        if (If->FalseBody)
+        {
+            If->FalseBody = Rewrite(If->FalseBody);
+        }
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        While->Body = Rewrite(While->Body);
+        return RewriteLoop(While);
+    }
+    else if (const auto Declaration = Cast<AstFunction>(Node))
+    {
+        Declaration->Body = Rewrite(Declaration->Body);
+    }
+    return Node;
+}
+
+AstNode* TLoopOptimizer::RewriteLoop(AstWhile* Loop)
+{
+    TLoopInfo Info;
+    Scan(Loop->Cond, Info);
+    Scan(Loop->Body, Info);
+    // The condition is evaluated again in front of the loop to guard what is hoisted, so it must be pure
+    if (Info.bOpaque || !IsPure(Loop->Cond))
+    {
+        return Loop;
+    }
+    const Token& Context = Loop->Context;
+    AstNode* const Cond = Loop->Cond;
+
+    // Hoist the largest invariant expressions evaluated on every iteration, sharing a variable between copies of the
+    // same expression
+    std::vector<std::pair<AstNode*, std::string>> Hoisted;
+    const TRewriter Hoist = [&](AstNode* Node) -> AstNode*
+    {
+        if (IsLeaf(Node) || !IsInvariant(Node, Info))
+        {
+            return Node;
+        }
+        auto It = std::ranges::find_if(Hoisted, [Node](const auto& Entry)
+        {
+            return IsSameExpression(Entry.first, Node);
+        });
+        if (It == Hoisted.end())
+        {
+            Hoisted.emplace_back(Node, NewVariable("invariant"));
+            It = Hoisted.end() - 1;
+        }
+        return new AstIdentifier(It->second, Node->GetContext());
+    };
+    Loop->Cond = RewriteExpression(Loop->Cond, Hoist);
+    RewriteStatement(Loop->Body, Hoist);
+    if (Hoisted.empty())
+    {
+        return Loop;
+    }
+
+    std::vector<AstNode*> Preheader;
+    for (const auto& [Expression, Name] : Hoisted)
+    {
+        Preheader.push_back(new AstAssignment(Name, Expression, Context));
+    }
+    Stats.Hoisted += static_cast<int>(Hoisted.size());
+    Preheader.push_back(Loop);
+    // Nothing hoisted is computed unless the loop runs at least once
+    return new AstIf(Cond, new AstBody(Preheader, Context), nullptr, Context);
+}
+
+void TLoopOptimizer::Optimize(AstBody* Program)
+{
+    Rewrite(Program);
+}
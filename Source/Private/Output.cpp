@@ -0,0 +1,99 @@
+#include "../Public/Output.h"
+
+#include <atomic>
+#include <cstdio>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+using namespace Io;
+
+TOutput::TOutput(EFlushPolicy InPolicy)
+    : Policy(InPolicy)
+{
+    Buffer.reserve(BLOCK_SIZE);
+}
+
+TOutput::~TOutput()
+{
+    Flush();
+}
+
+void TOutput::Drain()
+{
+    if (Buffer.empty())
+    {
+        return;
+    }
+    std::fwrite(Buffer.data(), 1, Buffer.size(), stdout);
+    std::fflush(stdout);
+    Buffer.clear();
+}
+
+void TOutput::WriteLine(std::string_view Line)
+{
+    Buffer.append(Line);
+    Buffer += '\n';
+    if (IsDue())
+    {
+        Drain();
+    }
+}
+
+void TOutput::Write(std::string_view Lines)
+{
+    Buffer.append(Lines);
+    if (IsDue())
+    {
+        Drain();
+    }
+}
+
+void TOutput::Flush()
+{
+    if (!bHeld)
+    {
+        Drain();
+    }
+}
+
+std::string TOutput::Take()
+{
+    std::string Taken;
+    Taken.swap(Buffer);
+    return Taken;
+}
+
+void TOutput::SetPolicy(EFlushPolicy InPolicy)
+{
+    Policy = InPolicy;
+    if (Policy == EFlushPolicy::Line)
+    {
+        Drain();
+    }
+}
+
+// Read by every context created, on any thread
+static std::atomic<EFlushPolicy>& DefaultFlushPolicy()
+{
+#if defined(_WIN32)
+    static const bool bTerminal = _isatty(_fileno(stdout)) != 0;
+#else
+    static const bool bTerminal = isatty(fileno(stdout)) != 0;
+#endif
+    static std::atomic Policy(bTerminal ? EFlushPolicy::Line : EFlushPolicy::Block);
+    return Policy;
+}
+
+EFlushPolicy Io::GetDefaultFlushPolicy()
+{
+    return DefaultFlushPolicy().load(std::memory_order_relaxed);
+}
+
+void Io::SetDefaultFlushPolicy(EFlushPolicy InPolicy)
+{
+    DefaultFlushPolicy().store(InPolicy, std::memory_order_relaxed);
+}
@@ -0,0 +1,220 @@
+#include "../Public/Resolver.h"
+
+#include <algorithm>
+
+#include "../Public/Ast.h"
+
+using namespace Resolver;
+
+void TResolver::Report(const AstNode* Node, const std::string& Message)
+{
+    const Token Context = Node->GetContext();
+    Logging::Error("Line {}, column {}: {}", Context.Line, Context.Column, Message);
+    Errors++;
+}
+
+// Finds every name some code can bind, and every function the program declares
+void TResolver::Declare(AstNode* Node)
+{
+    if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Declare(Expression);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        Defined.insert(Assignment->Name);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        Declare(If->TrueBody);
+        Declare(If->FalseBody);
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        Declare(While->Body);
+    }
+    else if (const auto Function = Cast<AstFunction>(Node))
+    {
+        Declarations.emplace(Function->Name, Function);
+        Defined.insert(Function->Args.begin(), Function->Args.end());
+        Declare(Function->Body);
+    }
+}
+
+// Binds the names under a node and reports those which cannot be resolved. Function bodies of a REPL line may use
+// names later lines define.
+void TResolver::Resolve(AstNode* Node, bool bInFunction)
+{
+    if (!Node)
+    {
+        return;
+    }
+    if (const auto Identifier = Cast<AstIdentifier>(Node))
+    {
+        Identifier->Binding = CurrentFrame->Bind(Identifier->Name);
+        if (!Defined.contains(Identifier->Name) && (bWholeProgram || !bInFunction))
+        {
+            Report(Identifier, std::format("'{}' is undefined.", Identifier->Name));
+        }
+    }
+    else if (const auto Body = Cast<AstBody>(Node))
+    {
+        for (AstNode* Expression : Body->Expressions)
+        {
+            Resolve(Expression, bInFunction);
+        }
+    }
+    else if (const auto Assignment = Cast<AstAssignment>(Node))
+    {
+        Assignment->Binding = CurrentFrame->Bind(Assignment->Name);
+        Resolve(Assignment->Right, bInFunction);
+    }
+    else if (const auto If = Cast<AstIf>(Node))
+    {
+        Resolve(If->Cond, bInFunction);
+        Resolve(If->TrueBody, bInFunction);
+        Resolve(If->FalseBody, bInFunction);
+    }
+    else if (const auto While = Cast<AstWhile>(Node))
+    {
+        Resolve(While->Cond, bInFunction);
+        Resolve(While->Body, bInFunction);
+    }
+    else if (const auto BinOp = Cast<AstBinOp>(Node))
+    {
+        Resolve(BinOp->Left, bInFunction);
+        Resolve(BinOp->Right, bInFunction);
+    }
+    else if (const auto Unary = Cast<AstUnaryExpr>(Node))
+    {
+        Resolve(Unary->Right, bInFunction);
+    }
+    else if (const auto Return = Cast<AstReturn>(Node))
+    {
+        Resolve(Return->Expr, bInFunction);
+    }
+    else if (const auto Call = Cast<AstCall>(Node))
+    {
+        ResolveCall(Call, bInFunction);
+    }
+    else if (const auto Function = Cast<AstFunction>(Node))
+    {
+        for (size_t Index = 0; Index < Function->Args.size(); Index++)
+        {
+            Function->ArgBindings[Index] = CurrentFrame->Bind(Function->Args[Index]);
+        }
+        Resolve(Function->Body, true);
+    }
+}
+
+void TResolver::ResolveCall(AstCall* Call, bool bInFunction)
+{
+    for (AstNode* Arg : Call->Args)
+    {
+        Resolve(Arg, bInFunction);
+    }
+
+    if (Call->Type == IndexOf)
+    {
+        Call->Binding = CurrentFrame->Bind(Call->Identifier);
+        if (!Defined.contains(Call->Identifier) && (bWholeProgram || !bInFunction))
+        {
+            Report(Call, std::format("'{}' is undefined.", Call->Identifier));
+        }
+        return;
+    }
+
+    // Built-ins calling one of the program's functions name it by their first argument, and it is checked as a call
+    // of it would be: with the rest of the arguments for spawn, or with elements of an array for the parallel ones
+    static const std::map<std::string, int> FunctionArgumentCounts = {
+        {"spawn", -1}, {"par_map", 1}, {"par_filter", 1}, {"par_reduce", 2}};
+    if (const auto It = FunctionArgumentCounts.find(Call->Identifier);
+        It != FunctionArgumentCounts.end() && !Call->Args.empty())
+    {
+        const auto Target = Cast<AstValue>(Call->Args[0]);
+        if (Target && Target->Value.GetType() == StringType)
+        {
+            const size_t ArgCount = It->second < 0 ? Call->Args.size() - 1 : It->second;
+            ResolveFunction(Call, Target->Value.RawString(), ArgCount, bInFunction);
+        }
+    }
+
+    const TFunctionMap& BuiltIns = Runtime::GetContext().BuiltIns;
+    if (const auto It = BuiltIns.find(Call->Identifier); It != BuiltIns.end())
+    {
+        const TFunction& BuiltIn = It->second;
+        if (!BuiltIn.AcceptsArgumentCount(Call->Args.size()))
+        {
+            Report(Call, std::format("Argument count mismatch for '{}'. Got {}, wanted {}{}.", Call->Identifier,
+                                     Call->Args.size(), BuiltIn.IsVariadic() ? "at least " : "", BuiltIn.GetArity()));
+            return;
+        }
+        Call->BuiltIn = &BuiltIn;
+        return;
+    }
+
+    Call->Function = ResolveFunction(Call, Call->Identifier, Call->Args.size(), bInFunction);
+}
+
+AstFunction* TResolver::ResolveFunction(const AstNode* Node, const std::string& Name, size_t ArgCount,
+                                        bool bInFunction)
+{
+    // A function an earlier program defined is the one every call runs, since functions cannot be redefined
+    if (const auto It = Functions.find(Name); It != Functions.end())
+    {
+        if (It->second->Args.size() != ArgCount)
+        {
+            Report(Node, std::format("Argument count mismatch for '{}'. Got {}, wanted {}.", Name, ArgCount,
+                                     It->second->Args.size()));
+            return nullptr;
+        }
+        return It->second;
+    }
+
+    // Otherwise whichever declaration runs first defines it
+    const auto [First, Last] = Declarations.equal_range(Name);
+    if (First == Last)
+    {
+        if (bWholeProgram || !bInFunction)
+        {
+            Report(Node, std::format("Function '{}' is undeclared.", Name));
+        }
+        return nullptr;
+    }
+    if (std::none_of(First, Last, [ArgCount](const auto& Declaration)
+    {
+        return Declaration.second->Args.size() == ArgCount;
+    }))
+    {
+        Report(Node, std::format("Argument count mismatch for '{}'. Got {}, wanted {}.", Name, ArgCount,
+                                 First->second->Args.size()));
+    }
+    return nullptr;
+}
+
+bool TResolver::Run(AstBody* Program)
+{
+    Defined.clear();
+    Declarations.clear();
+    Errors = 0;
+
+    // Variables keep their values between the programs of a session
+    for (const auto& [Name, Value] : CurrentFrame->Identifiers)
+    {
+        if (Value)
+        {
+            Defined.insert(Name);
+        }
+    }
+    for (const auto& [Name, Function] : Functions)
+    {
+        Declare(Function);
+    }
+    Declare(Program);
+
+    Resolve(Program, false);
+    return Errors == 0;
+}
@@ -0,0 +1,489 @@
+#include <algorithm>
+#include <type_traits>
+
+#include "../Public/Simd.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #define SIMD_X86 0
+#endif
+
+// MSVC allows any intrinsic in any function; GCC and Clang need the target enabled per function so the rest of the
+// program can still run on CPUs without it.
+#if SIMD_X86 && !defined(_MSC_VER)
+    #define SIMD_TARGET_SSE __attribute__((target("sse4.1")))
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define SIMD_TARGET_SSE
+    #define SIMD_TARGET_AVX2
+#endif
+
+using namespace Simd;
+
+////////////
+// Scalar //
+////////////
+
+// Int lanes of the vector kernels wrap on overflow, while signed overflow is undefined in C++, so scalar int arithmetic
+// is done in unsigned and cast back. Every instruction set then gives the same results.
+template <typename T>
+using TWrapping = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::type_identity<T>>::type;
+
+template <typename T>
+static T ScalarAdd(T A, T B)
+{
+    return static_cast<T>(static_cast<TWrapping<T>>(A) + static_cast<TWrapping<T>>(B));
+}
+
+template <typename T>
+static T ScalarSub(T A, T B)
+{
+    return static_cast<T>(static_cast<TWrapping<T>>(A) - static_cast<TWrapping<T>>(B));
+}
+
+template <typename T>
+static T ScalarMul(T A, T B)
+{
+    return static_cast<T>(static_cast<TWrapping<T>>(A) * static_cast<TWrapping<T>>(B));
+}
+
+#define SCALAR_Add(A, B) ScalarAdd(A, B)
+#define SCALAR_Sub(A, B) ScalarSub(A, B)
+#define SCALAR_Mul(A, B) ScalarMul(A, B)
+#define SCALAR_Div(A, B) ((A) / (B))
+
+#define DEFINE_SCALAR_KERNELS(T, Ty)                                                          \
+    template <EArrayOp Op>                                                                    \
+    static T ScalarApply_##Ty(T A, T B)                                                       \
+    {                                                                                         \
+        switch (Op)                                                                           \
+        {                                                                                     \
+        case Add :                                                                            \
+            return SCALAR_Add(A, B);                                                          \
+        case Sub :                                                                            \
+            return SCALAR_Sub(A, B);                                                          \
+        case Mul :                                                                            \
+            return SCALAR_Mul(A, B);                                                          \
+        default :                                                                             \
+            return SCALAR_Div(A, B);                                                          \
+        }                                                                                     \
+    }                                                                                         \
+    template <EArrayOp Op>                                                                    \
+    static void Binary_SCALAR_##Ty(const T* A, const T* B, T* Out, size_t Count)              \
+    {                                                                                         \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Out[I] = ScalarApply_##Ty<Op>(A[I], B[I]);                                        \
+        }                                                                                     \
+    }                                                                                         \
+    template <EArrayOp Op>                                                                    \
+    static void Broadcast_SCALAR_##Ty(const T* A, T Scalar, T* Out, size_t Count)             \
+    {                                                                                         \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Out[I] = ScalarApply_##Ty<Op>(A[I], Scalar);                                      \
+        }                                                                                     \
+    }                                                                                         \
+    template <EArrayOp Op>                                                                    \
+    static void BroadcastReversed_SCALAR_##Ty(const T* A, T Scalar, T* Out, size_t Count)     \
+    {                                                                                         \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Out[I] = ScalarApply_##Ty<Op>(Scalar, A[I]);                                      \
+        }                                                                                     \
+    }                                                                                         \
+    static T Sum_SCALAR_##Ty(const T* A, size_t Count)                                        \
+    {                                                                                         \
+        T Result = 0;                                                                         \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Result = SCALAR_Add(Result, A[I]);                                                \
+        }                                                                                     \
+        return Result;                                                                        \
+    }                                                                                         \
+    static T Min_SCALAR_##Ty(const T* A, size_t Count)                                        \
+    {                                                                                         \
+        T Result = A[0];                                                                      \
+        for (size_t I = 1; I < Count; I++)                                                    \
+        {                                                                                     \
+            Result = std::min(Result, A[I]);                                                  \
+        }                                                                                     \
+        return Result;                                                                        \
+    }                                                                                         \
+    static T Max_SCALAR_##Ty(const T* A, size_t Count)                                        \
+    {                                                                                         \
+        T Result = A[0];                                                                      \
+        for (size_t I = 1; I < Count; I++)                                                    \
+        {                                                                                     \
+            Result = std::max(Result, A[I]);                                                  \
+        }                                                                                     \
+        return Result;                                                                        \
+    }                                                                                         \
+    static T Dot_SCALAR_##Ty(const T* A, const T* B, size_t Count)                            \
+    {                                                                                         \
+        T Result = 0;                                                                         \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Result = SCALAR_Add(Result, SCALAR_Mul(A[I], B[I]));                              \
+        }                                                                                     \
+        return Result;                                                                        \
+    }                                                                                         \
+    static void PrefixSum_SCALAR_##Ty(const T* A, T* Out, size_t Count)                       \
+    {                                                                                         \
+        T Running = 0;                                                                        \
+        for (size_t I = 0; I < Count; I++)                                                    \
+        {                                                                                     \
+            Running = SCALAR_Add(Running, A[I]);                                              \
+            Out[I] = Running;                                                                 \
+        }                                                                                     \
+    }
+
+DEFINE_SCALAR_KERNELS(float, F)
+DEFINE_SCALAR_KERNELS(int, I)
+
+#define SCALAR_KERNEL_SET(Ty)                                                                                        \
+    {                                                                                                                \
+        {Binary_SCALAR_##Ty<Add>, Binary_SCALAR_##Ty<Sub>, Binary_SCALAR_##Ty<Mul>, Binary_SCALAR_##Ty<Div>},        \
+        {Broadcast_SCALAR_##Ty<Add>, Broadcast_SCALAR_##Ty<Sub>, Broadcast_SCALAR_##Ty<Mul>,                         \
+         Broadcast_SCALAR_##Ty<Div>},                                                                                \
+        {BroadcastReversed_SCALAR_##Ty<Add>, BroadcastReversed_SCALAR_##Ty<Sub>, BroadcastReversed_SCALAR_##Ty<Mul>, \
+         BroadcastReversed_SCALAR_##Ty<Div>},                                                                        \
+        Sum_SCALAR_##Ty, Min_SCALAR_##Ty, Max_SCALAR_##Ty, Dot_SCALAR_##Ty, PrefixSum_SCALAR_##Ty                    \
+    }
+
+static const TKernels SCALAR_KERNELS{EInstructionSet::Scalar, SCALAR_KERNEL_SET(F), SCALAR_KERNEL_SET(I)};
+
+#if SIMD_X86
+
+//////////////////
+// SSE and AVX2 //
+//////////////////
+
+// Each instruction set describes its vector type, width and operations for floats (F) and 32-bit ints (I). The kernel
+// macros below are expanded once per instruction set so each copy is compiled with its own target.
+
+#define SSE_WIDTH 4
+#define SSE_F_VEC __m128
+#define SSE_F_LOAD(P) _mm_loadu_ps(P)
+#define SSE_F_STORE(P, V) _mm_storeu_ps(P, V)
+#define SSE_F_SET1(S) _mm_set1_ps(S)
+#define SSE_F_ZERO() _mm_setzero_ps()
+#define SSE_F_Add(A, B) _mm_add_ps(A, B)
+#define SSE_F_Sub(A, B) _mm_sub_ps(A, B)
+#define SSE_F_Mul(A, B) _mm_mul_ps(A, B)
+#define SSE_F_Div(A, B) _mm_div_ps(A, B)
+#define SSE_F_MIN(A, B) _mm_min_ps(A, B)
+#define SSE_F_MAX(A, B) _mm_max_ps(A, B)
+
+#define SSE_I_VEC __m128i
+#define SSE_I_LOAD(P) _mm_loadu_si128(reinterpret_cast<const __m128i*>(P))
+#define SSE_I_STORE(P, V) _mm_storeu_si128(reinterpret_cast<__m128i*>(P), V)
+#define SSE_I_SET1(S) _mm_set1_epi32(S)
+#define SSE_I_ZERO() _mm_setzero_si128()
+#define SSE_I_Add(A, B) _mm_add_epi32(A, B)
+#define SSE_I_Sub(A, B) _mm_sub_epi32(A, B)
+#define SSE_I_Mul(A, B) _mm_mullo_epi32(A, B)
+#define SSE_I_MIN(A, B) _mm_min_epi32(A, B)
+#define SSE_I_MAX(A, B) _mm_max_epi32(A, B)
+
+#define AVX2_WIDTH 8
+#define AVX2_F_VEC __m256
+#define AVX2_F_LOAD(P) _mm256_loadu_ps(P)
+#define AVX2_F_STORE(P, V) _mm256_storeu_ps(P, V)
+#define AVX2_F_SET1(S) _mm256_set1_ps(S)
+#define AVX2_F_ZERO() _mm256_setzero_ps()
+#define AVX2_F_Add(A, B) _mm256_add_ps(A, B)
+#define AVX2_F_Sub(A, B) _mm256_sub_ps(A, B)
+#define AVX2_F_Mul(A, B) _mm256_mul_ps(A, B)
+#define AVX2_F_Div(A, B) _mm256_div_ps(A, B)
+#define AVX2_F_MIN(A, B) _mm256_min_ps(A, B)
+#define AVX2_F_MAX(A, B) _mm256_max_ps(A, B)
+
+#define AVX2_I_VEC __m256i
+#define AVX2_I_LOAD(P) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(P))
+#define AVX2_I_STORE(P, V) _mm256_storeu_si256(reinterpret_cast<__m256i*>(P), V)
+#define AVX2_I_SET1(S) _mm256_set1_epi32(S)
+#define AVX2_I_ZERO() _mm256_setzero_si256()
+#define AVX2_I_Add(A, B) _mm256_add_epi32(A, B)
+#define AVX2_I_Sub(A, B) _mm256_sub_epi32(A, B)
+#define AVX2_I_Mul(A, B) _mm256_mullo_epi32(A, B)
+#define AVX2_I_MIN(A, B) _mm256_min_epi32(A, B)
+#define AVX2_I_MAX(A, B) _mm256_max_epi32(A, B)
+
+#define DEFINE_VECTOR_BINARY_KERNELS(Isa, T, Ty, Op)                                                              \
+    SIMD_TARGET_##Isa static void Binary##Op##_##Isa##_##Ty(const T* A, const T* B, T* Out, size_t Count)         \
+    {                                                                                                             \
+        size_t I = 0;                                                                                             \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Isa##_##Ty##_STORE(Out + I, Isa##_##Ty##_##Op(Isa##_##Ty##_LOAD(A + I), Isa##_##Ty##_LOAD(B + I)));  \
+        }                                                                                                         \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Out[I] = SCALAR_##Op(A[I], B[I]);                                                                     \
+        }                                                                                                         \
+    }                                                                                                             \
+    SIMD_TARGET_##Isa static void Broadcast##Op##_##Isa##_##Ty(const T* A, T Scalar, T* Out, size_t Count)        \
+    {                                                                                                             \
+        const Isa##_##Ty##_VEC S = Isa##_##Ty##_SET1(Scalar);                                                     \
+        size_t I = 0;                                                                                             \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Isa##_##Ty##_STORE(Out + I, Isa##_##Ty##_##Op(Isa##_##Ty##_LOAD(A + I), S));                          \
+        }                                                                                                         \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Out[I] = SCALAR_##Op(A[I], Scalar);                                                                   \
+        }                                                                                                         \
+    }                                                                                                             \
+    SIMD_TARGET_##Isa static void BroadcastReversed##Op##_##Isa##_##Ty(const T* A, T Scalar, T* Out, size_t Count) \
+    {                                                                                                             \
+        const Isa##_##Ty##_VEC S = Isa##_##Ty##_SET1(Scalar);                                                     \
+        size_t I = 0;                                                                                             \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Isa##_##Ty##_STORE(Out + I, Isa##_##Ty##_##Op(S, Isa##_##Ty##_LOAD(A + I)));                          \
+        }                                                                                                         \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Out[I] = SCALAR_##Op(Scalar, A[I]);                                                                   \
+        }                                                                                                         \
+    }
+
+#define DEFINE_VECTOR_REDUCE_KERNELS(Isa, T, Ty)                                                                  \
+    SIMD_TARGET_##Isa static T Sum_##Isa##_##Ty(const T* A, size_t Count)                                         \
+    {                                                                                                             \
+        Isa##_##Ty##_VEC Acc = Isa##_##Ty##_ZERO();                                                               \
+        size_t I = 0;                                                                                             \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Acc = Isa##_##Ty##_Add(Acc, Isa##_##Ty##_LOAD(A + I));                                                \
+        }                                                                                                         \
+        T Lanes[Isa##_WIDTH];                                                                                     \
+        Isa##_##Ty##_STORE(Lanes, Acc);                                                                           \
+        T Result = 0;                                                                                             \
+        for (const T Lane : Lanes)                                                                                \
+        {                                                                                                         \
+            Result = SCALAR_Add(Result, Lane);                                                                    \
+        }                                                                                                         \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Result = SCALAR_Add(Result, A[I]);                                                                    \
+        }                                                                                                         \
+        return Result;                                                                                            \
+    }                                                                                                             \
+    SIMD_TARGET_##Isa static T Min_##Isa##_##Ty(const T* A, size_t Count)                                         \
+    {                                                                                                             \
+        if (Count < Isa##_WIDTH)                                                                                  \
+        {                                                                                                         \
+            return Min_SCALAR_##Ty(A, Count);                                                                     \
+        }                                                                                                         \
+        Isa##_##Ty##_VEC Acc = Isa##_##Ty##_LOAD(A);                                                              \
+        size_t I = Isa##_WIDTH;                                                                                   \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Acc = Isa##_##Ty##_MIN(Acc, Isa##_##Ty##_LOAD(A + I));                                                \
+        }                                                                                                         \
+        T Lanes[Isa##_WIDTH];                                                                                     \
+        Isa##_##Ty##_STORE(Lanes, Acc);                                                                           \
+        T Result = Min_SCALAR_##Ty(Lanes, Isa##_WIDTH);                                                           \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Result = std::min(Result, A[I]);                                                                      \
+        }                                                                                                         \
+        return Result;                                                                                            \
+    }                                                                                                             \
+    SIMD_TARGET_##Isa static T Max_##Isa##_##Ty(const T* A, size_t Count)                                         \
+    {                                                                                                             \
+        if (Count < Isa##_WIDTH)                                                                                  \
+        {                                                                                                         \
+            return Max_SCALAR_##Ty(A, Count);                                                                     \
+        }                                                                                                         \
+        Isa##_##Ty##_VEC Acc = Isa##_##Ty##_LOAD(A);                                                              \
+        size_t I = Isa##_WIDTH;                                                                                   \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Acc = Isa##_##Ty##_MAX(Acc, Isa##_##Ty##_LOAD(A + I));                                                \
+        }                                                                                                         \
+        T Lanes[Isa##_WIDTH];                                                                                     \
+        Isa##_##Ty##_STORE(Lanes, Acc);                                                                           \
+        T Result = Max_SCALAR_##Ty(Lanes, Isa##_WIDTH);                                                           \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Result = std::max(Result, A[I]);                                                                      \
+        }                                                                                                         \
+        return Result;                                                                                            \
+    }                                                                                                             \
+    SIMD_TARGET_##Isa static T Dot_##Isa##_##Ty(const T* A, const T* B, size_t Count)                             \
+    {                                                                                                             \
+        Isa##_##Ty##_VEC Acc = Isa##_##Ty##_ZERO();                                                               \
+        size_t I = 0;                                                                                             \
+        for (; I + Isa##_WIDTH <= Count; I += Isa##_WIDTH)                                                        \
+        {                                                                                                         \
+            Acc = Isa##_##Ty##_Add(Acc, Isa##_##Ty##_Mul(Isa##_##Ty##_LOAD(A + I), Isa##_##Ty##_LOAD(B + I)));    \
+        }                                                                                                         \
+        T Lanes[Isa##_WIDTH];                                                                                     \
+        Isa##_##Ty##_STORE(Lanes, Acc);                                                                           \
+        T Result = 0;                                                                                             \
+        for (const T Lane : Lanes)                                                                                \
+        {                                                                                                         \
+            Result = SCALAR_Add(Result, Lane);                                                                    \
+        }                                                                                                         \
+        for (; I < Count; I++)                                                                                    \
+        {                                                                                                         \
+            Result = SCALAR_Add(Result, SCALAR_Mul(A[I], B[I]));                                                  \
+        }                                                                                                         \
+        return Result;                                                                                            \
+    }
+
+#define DEFINE_VECTOR_KERNELS(Isa, T, Ty)          \
+    DEFINE_VECTOR_BINARY_KERNELS(Isa, T, Ty, Add) \
+    DEFINE_VECTOR_BINARY_KERNELS(Isa, T, Ty, Sub) \
+    DEFINE_VECTOR_BINARY_KERNELS(Isa, T, Ty, Mul) \
+    DEFINE_VECTOR_REDUCE_KERNELS(Isa, T, Ty)
+
+DEFINE_VECTOR_KERNELS(SSE, float, F)
+DEFINE_VECTOR_KERNELS(SSE, int, I)
+DEFINE_VECTOR_KERNELS(AVX2, float, F)
+DEFINE_VECTOR_KERNELS(AVX2, int, I)
+
+DEFINE_VECTOR_BINARY_KERNELS(SSE, float, F, Div)
+DEFINE_VECTOR_BINARY_KERNELS(AVX2, float, F, Div)
+
+// The prefix sum is latency bound on the running total, so AVX2 uses the same in-register scan over 4 lanes.
+SIMD_TARGET_SSE static void PrefixSum_SSE_F(const float* A, float* Out, size_t Count)
+{
+    __m128 Carry = _mm_setzero_ps();
+    size_t I = 0;
+    for (; I + 4 <= Count; I += 4)
+    {
+        __m128 X = _mm_loadu_ps(A + I);
+        X = _mm_add_ps(X, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(X), 4)));
+        X = _mm_add_ps(X, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(X), 8)));
+        X = _mm_add_ps(X, Carry);
+        _mm_storeu_ps(Out + I, X);
+        Carry = _mm_shuffle_ps(X, X, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    float Running = _mm_cvtss_f32(Carry);
+    for (; I < Count; I++)
+    {
+        Running = SCALAR_Add(Running, A[I]);
+        Out[I] = Running;
+    }
+}
+
+SIMD_TARGET_SSE static void PrefixSum_SSE_I(const int* A, int* Out, size_t Count)
+{
+    __m128i Carry = _mm_setzero_si128();
+    size_t I = 0;
+    for (; I + 4 <= Count; I += 4)
+    {
+        __m128i X = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + I));
+        X = _mm_add_epi32(X, _mm_slli_si128(X, 4));
+        X = _mm_add_epi32(X, _mm_slli_si128(X, 8));
+        X = _mm_add_epi32(X, Carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + I), X);
+        Carry = _mm_shuffle_epi32(X, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    int Running = _mm_cvtsi128_si32(Carry);
+    for (; I < Count; I++)
+    {
+        Running = SCALAR_Add(Running, A[I]);
+        Out[I] = Running;
+    }
+}
+
+// Ints have no vector division, so every instruction set uses the scalar kernels for it.
+#define VECTOR_KERNEL_SET_F(Isa)                                                                             \
+    {                                                                                                        \
+        {BinaryAdd_##Isa##_F, BinarySub_##Isa##_F, BinaryMul_##Isa##_F, BinaryDiv_##Isa##_F},                \
+        {BroadcastAdd_##Isa##_F, BroadcastSub_##Isa##_F, BroadcastMul_##Isa##_F, BroadcastDiv_##Isa##_F},    \
+        {BroadcastReversedAdd_##Isa##_F, BroadcastReversedSub_##Isa##_F, BroadcastReversedMul_##Isa##_F,     \
+         BroadcastReversedDiv_##Isa##_F},                                                                    \
+        Sum_##Isa##_F, Min_##Isa##_F, Max_##Isa##_F, Dot_##Isa##_F, PrefixSum_SSE_F                          \
+    }
+#define VECTOR_KERNEL_SET_I(Isa)                                                                             \
+    {                                                                                                        \
+        {BinaryAdd_##Isa##_I, BinarySub_##Isa##_I, BinaryMul_##Isa##_I, Binary_SCALAR_I<Div>},               \
+        {BroadcastAdd_##Isa##_I, BroadcastSub_##Isa##_I, BroadcastMul_##Isa##_I, Broadcast_SCALAR_I<Div>},   \
+        {BroadcastReversedAdd_##Isa##_I, BroadcastReversedSub_##Isa##_I, BroadcastReversedMul_##Isa##_I,     \
+         BroadcastReversed_SCALAR_I<Div>},                                                                   \
+        Sum_##Isa##_I, Min_##Isa##_I, Max_##Isa##_I, Dot_##Isa##_I, PrefixSum_SSE_I                          \
+    }
+
+static const TKernels SSE_KERNELS{EInstructionSet::SSE, VECTOR_KERNEL_SET_F(SSE), VECTOR_KERNEL_SET_I(SSE)};
+static const TKernels AVX2_KERNELS{EInstructionSet::AVX2, VECTOR_KERNEL_SET_F(AVX2), VECTOR_KERNEL_SET_I(AVX2)};
+
+#endif // SIMD_X86
+
+EInstructionSet Simd::DetectInstructionSet()
+{
+#if SIMD_X86
+    #if defined(_MSC_VER)
+    int Info[4];
+    __cpuid(Info, 1);
+    const bool bSse41 = (Info[2] & (1 << 19)) != 0;
+    const bool bOsXSave = (Info[2] & (1 << 27)) != 0;
+    const bool bAvx = (Info[2] & (1 << 28)) != 0;
+    bool bAvx2 = false;
+    if (bOsXSave && bAvx && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(Info, 7, 0);
+        bAvx2 = (Info[1] & (1 << 5)) != 0;
+    }
+    #else
+    __builtin_cpu_init();
+    const bool bSse41 = __builtin_cpu_supports("sse4.1");
+    const bool bAvx2 = __builtin_cpu_supports("avx2");
+    #endif
+    if (bAvx2)
+    {
+        return EInstructionSet::AVX2;
+    }
+    if (bSse41)
+    {
+        return EInstructionSet::SSE;
+    }
+#endif
+    return EInstructionSet::Scalar;
+}
+
+const TKernels& Simd::GetKernels()
+{
+    static const TKernels& Kernels = GetKernels(DetectInstructionSet());
+    return Kernels;
+}
+
+const TKernels& Simd::GetKernels(EInstructionSet InstructionSet)
+{
+#if SIMD_X86
+    switch (InstructionSet)
+    {
+    case EInstructionSet::AVX2 :
+        return AVX2_KERNELS;
+    case EInstructionSet::SSE :
+        return SSE_KERNELS;
+    default :
+        break;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
+
+std::string Simd::ToString(EInstructionSet InstructionSet)
+{
+    switch (InstructionSet)
+    {
+    case EInstructionSet::AVX2 :
+        return "AVX2";
+    case EInstructionSet::SSE :
+        return "SSE4.1";
+    default :
+        return "Scalar";
+    }
+}
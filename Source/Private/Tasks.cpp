@@ -0,0 +1,851 @@
+#include "../Public/Tasks.h"
+
+#include <cstdint>
+#include <map>
+#include <ranges>
+
+#include "../Public/Embed.h"
+
+#if defined(_WIN32)
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <ucontext.h>
+    #include <unistd.h>
+#endif
+
+using namespace Tasks;
+
+// The scheduler whose worker this thread is, and which of its workers
+thread_local const TScheduler* CurrentScheduler = nullptr;
+thread_local int CurrentWorker = -1;
+
+// The task whose fiber this thread is running, if any
+thread_local TTask* CurrentTask = nullptr;
+
+/// <summary>
+/// A stack tasks run on, one after another, so that a task can be suspended and resumed where it was. Each time a
+/// fiber is switched to, it returns to the code which switched to it when its task is suspended or finishes. Only the
+/// worker which created a fiber switches to it, so the thread-locals it reads are always that worker's.
+/// </summary>
+struct Tasks::TFiber
+{
+    TScheduler* Scheduler;
+#if defined(_WIN32)
+    void* Handle = nullptr;
+    void* Caller = nullptr;
+#else
+    void* Stack = nullptr;
+    ucontext_t Context;
+    ucontext_t Caller;
+#endif
+
+    explicit TFiber(TScheduler* InScheduler);
+    ~TFiber();
+    TFiber(const TFiber&) = delete;
+    TFiber& operator=(const TFiber&) = delete;
+
+    bool IsValid() const;
+
+    // Runs the fiber until its task is suspended or finishes
+    void SwitchIn();
+
+    // Returns to the code which switched to the fiber, from its task
+    void SwitchOut();
+
+    // Runs the task the thread switched to, and then each task after it, forever
+    void Main();
+};
+
+#if defined(_WIN32)
+static void WINAPI RunFiber(void* Parameter)
+{
+    static_cast<TFiber*>(Parameter)->Main();
+}
+
+TFiber::TFiber(TScheduler* InScheduler)
+    : Scheduler(InScheduler)
+{
+    Handle = CreateFiberEx(0, FIBER_STACK_SIZE, 0, &RunFiber, this);
+}
+
+TFiber::~TFiber()
+{
+    if (Handle)
+    {
+        DeleteFiber(Handle);
+    }
+}
+
+bool TFiber::IsValid() const
+{
+    return Handle != nullptr;
+}
+
+void TFiber::SwitchIn()
+{
+    if (!IsThreadAFiber())
+    {
+        ConvertThreadToFiber(nullptr);
+    }
+    Caller = GetCurrentFiber();
+    SwitchToFiber(Handle);
+}
+
+void TFiber::SwitchOut()
+{
+    SwitchToFiber(Caller);
+}
+#else
+// makecontext passes only ints, so the fiber's address is split in two
+static void RunFiber(unsigned int High, unsigned int Low)
+{
+    const uintptr_t Address = static_cast<uintptr_t>(High) << 32 | Low;
+    reinterpret_cast<TFiber*>(Address)->Main();
+}
+
+TFiber::TFiber(TScheduler* InScheduler)
+    : Scheduler(InScheduler)
+{
+    // The lowest page is left inaccessible, so a task overflowing its stack faults instead of writing past it
+    const long PageSize = sysconf(_SC_PAGESIZE);
+    void* Mapped = mmap(nullptr, FIBER_STACK_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (Mapped == MAP_FAILED || mprotect(Mapped, PageSize, PROT_NONE) != 0 || getcontext(&Context) != 0)
+    {
+        if (Mapped != MAP_FAILED)
+        {
+            munmap(Mapped, FIBER_STACK_SIZE);
+        }
+        return;
+    }
+    Stack = Mapped;
+    Context.uc_stack.ss_sp = Stack;
+    Context.uc_stack.ss_size = FIBER_STACK_SIZE;
+    Context.uc_link = nullptr;
+    const auto Address = reinterpret_cast<uintptr_t>(this);
+    makecontext(&Context, reinterpret_cast<void (*)()>(&RunFiber), 2, static_cast<unsigned int>(Address >> 32),
+                static_cast<unsigned int>(Address));
+}
+
+TFiber::~TFiber()
+{
+    if (Stack)
+    {
+        munmap(Stack, FIBER_STACK_SIZE);
+    }
+}
+
+bool TFiber::IsValid() const
+{
+    return Stack != nullptr;
+}
+
+void TFiber::SwitchIn()
+{
+    swapcontext(&Caller, &Context);
+}
+
+void TFiber::SwitchOut()
+{
+    swapcontext(&Context, &Caller);
+}
+#endif
+
+void TFiber::Main()
+{
+    while (true)
+    {
+        TTask* Task = CurrentTask;
+        Scheduler->Execute(Task);
+        Task->bExited = true;
+        SwitchOut();
+    }
+}
+
+void TWorkQueue::Push(TTask* Task)
+{
+    std::lock_guard Lock(Mutex);
+    Tasks.push_back(Task);
+}
+
+TTask* TWorkQueue::Pop()
+{
+    std::lock_guard Lock(Mutex);
+    if (Tasks.empty())
+    {
+        return nullptr;
+    }
+    TTask* Task = Tasks.back();
+    Tasks.pop_back();
+    return Task;
+}
+
+TTask* TWorkQueue::Steal()
+{
+    std::lock_guard Lock(Mutex);
+    if (Tasks.empty())
+    {
+        return nullptr;
+    }
+    TTask* Task = Tasks.front();
+    Tasks.pop_front();
+    return Task;
+}
+
+void TWorkQueue::PushWoken(TTask* Task)
+{
+    std::lock_guard Lock(Mutex);
+    Woken.push_back(Task);
+}
+
+TTask* TWorkQueue::PopWoken()
+{
+    std::lock_guard Lock(Mutex);
+    if (Woken.empty())
+    {
+        return nullptr;
+    }
+    TTask* Task = Woken.front();
+    Woken.pop_front();
+    return Task;
+}
+
+void TWaitList::Wait(const std::function<bool()>& Ready)
+{
+    while (!Ready())
+    {
+        std::unique_lock Lock(Mutex);
+
+        // A notifier changes what Ready reads before checking the count, and this counts itself before checking
+        // Ready, so one of the two sees the other
+        WaitingCount.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (Ready())
+        {
+            WaitingCount.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        TTask* Task = CurrentTask;
+        if (!Task)
+        {
+            Signal.wait(Lock, Ready);
+            WaitingCount.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Only this thread resumes the task, so it cannot be resumed before it is suspended even if it is woken first
+        Suspended.push_back(Task);
+        Lock.unlock();
+        Task->Fiber->Scheduler->Suspend(Task);
+    }
+}
+
+void TWaitList::Notify()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (WaitingCount.load(std::memory_order_seq_cst) == 0)
+    {
+        return;
+    }
+    std::vector<TTask*> Woken;
+    {
+        // Taking the mutex orders this after a waiting thread's last check, so the notification is not lost
+        std::lock_guard Lock(Mutex);
+        Woken.swap(Suspended);
+        WaitingCount.fetch_sub(static_cast<int>(Woken.size()), std::memory_order_relaxed);
+        Signal.notify_all();
+    }
+    for (TTask* Task : Woken)
+    {
+        Task->Fiber->Scheduler->Wake(Task);
+    }
+}
+
+TScheduler::TScheduler(std::string InSource, int InWorkerCount, bool bInJit, int InMaxLoop)
+    : Source(std::move(InSource))
+      , WorkerCount(std::max(InWorkerCount, 1))
+      , bJit(bInJit)
+      , MaxLoop(InMaxLoop)
+{
+    for (int Index = 0; Index <= WorkerCount; Index++)
+    {
+        Queues.push_back(std::make_unique<TWorkQueue>());
+    }
+}
+
+TScheduler::~TScheduler()
+{
+    {
+        std::lock_guard Lock(SignalMutex);
+        bStopping = true;
+    }
+    Signal.notify_all();
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+    for (const std::unique_ptr<TWorkQueue>& Queue : Queues)
+    {
+        for (const TFiber* Fiber : Queue->IdleFibers)
+        {
+            delete Fiber;
+        }
+    }
+
+    // What tasks nobody joined printed comes out last, in the order they were spawned
+    std::map<int, const TTask*> Unjoined;
+    for (const auto& [Handle, Task] : Tasks)
+    {
+        Unjoined.emplace(Handle, Task.get());
+    }
+    for (const TTask* Task : Unjoined | std::views::values)
+    {
+        Runtime::GetContext().Output.Write(Task->Output);
+    }
+}
+
+bool TScheduler::Start()
+{
+    std::call_once(Started, [this]
+    {
+        Program = Embed::TProgram::Compile(Source);
+        if (!Program->IsValid())
+        {
+            return;
+        }
+        for (int Index = 0; Index < WorkerCount; Index++)
+        {
+            Workers.emplace_back(&TScheduler::Work, this, Index);
+        }
+    });
+    if (!Program->IsValid())
+    {
+        Logging::Error("Unable to compile the program for tasks.");
+        return false;
+    }
+    return true;
+}
+
+void TScheduler::Work(int Index)
+{
+    CurrentScheduler = this;
+    CurrentWorker = Index;
+    while (true)
+    {
+        // Read the generation before looking for work, so a task queued after the search wakes the worker
+        uint64_t Seen;
+        {
+            std::lock_guard Lock(SignalMutex);
+            Seen = Generation;
+        }
+        if (TTask* Task = FindTask(Index))
+        {
+            Run(Task);
+            continue;
+        }
+
+        // Every task spawned has run by the time the scheduler stops, since the queues are empty, unless one is
+        // suspended here. Nothing fails a suspended task, so the worker waits for it to be woken however long that is.
+        std::unique_lock Lock(SignalMutex);
+        if (bStopping && Queues[Index]->SuspendedCount == 0)
+        {
+            return;
+        }
+        Signal.wait(Lock, [this, Seen] { return bStopping || Generation != Seen; });
+    }
+}
+
+void TScheduler::Notify()
+{
+    {
+        std::lock_guard Lock(SignalMutex);
+        Generation++;
+    }
+    Signal.notify_all();
+}
+
+int TScheduler::GetWorkerIndex() const
+{
+    return CurrentScheduler == this ? CurrentWorker : -1;
+}
+
+TTask* TScheduler::FindTask(int Index)
+{
+    // A worker resumes its woken tasks first, since they started before any it has not run, then takes its own
+    // newest task, and a thread outside the pool the newest it spawned
+    TWorkQueue& Shared = *Queues[WorkerCount];
+    if (Index >= 0)
+    {
+        if (TTask* Task = Queues[Index]->PopWoken())
+        {
+            return Task;
+        }
+    }
+    if (TTask* Task = Index >= 0 ? Queues[Index]->Pop() : Shared.Pop())
+    {
+        return Task;
+    }
+    if (Index >= 0)
+    {
+        if (TTask* Task = Shared.Steal())
+        {
+            return Task;
+        }
+    }
+
+    // Then steals the oldest task of another worker, starting with the next one so thieves spread out
+    const int First = Index >= 0 ? Index + 1 : 0;
+    for (int Offset = 0; Offset < WorkerCount; Offset++)
+    {
+        const int Victim = (First + Offset) % WorkerCount;
+        if (Victim == Index)
+        {
+            continue;
+        }
+        if (TTask* Task = Queues[Victim]->Steal())
+        {
+            return Task;
+        }
+    }
+    return nullptr;
+}
+
+void TScheduler::Queue(TTask* Task)
+{
+    const int Index = GetWorkerIndex();
+    Queues[Index >= 0 ? Index : WorkerCount]->Push(Task);
+    Notify();
+}
+
+void TScheduler::Run(TTask* Task)
+{
+    // A thread outside the pool runs the task on its own stack, blocking wherever the task waits
+    const int Index = GetWorkerIndex();
+    if (Index < 0)
+    {
+        Execute(Task);
+        Finish(Task);
+        return;
+    }
+
+    if (!Task->Fiber)
+    {
+        Task->Fiber = AcquireFiber(Index);
+        if (!Task->Fiber)
+        {
+            Task->Errors.push_back("Unable to allocate a stack for the task.");
+            Finish(Task);
+            return;
+        }
+        Task->Home = Index;
+    }
+    Resume(Task);
+}
+
+void TScheduler::Execute(TTask* Task)
+{
+    // A thread waiting for a task runs other tasks inside the one it is running, and a worker runs others while its
+    // tasks are suspended, so each needs an interpreter of its own
+    std::unique_ptr<Embed::TExecution> Execution;
+    {
+        std::lock_guard Lock(ExecutionsMutex);
+        if (!Idle.empty())
+        {
+            Execution = std::move(Idle.back());
+            Idle.pop_back();
+        }
+    }
+    if (!Execution)
+    {
+        Execution = std::make_unique<Embed::TExecution>(Program, bJit);
+        Execution->GetContext().MaxLoop = MaxLoop;
+        Execution->GetContext().Scheduler = this;
+        Execution->GetContext().Output.Hold();
+    }
+
+    if (!Task->Body(*Execution))
+    {
+        Task->Errors = Execution->GetErrors();
+    }
+    Task->Body = nullptr;
+    Task->Output = Execution->GetContext().Output.Take();
+    {
+        std::lock_guard Lock(ExecutionsMutex);
+        Idle.push_back(std::move(Execution));
+    }
+}
+
+void TScheduler::Resume(TTask* Task)
+{
+    // The context and task current on this thread are the resumed task's until it switches back
+    Runtime::TContext* const Context = Runtime::CurrentContext;
+    TTask* const Outer = CurrentTask;
+    CurrentTask = Task;
+    Task->Fiber->SwitchIn();
+    CurrentTask = Outer;
+    Runtime::CurrentContext = Context;
+
+    if (Task->bExited)
+    {
+        ReleaseFiber(Task->Home, Task->Fiber);
+        Task->Fiber = nullptr;
+        Finish(Task);
+    }
+}
+
+void TScheduler::Suspend(TTask* Task)
+{
+    TWorkQueue& Home = *Queues[Task->Home];
+    Home.SuspendedCount++;
+    Runtime::TContext* const Context = Runtime::CurrentContext;
+    Task->Fiber->SwitchOut();
+    Runtime::CurrentContext = Context;
+    Home.SuspendedCount--;
+}
+
+void TScheduler::Wake(TTask* Task)
+{
+    Queues[Task->Home]->PushWoken(Task);
+    Notify();
+}
+
+void TScheduler::Finish(TTask* Task)
+{
+    // The joiner may free the task as soon as it is done, so nothing after this touches it
+    Task->bDone.store(true, std::memory_order_release);
+    Finished.Notify();
+    Notify();
+}
+
+TFiber* TScheduler::AcquireFiber(int Index)
+{
+    std::vector<TFiber*>& IdleFibers = Queues[Index]->IdleFibers;
+    if (!IdleFibers.empty())
+    {
+        TFiber* Fiber = IdleFibers.back();
+        IdleFibers.pop_back();
+        return Fiber;
+    }
+    auto* Fiber = new TFiber(this);
+    if (!Fiber->IsValid())
+    {
+        delete Fiber;
+        return nullptr;
+    }
+    return Fiber;
+}
+
+void TScheduler::ReleaseFiber(int Index, TFiber* Fiber)
+{
+    // A few are kept for the worker's tasks to come; the rest give their stacks back, which may have grown large
+    std::vector<TFiber*>& IdleFibers = Queues[Index]->IdleFibers;
+    if (IdleFibers.size() < IDLE_FIBERS_PER_WORKER)
+    {
+        IdleFibers.push_back(Fiber);
+        return;
+    }
+    delete Fiber;
+}
+
+void TScheduler::Wait(const TTask* Task)
+{
+    // A task on a worker is suspended until the other is done, rather than running tasks on top of itself which it
+    // could not return to the joiner until they finished
+    if (CurrentTask)
+    {
+        Finished.Wait([Task] { return Task->bDone.load(std::memory_order_acquire); });
+        return;
+    }
+
+    // Only a thread outside the pool gets here, which runs the tasks it finds to the end
+    const int Index = GetWorkerIndex();
+    while (!Task->bDone.load(std::memory_order_acquire))
+    {
+        uint64_t Seen;
+        {
+            std::lock_guard Lock(SignalMutex);
+            Seen = Generation;
+        }
+        if (TTask* Other = FindTask(Index))
+        {
+            Run(Other);
+            continue;
+        }
+        std::unique_lock Lock(SignalMutex);
+        Signal.wait(Lock, [this, Seen, Task]
+        {
+            return Generation != Seen || Task->bDone.load(std::memory_order_acquire);
+        });
+    }
+}
+
+bool TScheduler::Report(const TTask* Task)
+{
+    for (const std::string& Error : Task->Errors)
+    {
+        Logging::Error("'{}' failed: {}", Task->Function, Error);
+    }
+    return Task->Errors.empty();
+}
+
+std::optional<int> TScheduler::Spawn(const std::string& Function, TArgumentList Arguments)
+{
+    if (!Start())
+    {
+        return std::nullopt;
+    }
+
+    auto Task = std::make_unique<TTask>();
+    Task->Function = Function;
+    std::vector<TObject> Copies;
+    for (const TObject* Argument : Arguments)
+    {
+        Copies.push_back(*Argument);
+    }
+    TTask* Spawned = Task.get();
+
+    // What was printed before the task was spawned comes out before anything it prints
+    Runtime::GetContext().Output.Flush();
+    Task->Body = [Spawned, Copies = std::move(Copies)](Embed::TExecution& Execution) mutable
+    {
+        std::vector<TObject*> Values;
+        for (TObject& Copy : Copies)
+        {
+            Values.push_back(&Copy);
+        }
+        return Execution.Call(Spawned->Function, Values, Spawned->Result);
+    };
+
+    int Handle;
+    {
+        std::lock_guard Lock(TasksMutex);
+        Handle = NextHandle++;
+        Tasks.emplace(Handle, std::move(Task));
+    }
+    Queue(Spawned);
+    return Handle;
+}
+
+bool TScheduler::Join(int Handle, TObject& Result)
+{
+    std::unique_ptr<TTask> Task;
+    {
+        std::lock_guard Lock(TasksMutex);
+        const auto It = Tasks.find(Handle);
+        if (It != Tasks.end())
+        {
+            Task = std::move(It->second);
+            Tasks.erase(It);
+        }
+    }
+    if (!Task)
+    {
+        Logging::Error("Task {} does not exist or was already joined.", Handle);
+        return false;
+    }
+
+    Wait(Task.get());
+    Runtime::GetContext().Output.Write(Task->Output);
+    if (!Report(Task.get()))
+    {
+        return false;
+    }
+    Result = Task->Result;
+    return true;
+}
+
+bool TScheduler::ForEachChunk(const std::string& Function, size_t Size,
+                              const std::function<bool(Embed::TExecution&, size_t, size_t, size_t)>& Body,
+                              size_t& ChunkCount)
+{
+    if (!Start())
+    {
+        return false;
+    }
+
+    const size_t Chunks = WorkerCount * CHUNKS_PER_WORKER;
+    const size_t ChunkSize = std::max(SEQUENTIAL_CUTOFF, (Size + Chunks - 1) / Chunks);
+    ChunkCount = std::max<size_t>((Size + ChunkSize - 1) / ChunkSize, 1);
+
+    std::vector<std::unique_ptr<TTask>> Tasks;
+    for (size_t Chunk = 0; Chunk < ChunkCount; Chunk++)
+    {
+        const size_t Begin = Chunk * ChunkSize;
+        const size_t End = std::min(Begin + ChunkSize, Size);
+        auto Task = std::make_unique<TTask>();
+        Task->Function = Function;
+        Task->Body = [&Body, Chunk, Begin, End](Embed::TExecution& Execution)
+        {
+            return Body(Execution, Chunk, Begin, End);
+        };
+        Tasks.push_back(std::move(Task));
+    }
+
+    // A short array is a single chunk, which is run here; otherwise this thread runs chunks too while it waits
+    Runtime::GetContext().Output.Flush();
+    if (ChunkCount == 1)
+    {
+        Run(Tasks[0].get());
+    }
+    else
+    {
+        for (const std::unique_ptr<TTask>& Task : Tasks)
+        {
+            Queue(Task.get());
+        }
+    }
+
+    // Every chunk must finish before returning, since they read the array; the first to fail is the one reported.
+    // What the chunks printed comes out in the order of the elements.
+    bool bSucceeded = true;
+    for (const std::unique_ptr<TTask>& Task : Tasks)
+    {
+        Wait(Task.get());
+        Runtime::GetContext().Output.Write(Task->Output);
+        if (bSucceeded)
+        {
+            bSucceeded = Report(Task.get());
+        }
+    }
+    return bSucceeded;
+}
+
+// Call only copies its arguments, so it is passed the elements in place
+static TObject* GetElement(const TArray& Elements, size_t Index)
+{
+    return const_cast<TObject*>(&Elements[Index]);
+}
+
+std::optional<TObject> TScheduler::Map(const std::string& Function, const TArray& Elements)
+{
+    // Each chunk writes the results of its own elements, so they are in order once all have run
+    TArray Results(Elements.size());
+    size_t ChunkCount;
+    const bool bSucceeded = ForEachChunk(Function, Elements.size(),
+                                         [&](Embed::TExecution& Execution, size_t, size_t Begin, size_t End)
+                                         {
+                                             for (size_t Index = Begin; Index < End; Index++)
+                                             {
+                                                 TObject* Element = GetElement(Elements, Index);
+                                                 if (!Execution.Call(Function, {&Element, 1}, Results[Index]))
+                                                 {
+                                                     return false;
+                                                 }
+                                             }
+                                             return true;
+                                         }, ChunkCount);
+    if (!bSucceeded)
+    {
+        return std::nullopt;
+    }
+    return TArrayValue(std::move(Results));
+}
+
+std::optional<TObject> TScheduler::Filter(const std::string& Function, const TArray& Elements)
+{
+    std::vector<char> Keep(Elements.size());
+    size_t ChunkCount;
+    const bool bSucceeded = ForEachChunk(Function, Elements.size(),
+                                         [&](Embed::TExecution& Execution, size_t, size_t Begin, size_t End)
+                                         {
+                                             TObject Result;
+                                             for (size_t Index = Begin; Index < End; Index++)
+                                             {
+                                                 TObject* Element = GetElement(Elements, Index);
+                                                 if (!Execution.Call(Function, {&Element, 1}, Result))
+                                                 {
+                                                     return false;
+                                                 }
+                                                 if (Result.GetType() != BoolType)
+                                                 {
+                                                     Runtime::TScope Scope(Execution.GetContext());
+                                                     Logging::Error("'{}' must return bool, got '{}'.", Function,
+                                                                    Result.ToString());
+                                                     return false;
+                                                 }
+                                                 Keep[Index] = Result.RawBool();
+                                             }
+                                             return true;
+                                         }, ChunkCount);
+    if (!bSucceeded)
+    {
+        return std::nullopt;
+    }
+
+    TArray Results;
+    for (size_t Index = 0; Index < Elements.size(); Index++)
+    {
+        if (Keep[Index])
+        {
+            Results.push_back(Elements[Index]);
+        }
+    }
+    return TArrayValue(std::move(Results));
+}
+
+std::optional<TObject> TScheduler::Reduce(const std::string& Function, const TArray& Elements, const TObject& Initial)
+{
+    // Each chunk folds its elements into a result of its own, starting from its first element
+    TArray Partials(WorkerCount * CHUNKS_PER_WORKER + 1);
+    size_t ChunkCount;
+    const bool bSucceeded = ForEachChunk(Function, Elements.size(),
+                                         [&](Embed::TExecution& Execution, size_t Chunk, size_t Begin, size_t End)
+                                         {
+                                             if (Begin == End)
+                                             {
+                                                 return true;
+                                             }
+                                             TObject& Accumulator = Partials[Chunk];
+                                             Accumulator = Elements[Begin];
+                                             TObject Result;
+                                             for (size_t Index = Begin + 1; Index < End; Index++)
+                                             {
+                                                 TObject* Arguments[] = {&Accumulator, GetElement(Elements, Index)};
+                                                 if (!Execution.Call(Function, Arguments, Result))
+                                                 {
+                                                     return false;
+                                                 }
+                                                 Accumulator = Result;
+                                             }
+                                             return true;
+                                         }, ChunkCount);
+    if (!bSucceeded)
+    {
+        return std::nullopt;
+    }
+    if (Elements.empty())
+    {
+        return Initial;
+    }
+
+    // Then the chunks' results are folded in order, here, as one task so a single interpreter runs every call. On a
+    // worker, running the task returns as soon as it is suspended, so it is waited for like a chunk.
+    TObject Accumulator = Initial;
+    auto Combine = std::make_unique<TTask>();
+    Combine->Function = Function;
+    Combine->Body = [&](Embed::TExecution& Execution)
+    {
+        TObject Result;
+        for (size_t Index = 0; Index < ChunkCount; Index++)
+        {
+            TObject* Arguments[] = {&Accumulator, &Partials[Index]};
+            if (!Execution.Call(Function, Arguments, Result))
+            {
+                return false;
+            }
+            Accumulator = Result;
+        }
+        return true;
+    };
+    Run(Combine.get());
+    Wait(Combine.get());
+    if (!Report(Combine.get()))
+    {
+        return std::nullopt;
+    }
+    return Accumulator;
+}
@@ -1,4 +1,5 @@
 #include <functional>
+#include <limits>
 
 #include "../Public/Value.h"
 
@@ -290,6 +291,7 @@ bool TArrayValue::Contains(const TObject& InValue)
 TArrayValue TMapValue::GetKeys() const
 {
     TArray Keys;
+    Keys.reserve(Value.Size());
     for (const auto& [K, V] : Value)
     {
         Keys.push_back(K);
@@ -300,6 +302,7 @@ TArrayValue TMapValue::GetKeys() const
 TArrayValue TMapValue::GetValues() const
 {
     TArray Values;
+    Values.reserve(Value.Size());
     for (const auto& [K, V] : Value)
     {
         Values.push_back(V);
@@ -307,184 +310,222 @@ TArrayValue TMapValue::GetValues() const
     return TArrayValue(Values);
 }
 
-bool TMapValue::HasKey(const std::string& Key) const
+bool TMapValue::HasKey(std::string_view Key) const
 {
-    return Value.find(Key) != Value.end();
+    return Value.Contains(Key);
 }
 
-TObject TObject::operator+(const TObject& Other) const
+//////////////////////////////////
+// Binary operator kernel table //
+//////////////////////////////////
+
+// Each kernel handles exactly one operator and one (Left, Right) type pair, so it reads the operands with the unchecked
+// accessors and writes the result in place. Operands are read before Out is written since Out may alias either one.
+
+#define ARITHMETIC_KERNELS(Name, Op)                                    \
+    static void Name##_Int_Int(const TObject& Left, const TObject& Right, TObject& Out)     \
+    {                                                                   \
+        Out.SetInt(Left.RawInt() Op Right.RawInt());                    \
+    }                                                                   \
+    static void Name##_Int_Float(const TObject& Left, const TObject& Right, TObject& Out)   \
+    {                                                                   \
+        Out.SetFloat(Left.RawInt() Op Right.RawFloat());                \
+    }                                                                   \
+    static void Name##_Float_Int(const TObject& Left, const TObject& Right, TObject& Out)   \
+    {                                                                   \
+        Out.SetFloat(Left.RawFloat() Op Right.RawInt());                \
+    }                                                                   \
+    static void Name##_Float_Float(const TObject& Left, const TObject& Right, TObject& Out) \
+    {                                                                   \
+        Out.SetFloat(Left.RawFloat() Op Right.RawFloat());              \
+    }
+
+ARITHMETIC_KERNELS(Add, +)
+ARITHMETIC_KERNELS(Sub, -)
+ARITHMETIC_KERNELS(Mul, *)
+
+// Division is written out rather than generated, since int division must check for zero and overflow
+static void Div_Int_Int(const TObject& Left, const TObject& Right, TObject& Out)
 {
-    switch (Type)
+    const int Dividend = Left.RawInt();
+    const int Divisor = Right.RawInt();
+    if (!CanDivide(Dividend, Divisor))
     {
-    case IntType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsInt()->GetValue() + Other.AsInt()->GetValue();
-            case FloatType :
-                return AsInt()->GetValue() + Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    case FloatType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsFloat()->GetValue() + Other.AsInt()->GetValue();
-            case FloatType :
-                return AsFloat()->GetValue() + Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    case StringType :
-        {
-            return AsString()->GetValue() + Other.AsString()->GetValue();
-        }
-    default :
-        break;
+        Out.SetNull();
+        return;
     }
-    return TObject();
+    Out.SetInt(Dividend / Divisor);
 }
 
-TObject TObject::operator-(const TObject& Other) const
+static void Div_Int_Float(const TObject& Left, const TObject& Right, TObject& Out)
 {
-    switch (Type)
-    {
-    case IntType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsInt()->GetValue() - Other.AsInt()->GetValue();
-            case FloatType :
-                return AsInt()->GetValue() - Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    case FloatType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsFloat()->GetValue() - Other.AsInt()->GetValue();
-            case FloatType :
-                return AsFloat()->GetValue() - Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    default :
-        break;
+    Out.SetFloat(Left.RawInt() / Right.RawFloat());
+}
+
+static void Div_Float_Int(const TObject& Left, const TObject& Right, TObject& Out)
+{
+    Out.SetFloat(Left.RawFloat() / Right.RawInt());
+}
+
+static void Div_Float_Float(const TObject& Left, const TObject& Right, TObject& Out)
+{
+    Out.SetFloat(Left.RawFloat() / Right.RawFloat());
+}
+
+static void Add_String_String(const TObject& Left, const TObject& Right, TObject& Out)
+{
+    Out.SetString(Left.RawString() + Right.RawString());
+}
+
+#define COMPARE_KERNELS(Name, Op)                                                              \
+    static void Name##_Bool_Bool(const TObject& Left, const TObject& Right, TObject& Out)     \
+    {                                                                                          \
+        Out.SetBool(Left.RawBool() Op Right.RawBool());                                       \
+    }                                                                                          \
+    static void Name##_Int_Int(const TObject& Left, const TObject& Right, TObject& Out)       \
+    {                                                                                          \
+        Out.SetBool(Left.RawInt() Op Right.RawInt());                                         \
+    }                                                                                          \
+    static void Name##_Float_Float(const TObject& Left, const TObject& Right, TObject& Out)   \
+    {                                                                                          \
+        Out.SetBool(Left.RawFloat() Op Right.RawFloat());                                     \
+    }                                                                                          \
+    static void Name##_String_String(const TObject& Left, const TObject& Right, TObject& Out) \
+    {                                                                                          \
+        Out.SetBool(Left.RawString() Op Right.RawString());                                   \
     }
-    return TObject();
+
+COMPARE_KERNELS(Less, <)
+COMPARE_KERNELS(Greater, >)
+COMPARE_KERNELS(Equal, ==)
+COMPARE_KERNELS(NotEqual, !=)
+
+static void Null_Any_Any(const TObject&, const TObject&, TObject& Out)
+{
+    Out.SetNull();
 }
 
-TObject TObject::operator*(const TObject& Other) const
+// Values of different types, and containers, are never equal
+static void False_Any_Any(const TObject&, const TObject&, TObject& Out)
 {
-    switch (Type)
+    Out.SetBool(false);
+}
+
+static void True_Any_Any(const TObject&, const TObject&, TObject& Out)
+{
+    Out.SetBool(true);
+}
+
+struct TBinaryKernelTable
+{
+    TBinaryKernel Kernels[static_cast<int>(EBinaryOp::Count)][TypeCount][TypeCount]{};
+
+    constexpr void Set(EBinaryOp Op, EValueType Left, EValueType Right, TBinaryKernel Kernel)
     {
-    case IntType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsInt()->GetValue() * Other.AsInt()->GetValue();
-            case FloatType :
-                return AsInt()->GetValue() * Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    case FloatType :
+        Kernels[static_cast<int>(Op)][Left][Right] = Kernel;
+    }
+
+    constexpr void SetArithmetic(EBinaryOp Op, TBinaryKernel IntInt, TBinaryKernel IntFloat, TBinaryKernel FloatInt,
+                                 TBinaryKernel FloatFloat)
+    {
+        Set(Op, IntType, IntType, IntInt);
+        Set(Op, IntType, FloatType, IntFloat);
+        Set(Op, FloatType, IntType, FloatInt);
+        Set(Op, FloatType, FloatType, FloatFloat);
+    }
+
+    constexpr void SetCompare(EBinaryOp Op, TBinaryKernel BoolBool, TBinaryKernel IntInt, TBinaryKernel FloatFloat,
+                              TBinaryKernel StringString)
+    {
+        Set(Op, BoolType, BoolType, BoolBool);
+        Set(Op, IntType, IntType, IntInt);
+        Set(Op, FloatType, FloatType, FloatFloat);
+        Set(Op, StringType, StringType, StringString);
+    }
+
+    constexpr TBinaryKernelTable()
+    {
+        for (int Op = 0; Op < static_cast<int>(EBinaryOp::Count); Op++)
         {
-            switch (Other.Type)
+            for (int Left = 0; Left < TypeCount; Left++)
             {
-            case IntType :
-                return AsFloat()->GetValue() * Other.AsInt()->GetValue();
-            case FloatType :
-                return AsFloat()->GetValue() * Other.AsFloat()->GetValue();
-            default :
-                break;
+                for (int Right = 0; Right < TypeCount; Right++)
+                {
+                    switch (static_cast<EBinaryOp>(Op))
+                    {
+                    case EBinaryOp::Equal :
+                        Kernels[Op][Left][Right] = False_Any_Any;
+                        break;
+                    case EBinaryOp::NotEqual :
+                        Kernels[Op][Left][Right] = True_Any_Any;
+                        break;
+                    default :
+                        Kernels[Op][Left][Right] = Null_Any_Any;
+                        break;
+                    }
+                }
             }
-            break;
         }
-    default :
-        break;
+
+        SetArithmetic(EBinaryOp::Add, Add_Int_Int, Add_Int_Float, Add_Float_Int, Add_Float_Float);
+        SetArithmetic(EBinaryOp::Sub, Sub_Int_Int, Sub_Int_Float, Sub_Float_Int, Sub_Float_Float);
+        SetArithmetic(EBinaryOp::Mul, Mul_Int_Int, Mul_Int_Float, Mul_Float_Int, Mul_Float_Float);
+        SetArithmetic(EBinaryOp::Div, Div_Int_Int, Div_Int_Float, Div_Float_Int, Div_Float_Float);
+        Set(EBinaryOp::Add, StringType, StringType, Add_String_String);
+
+        SetCompare(EBinaryOp::Less, Less_Bool_Bool, Less_Int_Int, Less_Float_Float, Less_String_String);
+        SetCompare(EBinaryOp::Greater, Greater_Bool_Bool, Greater_Int_Int, Greater_Float_Float, Greater_String_String);
+        SetCompare(EBinaryOp::Equal, Equal_Bool_Bool, Equal_Int_Int, Equal_Float_Float, Equal_String_String);
+        SetCompare(EBinaryOp::NotEqual, NotEqual_Bool_Bool, NotEqual_Int_Int, NotEqual_Float_Float,
+                   NotEqual_String_String);
     }
-    return TObject();
+};
+
+static constexpr TBinaryKernelTable BINARY_KERNELS;
+
+void TObject::BinaryOp(EBinaryOp Op, const TObject& Left, const TObject& Right, TObject& Out)
+{
+    BINARY_KERNELS.Kernels[static_cast<int>(Op)][Left.Type][Right.Type](Left, Right, Out);
+}
+
+TBinaryKernel TObject::GetBinaryKernel(EBinaryOp Op, EValueType Left, EValueType Right)
+{
+    return BINARY_KERNELS.Kernels[static_cast<int>(Op)][Left][Right];
+}
+
+#define TOBJECT_BINARY_OP_BODY(Op)     \
+    TObject Result;                    \
+    BinaryOp(Op, *this, Other, Result); \
+    return Result;
+
+TObject TObject::operator+(const TObject& Other) const
+{
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Add)
+}
+
+TObject TObject::operator-(const TObject& Other) const
+{
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Sub)
+}
+
+TObject TObject::operator*(const TObject& Other) const
+{
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Mul)
 }
 
 TObject TObject::operator/(const TObject& Other) const
 {
-    switch (Type)
-    {
-    case IntType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsInt()->GetValue() / Other.AsInt()->GetValue();
-            case FloatType :
-                return AsInt()->GetValue() / Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    case FloatType :
-        {
-            switch (Other.Type)
-            {
-            case IntType :
-                return AsFloat()->GetValue() / Other.AsInt()->GetValue();
-            case FloatType :
-                return AsFloat()->GetValue() / Other.AsFloat()->GetValue();
-            default :
-                break;
-            }
-            break;
-        }
-    default :
-        break;
-    }
-    return TObject();
-}
-
-#define TOBJECT_COMPARE_OP_BODY(X)                                            \
-    if (Type == Other.Type)                                                   \
-    {                                                                         \
-        switch (Type)                                                         \
-        {                                                                     \
-            case BoolType :                                                   \
-                return GetBool().GetValue() X Other.GetBool().GetValue();     \
-            case IntType :                                                    \
-                return GetInt().GetValue() X Other.GetInt().GetValue();       \
-            case FloatType :                                                  \
-                return GetFloat().GetValue() X Other.GetFloat().GetValue();   \
-            case StringType :                                                 \
-                return GetString().GetValue() X Other.GetString().GetValue(); \
-            default :                                                         \
-                return TObject();                                             \
-        }                                                                     \
-    } \
-    return TObject();
-
-
-TObject TObject::operator<(const TObject& Other) const { TOBJECT_COMPARE_OP_BODY(<) }
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Div)
+}
+
+TObject TObject::operator<(const TObject& Other) const
+{
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Less)
+}
 
 TObject TObject::operator>(const TObject& Other) const
 {
-    TOBJECT_COMPARE_OP_BODY(>)
+    TOBJECT_BINARY_OP_BODY(EBinaryOp::Greater)
 }
 
 bool TObject::operator==(const TObject& Other) const
@@ -504,6 +545,13 @@ bool TObject::operator==(const TObject& Other) const
         return AsFloat()->GetValue() == Other.AsFloat()->GetValue();
     case StringType :
         return AsString()->GetValue() == Other.AsString()->GetValue();
+    // Handles are equal when they share the channel or file, as copies of one do
+    case ChannelType :
+        return &AsChannel()->GetValue() == &Other.AsChannel()->GetValue();
+    case FileType :
+        return &AsFile()->GetValue() == &Other.AsFile()->GetValue();
+    default :
+        break;
     }
 
     return false;
@@ -523,3 +571,45 @@ bool IsType(const TObject& Value, const EValueType Type)
 {
     return Value.GetType() == Type;
 }
+
+std::string Values::GetTypeName(const EValueType Type)
+{
+    switch (Type)
+    {
+    case NullType :
+        return "null";
+    case BoolType :
+        return "bool";
+    case IntType :
+        return "int";
+    case FloatType :
+        return "float";
+    case StringType :
+        return "string";
+    case ArrayType :
+        return "array";
+    case MapType :
+        return "map";
+    case ChannelType :
+        return "channel";
+    case FileType :
+        return "file";
+    default :
+        return "void";
+    }
+}
+
+bool Values::CanDivide(const int Dividend, const int Divisor)
+{
+    if (Divisor == 0)
+    {
+        Logging::Error("Division by zero.");
+        return false;
+    }
+    if (Divisor == -1 && Dividend == std::numeric_limits<int>::min())
+    {
+        Logging::Error("Integer overflow dividing {} by -1.", Dividend);
+        return false;
+    }
+    return true;
+}
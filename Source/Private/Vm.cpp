@@ -0,0 +1,896 @@
+#include "../Public/Vm.h"
+
+#include "../Public/Ast.h"
+#include "../Public/Compiler.h"
+
+using namespace Vm;
+
+std::string Vm::ToString(EOpCode Op)
+{
+    switch (Op)
+    {
+#define VM_OPCODE_STRING(Name) \
+    case EOpCode::Name :              \
+        return #Name;
+        VM_OPCODES(VM_OPCODE_STRING)
+#undef VM_OPCODE_STRING
+    default :
+        return "Invalid";
+    }
+}
+
+std::string Vm::ToString(ERegisterOp Op)
+{
+    switch (Op)
+    {
+#define VM_REGISTER_OPCODE_STRING(Name) \
+    case ERegisterOp::Name :                   \
+        return #Name;
+        VM_REGISTER_OPCODES(VM_REGISTER_OPCODE_STRING)
+#undef VM_REGISTER_OPCODE_STRING
+    default :
+        return "Invalid";
+    }
+}
+
+// Logs an error and stops the program
+#define VM_ERROR(...)                 \
+    {                                 \
+        Logging::Error(__VA_ARGS__);  \
+        return false;                 \
+    }
+
+// Adds to the operand moves counted for --stats: reads and writes of stack slots, registers and variable bindings, and
+// copies of values
+#define VM_MOVES(Count)            \
+    if constexpr (bStats)          \
+    {                              \
+        Stats->Moves += (Count);   \
+    }
+
+// Reads a cell into Value, failing if it is an unbound variable
+#define VM_READ_CELL(Value, Index)                                      \
+    TObject* Value = *Cells[Index];                                      \
+    VM_MOVES(1)                                                          \
+    if (!Value || Value->GetType() == NullType)                          \
+    {                                                                    \
+        VM_ERROR("'{}' is undefined.", Chunk.CellNames[Index])           \
+    }
+
+// Reads a register into Value, failing if it holds an unbound variable. Only variable registers can be unbound.
+#define VM_READ_REGISTER(Value, Index)                                  \
+    TObject* Value = Registers[Index];                                   \
+    VM_MOVES(1)                                                          \
+    if (!Value || Value->GetType() == NullType)                          \
+    {                                                                    \
+        VM_ERROR("'{}' is undefined.", Unit->Names[Index])               \
+    }
+
+// Compares operands A and B, read with Read, and jumps to C if the comparison is false. Int and float pairs are
+// compared inline; anything else goes through the binary operator table like the tree does.
+#define VM_COMPARE_AND_BRANCH(Name, Op, Operator, Read)                                 \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        Read(Left, Instruction->A)                                                      \
+        Read(Right, Instruction->B)                                                     \
+        bool bResult;                                                                   \
+        if (Left->GetType() == IntType && Right->GetType() == IntType)                  \
+        {                                                                               \
+            bResult = Left->RawInt() Op Right->RawInt();                                \
+        }                                                                               \
+        else if (Left->GetType() == FloatType && Right->GetType() == FloatType)         \
+        {                                                                               \
+            bResult = Left->RawFloat() Op Right->RawFloat();                            \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            TObject::BinaryOp(Operator, *Left, *Right, Scratch);                        \
+            if (Scratch.GetType() != BoolType)                                          \
+            {                                                                           \
+                VM_ERROR("Unable to compare '{}' and '{}'.", Left->ToString(), Right->ToString()) \
+            }                                                                           \
+            bResult = Scratch.RawBool();                                                \
+        }                                                                               \
+        if (!bResult)                                                                   \
+        {                                                                               \
+            Ip = Code + Instruction->C;                                                 \
+        }                                                                               \
+        VM_DISPATCH();                                                                  \
+    }
+
+// Counts the instruction about to run, in the instantiation which keeps statistics
+#define VM_COUNT()                \
+    if constexpr (bStats)         \
+    {                             \
+        Stats->Instructions++;    \
+    }
+
+#if VM_COMPUTED_GOTO
+    #define VM_CASE(Name) Op_##Name:
+    #define VM_DISPATCH()          \
+        Instruction = Ip++;        \
+        VM_COUNT()                 \
+        goto *Labels[static_cast<uint8_t>(Instruction->Op)]
+#else
+    #define VM_CASE(Name) case decltype(Instruction->Op)::Name:
+    #define VM_DISPATCH() continue
+#endif
+
+bool TVirtualMachine::Run(TChunk& Chunk)
+{
+    if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)
+    {
+        return false;
+    }
+    return Stats ? Execute<true>(Chunk) : Execute<false>(Chunk);
+}
+
+template <bool bStats>
+bool TVirtualMachine::Execute(TChunk& Chunk)
+{
+    std::vector<TObject*> Stack(Chunk.MaxStackDepth + 1);
+    std::vector<int> Counters(Chunk.LoopCount);
+    TObject** Sp = Stack.data();
+    TObject** const* Cells = Chunk.Cells.data();
+    TObject* Sites = Chunk.Sites.data();
+    const TInstruction* Code = Chunk.Code.data();
+    const TInstruction* Ip = Code;
+    const TInstruction* Instruction;
+    const TObject MinusOne(-1);
+    TObject Scratch;
+    const int MaxLoop = Runtime::GetContext().MaxLoop;
+
+#if VM_COMPUTED_GOTO
+    // Indexed by opcode; the X-macro keeps it in the same order as EOpCode
+    static void* const Labels[] = {
+    #define VM_OPCODE_LABEL(Name) &&Op_##Name,
+        VM_OPCODES(VM_OPCODE_LABEL)
+    #undef VM_OPCODE_LABEL
+    };
+    VM_DISPATCH();
+#else
+    for (;;)
+    {
+        Instruction = Ip++;
+        VM_COUNT()
+        switch (Instruction->Op)
+        {
+#endif
+
+    VM_CASE(Load)
+    {
+        VM_READ_CELL(Value, Instruction->A)
+        *Sp++ = Value;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Store)
+    {
+        const TObject* Value = *--Sp;
+        if (Value->GetType() == NullType)
+        {
+            VM_ERROR("Cannot assign nulltype.")
+        }
+        TObject& Site = Sites[Instruction->B];
+        Site = *Value;
+        *Cells[Instruction->A] = &Site;
+        VM_MOVES(3)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Pop)
+    {
+        --Sp;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Binary)
+    {
+        const TObject* Right = *--Sp;
+        const TObject* Left = Sp[-1];
+        TObject& Site = Sites[Instruction->B];
+        TObject::BinaryOp(static_cast<EBinaryOp>(Instruction->A), *Left, *Right, Site);
+        Sp[-1] = &Site;
+        VM_MOVES(3)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Not)
+    {
+        const TObject* Value = Sp[-1];
+        if (Value->GetType() != BoolType)
+        {
+            VM_ERROR("Operator '!' wants a bool, got '{}'.", Value->ToString())
+        }
+        TObject& Site = Sites[Instruction->A];
+        Site.SetBool(!Value->RawBool());
+        Sp[-1] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Negate)
+    {
+        TObject& Site = Sites[Instruction->A];
+        TObject::BinaryOp(EBinaryOp::Mul, *Sp[-1], MinusOne, Site);
+        Sp[-1] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Jump)
+    {
+        Ip = Code + Instruction->A;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(JumpIfFalse)
+    {
+        const TObject* Value = *--Sp;
+        VM_MOVES(1)
+        if (Value->GetType() != BoolType)
+        {
+            VM_ERROR("Condition is not a bool: '{}'.", Value->ToString())
+        }
+        if (!Value->RawBool())
+        {
+            Ip = Code + Instruction->A;
+        }
+        VM_DISPATCH();
+    }
+
+    VM_CASE(LoopEnter)
+    {
+        Counters[Instruction->A] = 1;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(LoopBack)
+    {
+        if (++Counters[Instruction->A] == MaxLoop)
+        {
+            VM_ERROR("ERROR: Hit max loop count ({}).", MaxLoop)
+        }
+        Ip = Code + Instruction->B;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Eval)
+    {
+        // The tree walker pushes to the frame's stack; take its value, if one is wanted, and drop anything else
+        Frame* CurrentFrame = Interpreter->CurrentFrame;
+        const size_t Depth = CurrentFrame->Stack.size();
+        Chunk.Nodes[Instruction->A]->Accept(Interpreter);
+        if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)
+        {
+            return false;
+        }
+        if (Instruction->B)
+        {
+            if (CurrentFrame->Stack.size() <= Depth)
+            {
+                VM_ERROR("Stack is empty.")
+            }
+            *Sp++ = CurrentFrame->Stack.back();
+            VM_MOVES(1)
+        }
+        CurrentFrame->Stack.resize(Depth);
+        VM_DISPATCH();
+    }
+
+    VM_CASE(AddConst)
+    {
+        VM_READ_CELL(Value, Instruction->A)
+        const TObject* Constant = *Cells[Instruction->B];
+        VM_MOVES(1)
+        TObject& Site = Sites[Instruction->C];
+        if (Value->GetType() == IntType && Constant->GetType() == IntType)
+        {
+            Site.SetInt(Value->RawInt() + Constant->RawInt());
+        }
+        else
+        {
+            TObject::BinaryOp(EBinaryOp::Add, *Value, *Constant, Site);
+            if (Site.GetType() == NullType)
+            {
+                VM_ERROR("Cannot assign nulltype.")
+            }
+        }
+        *Cells[Instruction->A] = &Site;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_COMPARE_AND_BRANCH(JumpUnlessLess, <, EBinaryOp::Less, VM_READ_CELL)
+    VM_COMPARE_AND_BRANCH(JumpUnlessGreater, >, EBinaryOp::Greater, VM_READ_CELL)
+    VM_COMPARE_AND_BRANCH(JumpUnlessEqual, ==, EBinaryOp::Equal, VM_READ_CELL)
+    VM_COMPARE_AND_BRANCH(JumpUnlessNotEqual, !=, EBinaryOp::NotEqual, VM_READ_CELL)
+
+    VM_CASE(LoadIndex)
+    {
+        VM_READ_CELL(Container, Instruction->A)
+        VM_READ_CELL(Index, Instruction->B)
+        if (Index->GetType() != IntType)
+        {
+            VM_ERROR("Index must be an int, got '{}'.", Index->ToString())
+        }
+        TObject& Site = Sites[Instruction->C];
+        const TObject* Element;
+        switch (Container->GetType())
+        {
+        case StringType :
+            Site = Container->At(*Index);
+            break;
+        case ArrayType :
+            Element = Container->AsArray()->At(Index->RawInt());
+            if (!Element)
+            {
+                VM_ERROR("Index {} is out of range.", Index->RawInt())
+            }
+            Site = *Element;
+            break;
+        default :
+            VM_ERROR("Invalid identifier type.")
+        }
+        *Sp++ = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Halt)
+    {
+        return true;
+    }
+
+#if !VM_COMPUTED_GOTO
+        default :
+            VM_ERROR("Invalid opcode {}.", static_cast<int>(Instruction->Op))
+        }
+    }
+#endif
+}
+
+// Computes an arithmetic operator into the instruction's site, inline for a pair of ints
+#define VM_ARITHMETIC(Name, Op)                                                         \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        VM_READ_REGISTER(Left, Instruction->B)                                          \
+        VM_READ_REGISTER(Right, Instruction->C)                                         \
+        TObject& Site = Sites[Instruction - Code];                                      \
+        if (Left->GetType() == IntType && Right->GetType() == IntType)                  \
+        {                                                                               \
+            Site.SetInt(Left->RawInt() Op Right->RawInt());                             \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            VM_BINARY(EBinaryOp::Name, Site)                                            \
+        }                                                                               \
+        Registers[Instruction->A] = &Site;                                              \
+        VM_MOVES(1)                                                                     \
+        VM_DISPATCH();                                                                  \
+    }
+
+// Computes a comparison into the instruction's site, inline for a pair of ints or floats
+#define VM_COMPARISON(Name, Op)                                                         \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        VM_READ_REGISTER(Left, Instruction->B)                                          \
+        VM_READ_REGISTER(Right, Instruction->C)                                         \
+        TObject& Site = Sites[Instruction - Code];                                      \
+        if (Left->GetType() == IntType && Right->GetType() == IntType)                  \
+        {                                                                               \
+            Site.SetBool(Left->RawInt() Op Right->RawInt());                            \
+        }                                                                               \
+        else if (Left->GetType() == FloatType && Right->GetType() == FloatType)         \
+        {                                                                               \
+            Site.SetBool(Left->RawFloat() Op Right->RawFloat());                        \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            VM_BINARY(EBinaryOp::Name, Site)                                            \
+        }                                                                               \
+        Registers[Instruction->A] = &Site;                                              \
+        VM_MOVES(1)                                                                     \
+        VM_DISPATCH();                                                                  \
+    }
+
+// Applies a binary operator through the kernel table. Unsupported operands produce null, which no register may hold:
+// like the tree, an expression statement then leaves nothing behind and anything else fails.
+#define VM_BINARY(Operator, Site)                                                       \
+    TObject::BinaryOp(Operator, *Left, *Right, Site);                                   \
+    if (Site.GetType() == NullType)                                                     \
+    {                                                                                   \
+        if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)               \
+        {                                                                               \
+            return false;                                                               \
+        }                                                                               \
+        if (Instruction->A == Unit->ResultRegister)                                     \
+        {                                                                               \
+            VM_DISPATCH();                                                              \
+        }                                                                               \
+        VM_ERROR("Cannot assign nulltype.")                                             \
+    }
+
+// Computes a typed operator from the raw values of its operands, which the compiler proved are of the type Raw reads
+#define VM_TYPED_ARITHMETIC(Name, Op, Raw, Set)                                         \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        TObject& Site = Sites[Instruction - Code];                                      \
+        Site.Set(Registers[Instruction->B]->Raw() Op Registers[Instruction->C]->Raw()); \
+        Registers[Instruction->A] = &Site;                                              \
+        VM_MOVES(3)                                                                     \
+        VM_DISPATCH();                                                                  \
+    }
+
+// Compares the raw values of operands A and B, of a proven type, and jumps to C if the comparison is false
+#define VM_TYPED_BRANCH(Name, Op, Raw)                                                  \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        VM_MOVES(2)                                                                     \
+        if (!(Registers[Instruction->A]->Raw() Op Registers[Instruction->B]->Raw()))    \
+        {                                                                               \
+            Ip = Code + Instruction->C;                                                 \
+        }                                                                               \
+        VM_DISPATCH();                                                                  \
+    }
+
+// Fails with the message unless register A holds a value of type B, the annotation the instruction checks
+#define VM_CHECK(Name, ...)                                                             \
+    VM_CASE(Name)                                                                       \
+    {                                                                                   \
+        const TObject* Value = Registers[Instruction->A];                               \
+        VM_MOVES(1)                                                                     \
+        const auto Type = static_cast<EValueType>(Instruction->B);                      \
+        if (!Value || Value->GetType() != Type)                                         \
+        {                                                                               \
+            const std::string Got = Value ? Value->ToString() : "nothing";              \
+            VM_ERROR(__VA_ARGS__)                                                       \
+        }                                                                               \
+        VM_DISPATCH();                                                                  \
+    }
+
+// The variable registers cache the frame's bindings; these write them back and reload them around anything else which
+// can see the frame
+#define VM_WRITE_BACK()                                          \
+    for (int Variable = 0; Variable < VariableCount; Variable++) \
+    {                                                            \
+        VM_MOVES(1)                                              \
+        if (Registers[Variable])                                 \
+        {                                                        \
+            *Cells[Variable] = Registers[Variable];              \
+            VM_MOVES(1)                                          \
+        }                                                        \
+    }
+
+#define VM_RELOAD()                                              \
+    for (int Variable = 0; Variable < VariableCount; Variable++) \
+    {                                                            \
+        Registers[Variable] = *Cells[Variable];                  \
+    }                                                            \
+    VM_MOVES(2 * VariableCount)
+
+// Points register A at a copy of the value produced by Eval or Call, as described by TRegisterInstruction
+#define VM_SET_RESULT(Value)                       \
+    if (Value && Instruction->A >= 0)              \
+    {                                              \
+        TObject& Site = Sites[Instruction - Code]; \
+        Site = *Value;                             \
+        Registers[Instruction->A] = &Site;         \
+        VM_MOVES(2)                                \
+    }                                              \
+    else if (!Value && Instruction->C)             \
+    {                                              \
+        VM_ERROR("Stack is empty.")                \
+    }
+
+TRegisterCode* TRegisterMachine::GetCode(const AstFunction* Function)
+{
+    std::unique_ptr<TRegisterCode>& Code = Functions[Function];
+    if (!Code)
+    {
+        TRegisterCompiler Compiler(Interpreter->CurrentFrame, Interpreter->Functions, InlineReport);
+        Code = Compiler.Compile(Function);
+    }
+    return Code.get();
+}
+
+// Starts a call: resolves the current instruction's call site B, writes the caller's variables back and binds the
+// callee's parameters as the tree does, variables by reference and literals to a copy. The moves counted include those
+// Enter makes loading the callee's registers.
+#define VM_BEGIN_CALL(Callee)                                                                         \
+    TCallSite& Call = Unit->Calls[Instruction->B];                                                    \
+    if (!Call.Function)                                                                               \
+    {                                                                                                 \
+        const auto It = Interpreter->Functions.find(Call.Name);                                       \
+        if (It == Interpreter->Functions.end())                                                       \
+        {                                                                                             \
+            VM_ERROR("Function '{}' is undeclared.", Call.Name)                                       \
+        }                                                                                             \
+        Call.Function = It->second;                                                                   \
+    }                                                                                                 \
+    if (Call.Args.size() != Call.Function->Args.size())                                               \
+    {                                                                                                 \
+        VM_ERROR("Argument count mismatch for '{}'. Got {}, wanted {}.", Call.Name, Call.Args.size(), \
+                 Call.Function->Args.size())                                                          \
+    }                                                                                                 \
+    TRegisterCode* Callee = GetCode(Call.Function);                                                   \
+    VM_WRITE_BACK()                                                                                   \
+    for (size_t Index = 0; Index < Call.Args.size(); Index++)                                         \
+    {                                                                                                 \
+        const int Arg = Call.Args[Index];                                                             \
+        VM_READ_REGISTER(Value, Arg)                                                                  \
+        if (Arg >= VariableCount)                                                                     \
+        {                                                                                             \
+            Call.Literals[Index] = *Value;                                                            \
+            Value = &Call.Literals[Index];                                                            \
+            VM_MOVES(1)                                                                               \
+        }                                                                                             \
+        *Callee->Cells[Index] = Value;                                                                \
+        VM_MOVES(1)                                                                                   \
+    }                                                                                                 \
+    VM_MOVES(2 * Callee->Cells.size() + Callee->Constants.size())
+
+// Pushes an activation for a call to Unit, or for the program if ReturnIp is null, and loads its registers
+bool TRegisterMachine::Enter(TRegisterCode* Unit, const TRegisterInstruction* ReturnIp)
+{
+    const size_t RegisterBase = RegisterStack.size();
+    const size_t CounterBase = CounterStack.size();
+    const size_t Bytes = (RegisterBase + Unit->RegisterCount) * sizeof(TObject*)
+        + (CounterBase + Unit->LoopCount) * sizeof(int) + (CallStack.size() + 1) * sizeof(TActivation);
+    if (Bytes > StackBudget)
+    {
+        Logging::Error("Stack budget of {} bytes exceeded at call depth {}.", StackBudget, CallStack.size());
+        return false;
+    }
+
+    // Variables are loaded from the frame, constants point at their literals and the result and temporaries start out
+    // empty
+    RegisterStack.resize(RegisterBase + Unit->RegisterCount);
+    CounterStack.resize(CounterBase + Unit->LoopCount);
+    CallStack.push_back({Unit, ReturnIp, RegisterBase, CounterBase});
+    TObject** Registers = RegisterStack.data() + RegisterBase;
+    const size_t VariableCount = Unit->Cells.size();
+    for (size_t Variable = 0; Variable < VariableCount; Variable++)
+    {
+        Registers[Variable] = *Unit->Cells[Variable];
+    }
+    std::ranges::copy(Unit->Constants, Registers + VariableCount);
+    return true;
+}
+
+bool TRegisterMachine::Run(TRegisterCode& Program)
+{
+    if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)
+    {
+        return false;
+    }
+    RegisterStack.clear();
+    CounterStack.clear();
+    CallStack.clear();
+    if (!Enter(&Program, nullptr))
+    {
+        return false;
+    }
+    return Stats ? Execute<true>() : Execute<false>();
+}
+
+// Points the dispatch loop's state at the innermost activation. The stacks may have moved since it last ran.
+#define VM_LOAD_ACTIVATION()                                           \
+    {                                                                  \
+        const TActivation& Activation = CallStack.back();              \
+        Unit = Activation.Unit;                                        \
+        Registers = RegisterStack.data() + Activation.RegisterBase;    \
+        Counters = CounterStack.data() + Activation.CounterBase;       \
+        Cells = Unit->Cells.data();                                    \
+        VariableCount = static_cast<int>(Unit->Cells.size());          \
+        Sites = Unit->Sites.data();                                    \
+        Code = Unit->Code.data();                                      \
+    }
+
+template <bool bStats>
+bool TRegisterMachine::Execute()
+{
+    TRegisterCode* Unit;
+    TObject** Registers;
+    int* Counters;
+    TObject** const* Cells;
+    int VariableCount;
+    TObject* Sites;
+    const TRegisterInstruction* Code;
+    VM_LOAD_ACTIVATION()
+
+    const TRegisterInstruction* Ip = Code;
+    const TRegisterInstruction* Instruction;
+    const TObject MinusOne(-1);
+    TObject Scratch;
+    const int MaxLoop = Runtime::GetContext().MaxLoop;
+
+#if VM_COMPUTED_GOTO
+    // Indexed by opcode; the X-macro keeps it in the same order as ERegisterOp
+    static void* const Labels[] = {
+    #define VM_REGISTER_OPCODE_LABEL(Name) &&Op_##Name,
+        VM_REGISTER_OPCODES(VM_REGISTER_OPCODE_LABEL)
+    #undef VM_REGISTER_OPCODE_LABEL
+    };
+    VM_DISPATCH();
+#else
+    for (;;)
+    {
+        Instruction = Ip++;
+        VM_COUNT()
+        switch (Instruction->Op)
+        {
+#endif
+
+    VM_CASE(Copy)
+    {
+        VM_READ_REGISTER(Value, Instruction->B)
+        TObject& Site = Sites[Instruction - Code];
+        Site = *Value;
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Move)
+    {
+        VM_READ_REGISTER(Value, Instruction->B)
+        Registers[Instruction->A] = Value;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_ARITHMETIC(Add, +)
+    VM_ARITHMETIC(Sub, -)
+    VM_ARITHMETIC(Mul, *)
+
+    VM_CASE(Div)
+    {
+        // Always through the kernel table, which reports division by zero
+        VM_READ_REGISTER(Left, Instruction->B)
+        VM_READ_REGISTER(Right, Instruction->C)
+        TObject& Site = Sites[Instruction - Code];
+        VM_BINARY(EBinaryOp::Div, Site)
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_COMPARISON(Less, <)
+    VM_COMPARISON(Greater, >)
+    VM_COMPARISON(Equal, ==)
+    VM_COMPARISON(NotEqual, !=)
+
+    VM_CASE(Not)
+    {
+        VM_READ_REGISTER(Value, Instruction->B)
+        if (Value->GetType() != BoolType)
+        {
+            VM_ERROR("Operator '!' wants a bool, got '{}'.", Value->ToString())
+        }
+        TObject& Site = Sites[Instruction - Code];
+        Site.SetBool(!Value->RawBool());
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Negate)
+    {
+        VM_READ_REGISTER(Left, Instruction->B)
+        const TObject* Right = &MinusOne;
+        TObject& Site = Sites[Instruction - Code];
+        VM_BINARY(EBinaryOp::Mul, Site)
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(1)
+        VM_DISPATCH();
+    }
+
+    VM_TYPED_ARITHMETIC(AddInt, +, RawInt, SetInt)
+    VM_TYPED_ARITHMETIC(SubInt, -, RawInt, SetInt)
+    VM_TYPED_ARITHMETIC(MulInt, *, RawInt, SetInt)
+
+    VM_CASE(DivInt)
+    {
+        const int Dividend = Registers[Instruction->B]->RawInt();
+        const int Divisor = Registers[Instruction->C]->RawInt();
+        if (!CanDivide(Dividend, Divisor))
+        {
+            return false;
+        }
+        TObject& Site = Sites[Instruction - Code];
+        Site.SetInt(Dividend / Divisor);
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(3)
+        VM_DISPATCH();
+    }
+
+    VM_TYPED_ARITHMETIC(AddFloat, +, RawFloat, SetFloat)
+    VM_TYPED_ARITHMETIC(SubFloat, -, RawFloat, SetFloat)
+    VM_TYPED_ARITHMETIC(MulFloat, *, RawFloat, SetFloat)
+    VM_TYPED_ARITHMETIC(DivFloat, /, RawFloat, SetFloat)
+
+    VM_CASE(NegateInt)
+    {
+        TObject& Site = Sites[Instruction - Code];
+        Site.SetInt(-Registers[Instruction->B]->RawInt());
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(NegateFloat)
+    {
+        TObject& Site = Sites[Instruction - Code];
+        Site.SetFloat(-Registers[Instruction->B]->RawFloat());
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Jump)
+    {
+        Ip = Code + Instruction->A;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(JumpIfFalse)
+    {
+        VM_READ_REGISTER(Value, Instruction->A)
+        if (Value->GetType() != BoolType)
+        {
+            VM_ERROR("Condition is not a bool: '{}'.", Value->ToString())
+        }
+        if (!Value->RawBool())
+        {
+            Ip = Code + Instruction->B;
+        }
+        VM_DISPATCH();
+    }
+
+    VM_COMPARE_AND_BRANCH(JumpUnlessLess, <, EBinaryOp::Less, VM_READ_REGISTER)
+    VM_COMPARE_AND_BRANCH(JumpUnlessGreater, >, EBinaryOp::Greater, VM_READ_REGISTER)
+    VM_COMPARE_AND_BRANCH(JumpUnlessEqual, ==, EBinaryOp::Equal, VM_READ_REGISTER)
+    VM_COMPARE_AND_BRANCH(JumpUnlessNotEqual, !=, EBinaryOp::NotEqual, VM_READ_REGISTER)
+    VM_TYPED_BRANCH(JumpUnlessLessInt, <, RawInt)
+    VM_TYPED_BRANCH(JumpUnlessGreaterInt, >, RawInt)
+    VM_TYPED_BRANCH(JumpUnlessEqualInt, ==, RawInt)
+    VM_TYPED_BRANCH(JumpUnlessNotEqualInt, !=, RawInt)
+    VM_TYPED_BRANCH(JumpUnlessLessFloat, <, RawFloat)
+    VM_TYPED_BRANCH(JumpUnlessGreaterFloat, >, RawFloat)
+    VM_TYPED_BRANCH(JumpUnlessEqualFloat, ==, RawFloat)
+    VM_TYPED_BRANCH(JumpUnlessNotEqualFloat, !=, RawFloat)
+
+    VM_CASE(LoopEnter)
+    {
+        Counters[Instruction->A] = 1;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(LoopBack)
+    {
+        if (++Counters[Instruction->A] == MaxLoop)
+        {
+            VM_ERROR("ERROR: Hit max loop count ({}).", MaxLoop)
+        }
+        Ip = Code + Instruction->B;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(LoadIndex)
+    {
+        VM_READ_REGISTER(Container, Instruction->B)
+        VM_READ_REGISTER(Index, Instruction->C)
+        if (Index->GetType() != IntType)
+        {
+            VM_ERROR("Index must be an int, got '{}'.", Index->ToString())
+        }
+        TObject& Site = Sites[Instruction - Code];
+        const TObject* Element;
+        switch (Container->GetType())
+        {
+        case StringType :
+            Site = Container->At(*Index);
+            break;
+        case ArrayType :
+            Element = Container->AsArray()->At(Index->RawInt());
+            if (!Element)
+            {
+                VM_ERROR("Index {} is out of range.", Index->RawInt())
+            }
+            Site = *Element;
+            break;
+        default :
+            VM_ERROR("Invalid identifier type.")
+        }
+        Registers[Instruction->A] = &Site;
+        VM_MOVES(2)
+        VM_DISPATCH();
+    }
+
+    VM_CHECK(CheckArgument, "Argument '{}' of '{}' must be {}, got '{}'.", Unit->Names[Instruction->A],
+             Unit->Signatures[Instruction->C]->Name, GetTypeName(Type), Got)
+    VM_CHECK(CheckResult, "'{}' must return {}, got '{}'.", Unit->Signatures[Instruction->C]->Name,
+             GetTypeName(Type), Got)
+    VM_CHECK(CheckAssignment, "'{}' is declared {}, cannot assign '{}'.", Unit->Names[Instruction->A],
+             GetTypeName(Type), Got)
+
+    VM_CASE(Eval)
+    {
+        // The tree walker pushes to the frame's stack; take its value and drop anything else
+        VM_WRITE_BACK()
+        Frame* CurrentFrame = Interpreter->CurrentFrame;
+        const size_t Depth = CurrentFrame->Stack.size();
+        Unit->Nodes[Instruction->B]->Accept(Interpreter);
+        if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)
+        {
+            return false;
+        }
+        const TObject* Value = CurrentFrame->Stack.size() > Depth ? CurrentFrame->Stack.back() : nullptr;
+        CurrentFrame->Stack.resize(Depth);
+        VM_RELOAD()
+        VM_SET_RESULT(Value)
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Call)
+    {
+        VM_BEGIN_CALL(Callee)
+        if (!Enter(Callee, Ip))
+        {
+            return false;
+        }
+        VM_LOAD_ACTIVATION()
+        Ip = Code;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(TailCall)
+    {
+        // The callee replaces the current activation, so a tail-recursive loop runs in constant memory
+        VM_BEGIN_CALL(Callee)
+        const TActivation Current = CallStack.back();
+        CallStack.pop_back();
+        RegisterStack.resize(Current.RegisterBase);
+        CounterStack.resize(Current.CounterBase);
+        if (!Enter(Callee, Current.ReturnIp))
+        {
+            return false;
+        }
+        VM_LOAD_ACTIVATION()
+        Ip = Code;
+        VM_DISPATCH();
+    }
+
+    VM_CASE(Return)
+    {
+        VM_WRITE_BACK()
+        const TObject* Value = Registers[Instruction->A];
+        VM_MOVES(1)
+        const TActivation Finished = CallStack.back();
+        CallStack.pop_back();
+        if (CallStack.empty())
+        {
+            return true;
+        }
+        RegisterStack.resize(Finished.RegisterBase);
+        CounterStack.resize(Finished.CounterBase);
+
+        // Finish the caller's call instruction
+        VM_LOAD_ACTIVATION()
+        Ip = Finished.ReturnIp;
+        Instruction = Ip - 1;
+        VM_RELOAD()
+        VM_SET_RESULT(Value)
+        VM_DISPATCH();
+    }
+
+#if !VM_COMPUTED_GOTO
+        default :
+            VM_ERROR("Invalid opcode {}.", static_cast<int>(Instruction->Op))
+        }
+    }
+#endif
+}
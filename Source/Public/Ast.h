@@ -9,6 +9,8 @@
 #include <format>
 
 #include "BuiltIns.h"
+#include "Context.h"
+#include "Jit.h"
 #include "Logging.h"
 #include "Token.h"
 #include "Value.h"
@@ -17,7 +19,7 @@ using namespace Core;
 using namespace Values;
 
 #define CHECK_ERRORS                                                             \
-    if (Logging::Logger::GetInstance()->GetCount(Logging::LogLevel::Error) > 0) \
+    if (Logging::GetLogger()->GetCount(Logging::LogLevel::Error) > 0)            \
     {                                                                            \
         DEBUG_EXIT                                                               \
         return false;                                                            \
@@ -30,11 +32,6 @@ using namespace Values;
         return false;      \
     }
 
-static int WHILE_MAX_LOOP = 100000;
-static int LINE;
-static int COLUMN;
-static std::string SOURCE;
-
 class Visitor;
 
 class AstNode;
@@ -56,20 +53,120 @@ enum ECallType
     IndexOf
 };
 
-static TFunctionMap FUNCTION_MAP = BuiltIns::InitFunctionMap();
+static EBinaryOp GetBinaryOp(const ETokenType Op)
+{
+    switch (Op)
+    {
+    case Plus :
+    case PlusEquals :
+        return EBinaryOp::Add;
+    case Minus :
+    case MinusEquals :
+        return EBinaryOp::Sub;
+    case Multiply :
+    case MultEquals :
+        return EBinaryOp::Mul;
+    case Divide :
+    case DivEquals :
+        return EBinaryOp::Div;
+    case LessThan :
+        return EBinaryOp::Less;
+    case GreaterThan :
+        return EBinaryOp::Greater;
+    case Equals :
+        return EBinaryOp::Equal;
+    case NotEquals :
+        return EBinaryOp::NotEqual;
+    default :
+        return EBinaryOp::Count;
+    }
+}
+
+/// <summary>
+/// The state of a self-specializing binary operator node. On its first execution the node records its operand types;
+/// if they are two ints, two floats or two strings it caches the kernel for that pair and skips the dispatch table
+/// from then on. If it later sees different types it falls back to the generic path for good. Nodes whose operand
+/// types type inference proved run their proven kernel instead, without checking the operands at all.
+/// </summary>
+enum class EQuickenState
+{
+    Uninitialized,
+    Quickened,
+    Generic,
+};
+
+// Counts of binary operator sites which were quickened and later deoptimized
+struct TQuickenStats
+{
+    int Quickened = 0;
+    int Deoptimized = 0;
+};
+
+// Whether a while loop or function has been compiled by the JIT
+enum class EJitState
+{
+    Cold,
+    Compiled,
+    Rejected,
+};
 
 static bool IsBuiltIn(const std::string& Name);
 
 static std::string FormatSource();
 
+struct Frame;
+
+// A name resolved to its slot in a frame before the program runs, so reading or writing it skips the lookup. A frame
+// numbers its slots in the order names are bound, so the binding holds in every frame which bound the same names in
+// the same order, as each execution of a compiled program does. A default binding, or one whose slot holds another
+// name in this frame, falls back to looking the name up.
+struct TBinding
+{
+    int Slot = -1;
+};
+
 struct Frame
 {
     std::vector<TObject*> Stack;
     std::map<std::string, TObject*> Identifiers;
+    std::map<std::string, int> SlotNumbers; // The slot of each name bound
+    std::vector<std::string> SlotNames;     // The name of each slot
+    std::vector<TObject**> Slots;           // The entry in Identifiers of each slot
 
     Frame* Outer = nullptr;
     Frame* Inner;
 
+    Frame() = default;
+
+    // A copy has slots of its own, pointing at its own entries
+    Frame(const Frame& Other)
+        : Stack(Other.Stack)
+          , Identifiers(Other.Identifiers)
+          , SlotNumbers(Other.SlotNumbers)
+          , SlotNames(Other.SlotNames)
+          , Outer(Other.Outer)
+          , Inner(Other.Inner)
+    {
+        Slots.reserve(SlotNames.size());
+        for (const std::string& Name : SlotNames)
+        {
+            Slots.push_back(&Identifiers[Name]);
+        }
+    }
+
+    Frame& operator=(const Frame& Other)
+    {
+        if (this != &Other)
+        {
+            Frame Copy(Other);
+            std::swap(*this, Copy);
+        }
+        return *this;
+    }
+
+    Frame(Frame&& Other) noexcept = default;
+    Frame& operator=(Frame&& Other) noexcept = default;
+
     Frame* CreateInnerFrame()
     {
         Inner = new Frame();
@@ -96,6 +193,38 @@ struct Frame
         return nullptr;
     }
 
+    // The entry of a binding's slot, or null if the binding is unset or its slot holds another name
+    TObject** FindSlot(const TBinding& Binding, const std::string& Name)
+    {
+        if (static_cast<size_t>(Binding.Slot) < Slots.size() && SlotNames[Binding.Slot] == Name)
+        {
+            return Slots[Binding.Slot];
+        }
+        return nullptr;
+    }
+
+    TObject* GetIdentifier(const TBinding& Binding, const std::string& Name)
+    {
+        TObject** Slot = FindSlot(Binding, Name);
+        return Slot != nullptr ? *Slot : GetIdentifier(Name);
+    }
+
+    // Binds a name to a slot for its entry in this frame, adding an unset entry if there is none. Entries are never
+    // removed, so the binding lasts as long as the frame.
+    TBinding Bind(const std::string& Name)
+    {
+        const auto [It, bAdded] = SlotNumbers.try_emplace(Name, static_cast<int>(Slots.size()));
+        if (bAdded)
+        {
+            SlotNames.push_back(Name);
+            Slots.push_back(&Identifiers[Name]);
+        }
+        return {It->second};
+    }
+
+    // The names bound, in slot order
+    const std::vector<std::string>& GetSlotNames() const { return SlotNames; }
+
     bool IsIdentifier(const std::string& Name)
     {
         const TObject* Ident = GetIdentifier(Name);
@@ -109,6 +238,16 @@ struct Frame
         DEBUG_EXIT
     }
 
+    void SetIdentifier(const TBinding& Binding, const std::string& Name, TObject* Value)
+    {
+        if (TObject** Slot = FindSlot(Binding, Name))
+        {
+            *Slot = Value;
+            return;
+        }
+        SetIdentifier(Name, Value);
+    }
+
     int Push(TObject* Value)
     {
         DEBUG_ENTER
@@ -157,13 +296,110 @@ struct Frame
     }
 };
 
+// The kinds of node which keep state while they run. Nodes of each kind are numbered separately.
+enum class ENodeState
+{
+    Identifier,
+    Unary,
+    BinOp,
+    Assignment,
+    Call,
+    Jit, // While loops and functions
+};
+
+// The state a binary operator keeps between evaluations
+struct TBinOpState
+{
+    TObject Result; // Storage for the result, reused by every evaluation of the node
+    EQuickenState QuickenState = EQuickenState::Uninitialized;
+    EValueType QuickenedType = NullType; // The type of both operands when quickened
+    TBinaryKernel QuickenedKernel = nullptr;
+};
+
+// The state a call keeps between evaluations
+struct TCallState
+{
+    TObject Value; // Storage for the element read by the subscript operator, or the result of a built-in
+
+    // The argument values of the running call, filled in place each time so a call allocates nothing once warm
+    std::vector<TObject*> ArgValues;
+    std::vector<TObject> ArgCopies; // Copies of literal arguments, which a callee may change
+
+    // The user function the call ran first. Functions cannot be redefined, so the call keeps running it.
+    AstFunction* Function = nullptr;
+};
+
+// The JIT state of a while loop or function
+struct TJitState
+{
+    int HitCount = 0; // Iterations of a loop, over every run of it, or calls of a function interpreted
+    EJitState State = EJitState::Cold;
+    Jit::TRegion* Region = nullptr;
+};
+
+/// <summary>
+/// The state an interpreter keeps for the nodes of one kind, by their number. The table grows as nodes first run, a
+/// page at a time, so growing it leaves the values the frame points at in place.
+/// </summary>
+template <typename T>
+class TNodeTable
+{
+    static constexpr int PAGE_BITS = 6;
+    static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+
+    std::vector<std::unique_ptr<T[]>> Pages;
+
+    void Grow(size_t Page)
+    {
+        while (Page >= Pages.size())
+        {
+            Pages.push_back(std::make_unique<T[]>(PAGE_SIZE));
+        }
+    }
+
+public:
+    T& operator[](int Slot)
+    {
+        const size_t Page = static_cast<size_t>(Slot) >> PAGE_BITS;
+        if (Page >= Pages.size()) [[unlikely]]
+        {
+            Grow(Page);
+        }
+        return Pages[Page][Slot & (PAGE_SIZE - 1)];
+    }
+};
+
+/// <summary>
+/// What an interpreter keeps for the nodes it runs, so running a tree never changes it and any number of interpreters
+/// may share one. A node which keeps state is numbered among the nodes of its kind when it is made, and its state is
+/// the entry at that number in the table for its kind.
+/// </summary>
+struct TNodeStates
+{
+    TNodeTable<TObject> Identifiers; // The value each variable read had
+    TNodeTable<TObject> Unaries;     // Storage for the result
+    TNodeTable<TBinOpState> BinOps;
+    TNodeTable<TObject> Assignments; // Storage for a literal, so changing the variable leaves the tree as written
+    TNodeTable<TCallState> Calls;
+    TNodeTable<TJitState> Jit;
+};
+
+/// <summary>
+/// Runs trees. A visitor keeps the state of the nodes it ran itself, so visitors on different threads may share a
+/// tree, but the trees one visitor runs must all be made in the same context, since nodes are numbered per context.
+/// </summary>
 class Visitor
 {
     bool IsFunctionDeclared(const std::string& Name);
     AstFunction* GetFunction(const std::string& Name);
+    void Quicken(TBinOpState& State, EBinaryOp Op, EValueType LeftType, EValueType RightType);
+    bool RunJit(Jit::TRegion* Region, int Count, bool& bEntered);
 
 public:
     std::map<std::string, AstFunction*> Functions;
+    TQuickenStats QuickenStats;
+    std::unique_ptr<Jit::TJit> JitCompiler; // Null unless the JIT is enabled
+    TNodeStates States;
 
     int FrameDepth = 0;
     Frame RootFrame;
@@ -189,23 +425,43 @@ public:
         Frames = Other.Frames;
     }
     bool Visit(AstValue* Node) const;
-    bool Visit(AstIdentifier* Node) const;
-    bool Visit(const AstUnaryExpr* Node);
+    bool Visit(AstIdentifier* Node);
+    bool Visit(AstUnaryExpr* Node);
     bool Visit(AstBinOp* Node);
     bool Visit(AstAssignment* Node);
     bool Visit(AstCall* Node);
     bool Visit(AstIf* Node);
-    bool Visit(const AstWhile* Node);
+    bool Visit(AstWhile* Node);
     bool Visit(AstFunction* Node);
     bool Visit(const AstReturn* Node);
     bool Visit(const AstBody* Node);
     void Dump() const;
+
+    /// <summary>
+    /// Runs a user function, binding its parameters to the argument values in place, and leaves its result on the
+    /// stack.
+    /// </summary>
+    /// <param name="Func">The function, which must take as many arguments as there are values.</param>
+    /// <param name="Arguments">The argument values.</param>
+    /// <returns>False if an argument or the result has the wrong type, or the body failed.</returns>
+    bool CallFunction(AstFunction* Func, const std::vector<TObject*>& Arguments);
 };
 
-// Base AST Node class
+// Base AST Node class. Nodes are made with new and belong to the context current when they were made.
 class AstNode
 {
+protected:
+    AstNode() { Runtime::GetContext().Nodes.Add(this); }
+
+    // Numbers a node which keeps state while it runs among the nodes of its kind, for TNodeStates
+    static int NumberState(ENodeState Kind)
+    {
+        return Runtime::GetContext().Nodes.Number(static_cast<size_t>(Kind));
+    }
+
 public:
+    AstNode(const AstNode&) = delete;
+    AstNode& operator=(const AstNode&) = delete;
     virtual ~AstNode() = default;
     virtual bool Accept(Visitor* V) = 0;
 
@@ -291,15 +547,17 @@ class AstIdentifier : public AstNode
 {
 public:
     std::string Name;
-    TObject Value;
     Token Context;
+    TBinding Binding; // Set by the resolver
+    int Slot;         // Where the value read is kept; see TNodeStates
 
     AstIdentifier(const std::string& InName, const Token& InContext)
         : Name(InName)
           , Context(InContext)
+          , Slot(NumberState(ENodeState::Identifier))
     {
     }
-    std::string ToString() const override { return "Variable: " + Name + ", " + Value.ToString(); }
+    std::string ToString() const override { return "Variable: " + Name; }
     bool Accept(Visitor* V) override { return V->Visit(this); }
     Token GetContext() const override { return Context; }
 };
@@ -310,16 +568,19 @@ public:
     ETokenType Op;
     AstNode* Right = nullptr;
     Token Context;
+    EValueType ProvenType = NullType; // The operand's type if type inference proved it, otherwise null
+    int Slot;                         // Where the result is kept; see TNodeStates
 
     AstUnaryExpr(ETokenType InOp, AstNode* InRight, const Token& InContext)
         : Op(InOp)
           , Right(InRight)
           , Context(InContext)
+          , Slot(NumberState(ENodeState::Unary))
     {
     }
     std::string ToString() const override
     {
-        return std::format("UnaryExpr: {}{}", TokenToStringMap[Op], Right->ToString());
+        return std::format("UnaryExpr: {}{}", GetTokenString(Op), Right->ToString());
     }
     bool Accept(Visitor* V) override { return V->Visit(this); }
     Token GetContext() const override { return Context; }
@@ -334,12 +595,18 @@ public:
     AstNode* Left = nullptr;
     AstNode* Right = nullptr;
     ETokenType Op = Invalid;
+    EBinaryOp BinaryOp = EBinaryOp::Count;
+    int Slot; // Where the result and type feedback are kept; see TNodeStates
+
+    TBinaryKernel ProvenKernel = nullptr; // The kernel for the operand types if type inference proved them
 
     AstBinOp(AstNode* InLeft, AstNode* InRight, const ETokenType& InOp, const Token& InContext)
         : Context(InContext)
           , Left(InLeft)
           , Right(InRight)
           , Op(InOp)
+          , BinaryOp(GetBinaryOp(InOp))
+          , Slot(NumberState(ENodeState::BinOp))
     {
     }
     std::string ToString() const override
@@ -358,11 +625,15 @@ public:
     std::string Name;
     AstNode* Right;
     Token Context;
+    EValueType Annotation = Void; // The type written after the name, which the value must have, or Void
+    TBinding Binding;             // Set by the resolver
+    int Slot;                     // Where a copy of a literal assigned is kept; see TNodeStates
 
     AstAssignment(const std::string& InName, AstNode* InRight, const Token& InContext)
         : Name(InName)
           , Right(InRight)
           , Context(InContext)
+          , Slot(NumberState(ENodeState::Assignment))
     {
     }
     std::string ToString() const override { return "Assign: " + Name + " => {" + Right->ToString() + "}"; }
@@ -378,12 +649,20 @@ public:
     ECallType Type;
     std::vector<AstNode*> Args;
     Token Context;
+    int Slot; // Where the result and argument values are kept; see TNodeStates
+
+    // Set by the resolver: the subscripted variable, or the built-in called. A user function is only known once the
+    // call first runs it, unless it was defined before the program.
+    TBinding Binding;
+    const TFunction* BuiltIn = nullptr;
+    AstFunction* Function = nullptr;
 
     AstCall(const std::string& InIdentifier, const ECallType InType, const std::vector<AstNode*>& InArgs, const Token& InContext)
         : Identifier(InIdentifier)
           , Type(InType)
           , Args(InArgs)
           , Context(InContext)
+          , Slot(NumberState(ENodeState::Call))
     {
     }
     std::string ToString() const override { return "Call"; }
@@ -418,11 +697,13 @@ public:
     AstNode* Cond = nullptr;
     AstNode* Body = nullptr;
     Token Context;
+    int Slot; // Where the JIT state is kept; see TNodeStates
 
     AstWhile(AstNode* InCond, AstNode* InBody, const Token& InContext)
         : Cond(InCond)
           , Body(InBody)
           , Context(InContext)
+          , Slot(NumberState(ENodeState::Jit))
     {
     }
     std::string ToString() const override { return "While"; }
@@ -438,11 +719,20 @@ public:
     AstNode* Body = nullptr;
     Token Context;
 
+    // Type annotations, checked when the function is called and when it returns. Void where there is none.
+    std::vector<EValueType> ArgTypes; // Parallel to Args
+    EValueType ReturnType = Void;
+    std::vector<TBinding> ArgBindings; // Parallel to Args, set by the resolver
+    int Slot;                          // Where the JIT state is kept; see TNodeStates
+
     AstFunction(const std::string& InName, const std::vector<std::string>& InArgs, AstNode* InBody, const Token& InContext)
         : Name(InName)
           , Args(InArgs)
           , Body(InBody)
           , Context(InContext)
+          , ArgTypes(InArgs.size(), Void)
+          , ArgBindings(InArgs.size())
+          , Slot(NumberState(ENodeState::Jit))
     {
     }
     std::string ToString() const override { return "FunctionDecl"; }
@@ -507,6 +797,7 @@ class Ast
         {"bool", BoolType},
         {"int", IntType},
         {"float", FloatType},
+        {"string", StringType},
     };
 
     void PrintCurrentToken() const;
@@ -538,18 +829,19 @@ class Ast
             CurrentToken++;
             Position++;
 
+            Runtime::TContext& Current = Runtime::GetContext();
             if (CurrentToken != nullptr)
             {
                 const Token C = *CurrentToken;
-                LINE = C.Line;
-                COLUMN = C.Column;
-                SOURCE = C.Source;
+                Current.Line = C.Line;
+                Current.Column = C.Column;
+                Current.Source = C.Source;
             }
             else
             {
-                LINE = 0;
-                COLUMN = 0;
-                SOURCE = "eof";
+                Current.Line = 0;
+                Current.Column = 0;
+                Current.Source = "eof";
             }
         }
     }
@@ -619,6 +911,7 @@ class Ast
     AstNode* ParseMultiplicativeExpr();
     AstNode* ParseAdditiveExpr();
     AstNode* ParseEqualityExpr();
+    EValueType ParseType();
     AstNode* ParseAssignment();
     AstNode* ParseParenExpr();
     AstNode* ParseBracketExpr();
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Tasks.h"
+
+namespace Io
+{
+    enum class EBackend
+    {
+        Uring,   // io_uring, on Linux kernels which allow it
+        Threads, // A pool of threads making blocking calls
+    };
+
+    enum class EOperation
+    {
+        Read,
+        Write,
+    };
+
+    /// <summary>
+    /// A read or write of a whole file, in flight until bDone is set.
+    /// </summary>
+    struct TRequest
+    {
+        EOperation Operation;
+        std::string Path;
+        std::string Data; // What to write, or what was read
+        size_t Done = 0;  // Bytes read or written so far
+        int File = -1;
+        std::string Error; // Why the request failed, if it did
+        std::atomic<bool> bDone = false;
+    };
+
+    class TUring;
+
+    /// <summary>
+    /// Reads and writes whole files in the background, so a script can start loading many files and compute while
+    /// the operating system works through them.
+    /// <para>
+    /// On Linux, requests go through an io_uring: the calling thread opens the file and queues one read or write of
+    /// all of it, and a completion thread finishes requests as the kernel reports them, queueing the rest of any short
+    /// transfer. Elsewhere, or where io_uring is unavailable, a small pool of threads makes blocking calls instead.
+    /// </para>
+    /// <para>
+    /// Requests are identified by int handles, which stay valid until they are awaited.
+    /// </para>
+    /// </summary>
+    class TAsyncIo
+    {
+        EBackend Backend;
+        std::unique_ptr<TUring> Uring;
+
+        std::mutex RequestsMutex;
+        std::unordered_map<int, std::unique_ptr<TRequest>> Requests;
+        int NextHandle = 0;
+
+        Tasks::TWaitList Finished; // What awaiting tasks and threads wait on
+
+        // The fallback pool, started with the first request which needs it
+        std::mutex PoolMutex;
+        std::condition_variable PoolSignal;
+        std::deque<TRequest*> Pending;
+        std::vector<std::thread> Pool;
+        bool bStopping = false;
+
+        void Submit(TRequest* Request);
+        void RunPool();
+        static void Transfer(TRequest& Request);
+
+    public:
+        explicit TAsyncIo(EBackend Preferred);
+        ~TAsyncIo();
+        TAsyncIo(const TAsyncIo&) = delete;
+        TAsyncIo& operator=(const TAsyncIo&) = delete;
+
+        /// <summary>
+        /// Starts reading a file.
+        /// </summary>
+        /// <returns>The request's handle.</returns>
+        int Read(const std::string& Path);
+
+        /// <summary>
+        /// Starts replacing a file's contents with a copy of the data.
+        /// </summary>
+        /// <returns>The request's handle.</returns>
+        int Write(const std::string& Path, const std::string& Data);
+
+        /// <summary>
+        /// Waits for a request to finish, then releases its handle. A task waiting is suspended meanwhile, so its
+        /// worker runs other tasks.
+        /// </summary>
+        /// <returns>The request, or null if there is no such handle.</returns>
+        std::unique_ptr<TRequest> Await(int Handle);
+
+        /// <summary>
+        /// Called by the backends once a request has finished.
+        /// </summary>
+        void Finish(TRequest* Request);
+
+        EBackend GetBackend() const { return Backend; }
+    };
+
+    /// <summary>
+    /// Chooses the backend of the process's TAsyncIo, which only takes effect before GetAsyncIo is first called.
+    /// </summary>
+    void SetBackend(EBackend Backend);
+
+    /// <summary>
+    /// The process's TAsyncIo, created on the first call.
+    /// </summary>
+    TAsyncIo& GetAsyncIo();
+} // namespace Io
@@ -1,26 +1,87 @@
 #pragma once
 
-#include "Value.h"
+#include <map>
+
+#include "Function.h"
 
 using namespace Values;
 
-using TFunctionMap = std::map<std::string, TFunction>;
+/// <summary>
+/// The built-in functions by name.
+/// </summary>
+class TFunctionMap : public std::map<std::string, TFunction>
+{
+public:
+    /// <summary>
+    /// Adds a built-in, replacing any of the same name. Its parameter and result types decide how arguments are
+    /// checked and unpacked, at compile time; see TFunction.
+    /// </summary>
+    /// <param name="Name">The name scripts call it by.</param>
+    /// <param name="Function">The function, or a lambda without captures prefixed with '+'.</param>
+    /// <param name="Purity">What it may do besides computing its result.</param>
+    template <typename TResult, typename... TParams>
+    void Register(const std::string& Name, TResult (*Function)(TParams...), EPurity Purity = EPurity::Pure)
+    {
+        insert_or_assign(Name, TFunction(Name, Function, Purity));
+    }
+};
 
 namespace BuiltIns
 {
     // Forward declaration of all built-in functions
 
     // IO
-    static void Print_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
-    static void Printf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
-    static void ReadFile_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
+    void Print(const TObject& Value);
+    std::optional<TObject> Printf(const std::string& Format, TArgumentList Values);
+    void Flush();
+    std::optional<std::string> ReadFile(const std::string& FileName);
+    int ReadAsync(const std::string& FileName);
+    int WriteAsync(const std::string& FileName, const std::string& Text);
+    std::optional<TObject> Await(int Handle);
+    std::optional<TObject> OpenFile(const std::string& FileName);
+    bool NextLine(const TFileValue& File, TObject& Line);
+    void CloseFile(const TFileValue& File);
 
     // Containers
-    static void IndexOf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
-    static void SizeOf_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
-    static void Append_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
-    static void Contains_Internal(TArguments* Arguments, TObject* ReturnValue, bool& bResult);
+    std::optional<TObject> IndexOf(const TObject& Container, int Index);
+    std::optional<int> SizeOf(const TObject& Container);
+    void Append(TArrayValue& Array, const TObject& Value);
+    std::optional<bool> Contains(const TObject& Container, const TObject& Value);
+    std::optional<TObject> Range(int Count);
+
+    // Arrays (SIMD)
+    std::optional<TObject> VecAdd(const TObject& Left, const TObject& Right);
+    std::optional<TObject> VecSub(const TObject& Left, const TObject& Right);
+    std::optional<TObject> VecMul(const TObject& Left, const TObject& Right);
+    std::optional<TObject> VecDiv(const TObject& Left, const TObject& Right);
+    std::optional<TObject> Sum(const TObject& Array);
+    std::optional<TObject> Min(const TObject& Array);
+    std::optional<TObject> Max(const TObject& Array);
+    std::optional<TObject> Dot(const TObject& Left, const TObject& Right);
+    std::optional<TObject> PrefixSum(const TObject& Array);
+
+    // Time
+    float Clock();
+
+    // Tasks
+    std::optional<int> Spawn(const std::string& Function, TArgumentList Arguments);
+    std::optional<TObject> Join(int Handle);
+    std::optional<TObject> ParMap(const std::string& Function, const TArrayValue& Array);
+    std::optional<TObject> ParFilter(const std::string& Function, const TArrayValue& Array);
+    std::optional<TObject> ParReduce(const std::string& Function, const TArrayValue& Array, const TObject& Initial);
+
+    // Channels
+    std::optional<TObject> Channel(int Capacity);
+    bool Send(const TChannelValue& Channel, const TObject& Value);
+    bool Receive(const TChannelValue& Channel, TObject& Value);
+    void Close(const TChannelValue& Channel);
 
     // Initialize the function map of keywords to actual C++ functions
     TFunctionMap InitFunctionMap();
+
+    /// <summary>
+    /// Gets the built-ins every context calls, which InitFunctionMap makes the first time they are needed. A host adds
+    /// its own before any interpreter starts; after that the map never changes, so every thread shares it.
+    /// </summary>
+    TFunctionMap& GetFunctionMap();
 } // namespace BuiltIns
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Value.h"
+
+class AstNode;
+class AstFunction;
+
+namespace Vm
+{
+    // Operands A, B and C are indices. Cells are variable bindings or constants; sites are result storage owned by the
+    // chunk. The instructions after Eval are superinstructions fusing the most common sequences.
+#define VM_OPCODES(X)                                                                                          \
+    X(Load)               /* Push the value of cell A */                                                       \
+    X(Store)              /* Pop a value, copy it into site B and bind cell A to it */                         \
+    X(Pop)                /* Discard the top of the stack */                                                   \
+    X(Binary)             /* Pop the right then left operand, push left (op A) right computed into site B */   \
+    X(Not)                /* Pop a bool, push its negation computed into site A */                             \
+    X(Negate)             /* Pop a number, push it multiplied by -1 computed into site A */                    \
+    X(Jump)               /* Jump to instruction A */                                                          \
+    X(JumpIfFalse)        /* Pop a bool, jump to instruction A if it is false */                               \
+    X(LoopEnter)          /* Set loop counter A to 1 */                                                        \
+    X(LoopBack)           /* Increment loop counter A, failing at the loop limit, and jump to instruction B */ \
+    X(Eval)               /* Run node A with the tree walker, pushing its value if B is set */                 \
+    X(AddConst)           /* x += c: bind cell A to its value plus constant cell B, computed into site C */    \
+    X(JumpUnlessLess)     /* while (x < y): jump to instruction C unless cell A < cell B */                    \
+    X(JumpUnlessGreater)  /* Jump to instruction C unless cell A > cell B */                                   \
+    X(JumpUnlessEqual)    /* Jump to instruction C unless cell A == cell B */                                  \
+    X(JumpUnlessNotEqual) /* Jump to instruction C unless cell A != cell B */                                  \
+    X(LoadIndex)          /* x[i]: push element cell B of cell A, copied into site C */                        \
+    X(Halt)               /* Stop executing */
+
+    enum class EOpCode : uint8_t
+    {
+#define VM_OPCODE_ENUM(Name) Name,
+        VM_OPCODES(VM_OPCODE_ENUM)
+#undef VM_OPCODE_ENUM
+        Count
+    };
+
+    struct TInstruction
+    {
+        EOpCode Op = EOpCode::Halt;
+        int32_t A = 0;
+        int32_t B = 0;
+        int32_t C = 0;
+    };
+
+    /// <summary>
+    /// A compiled program.
+    /// <para>
+    /// Variables are not copied into the chunk: each variable cell points at the binding in the frame's identifier
+    /// table, so code run by the tree-walking interpreter and code run by the VM always see the same variables. As in
+    /// the tree, an assignment binds its variable to storage owned by the assignment, here a site in the chunk.
+    /// </para>
+    /// </summary>
+    struct TChunk
+    {
+        std::vector<TInstruction> Code;
+        std::vector<Values::TObject**> Cells;
+        std::vector<std::string> CellNames;     // Parallel to Cells, empty for constants
+        std::deque<Values::TObject*> Constants; // Constant cells point here; a deque keeps the addresses stable
+        std::vector<Values::TObject> Sites;
+        std::vector<AstNode*> Nodes;           // Nodes run by Eval
+        int LoopCount = 0;                     // Number of loop counters
+        int MaxStackDepth = 0;
+    };
+
+    // Register machine instructions. Operands are register indices unless they name an instruction, node, call site
+    // or type. Every instruction which produces a value computes it into its own site, the one with the instruction's
+    // index, and points its destination register at it. The arithmetic and comparison instructions are in EBinaryOp
+    // order, as are the typed versions, which the compiler only emits for operands whose types it proved and which
+    // neither check nor dispatch on them.
+#define VM_REGISTER_OPCODES(X)                                                                                      \
+    X(Copy)                    /* Copy register B into the site and point register A at it */                       \
+    X(Move)                    /* Point register A at B's value, binding it by reference as a parameter is */       \
+    X(Add)                     /* Point register A at B + C */                                                      \
+    X(Sub)                     /* Point register A at B - C */                                                      \
+    X(Mul)                     /* Point register A at B * C */                                                      \
+    X(Div)                     /* Point register A at B / C */                                                      \
+    X(Less)                    /* Point register A at B < C */                                                      \
+    X(Greater)                 /* Point register A at B > C */                                                      \
+    X(Equal)                   /* Point register A at B == C */                                                     \
+    X(NotEqual)                /* Point register A at B != C */                                                     \
+    X(Not)                     /* Point register A at the negation of bool B */                                     \
+    X(Negate)                  /* Point register A at B multiplied by -1 */                                         \
+    X(AddInt)                  /* Point register A at int B + int C */                                              \
+    X(SubInt)                  /* Point register A at int B - int C */                                              \
+    X(MulInt)                  /* Point register A at int B * int C */                                              \
+    X(DivInt)                  /* Point register A at int B / int C, failing if C is zero */                        \
+    X(AddFloat)                /* Point register A at float B + float C */                                          \
+    X(SubFloat)                /* Point register A at float B - float C */                                          \
+    X(MulFloat)                /* Point register A at float B * float C */                                          \
+    X(DivFloat)                /* Point register A at float B / float C */                                          \
+    X(NegateInt)               /* Point register A at -B for an int B */                                            \
+    X(NegateFloat)             /* Point register A at -B for a float B */                                           \
+    X(Jump)                    /* Jump to instruction A */                                                          \
+    X(JumpIfFalse)             /* Jump to instruction B if bool A is false */                                       \
+    X(JumpUnlessLess)          /* Jump to instruction C unless A < B */                                             \
+    X(JumpUnlessGreater)       /* Jump to instruction C unless A > B */                                             \
+    X(JumpUnlessEqual)         /* Jump to instruction C unless A == B */                                            \
+    X(JumpUnlessNotEqual)      /* Jump to instruction C unless A != B */                                            \
+    X(JumpUnlessLessInt)       /* Jump to instruction C unless int A < int B */                                     \
+    X(JumpUnlessGreaterInt)    /* Jump to instruction C unless int A > int B */                                     \
+    X(JumpUnlessEqualInt)      /* Jump to instruction C unless int A == int B */                                    \
+    X(JumpUnlessNotEqualInt)   /* Jump to instruction C unless int A != int B */                                    \
+    X(JumpUnlessLessFloat)     /* Jump to instruction C unless float A < float B */                                 \
+    X(JumpUnlessGreaterFloat)  /* Jump to instruction C unless float A > float B */                                 \
+    X(JumpUnlessEqualFloat)    /* Jump to instruction C unless float A == float B */                                \
+    X(JumpUnlessNotEqualFloat) /* Jump to instruction C unless float A != float B */                                \
+    X(LoopEnter)               /* Set loop counter A to 1 */                                                        \
+    X(LoopBack)                /* Increment loop counter A, failing at the loop limit, and jump to instruction B */ \
+    X(LoadIndex)               /* Point register A at a copy of element C of B */                                   \
+    X(CheckArgument)           /* Fail unless parameter A of signature C holds a value of type B */                 \
+    X(CheckResult)             /* Fail unless register A, returned by signature C, holds a value of type B */       \
+    X(CheckAssignment)         /* Fail unless variable A holds a value of type B */                                 \
+    X(Eval)                    /* Run node B with the tree walker; see TRegisterInstruction for the result */       \
+    X(Call)                    /* Call the user function of call site B; see TRegisterInstruction for the result */ \
+    X(TailCall)                /* Call site B in place of the current function, whose caller takes the result */    \
+    X(Return)                  /* Write the variables back to the frame and return register A, if it is set */
+
+    enum class ERegisterOp : uint8_t
+    {
+#define VM_REGISTER_OPCODE_ENUM(Name) Name,
+        VM_REGISTER_OPCODES(VM_REGISTER_OPCODE_ENUM)
+#undef VM_REGISTER_OPCODE_ENUM
+        Count
+    };
+
+    /// <summary>
+    /// A register machine instruction. Eval and Call point register A at a copy of the value produced, unless A is -1;
+    /// when nothing is produced register A is left alone, or the instruction fails if C is set.
+    /// </summary>
+    struct TRegisterInstruction
+    {
+        ERegisterOp Op = ERegisterOp::Return;
+        int32_t A = 0;
+        int32_t B = 0;
+        int32_t C = 0;
+    };
+
+    /// <summary>
+    /// A call to a user function, which binds the parameters to the argument values as the tree does.
+    /// </summary>
+    struct TCallSite
+    {
+        std::string Name;
+        AstFunction* Function = nullptr;       // Resolved on the first call; functions cannot be redefined
+        std::vector<int32_t> Args;             // Argument registers
+        std::vector<Values::TObject> Literals; // Parallel to Args: each call binds literal arguments to a fresh copy
+    };
+
+    /// <summary>
+    /// The register code for the program or one function.
+    /// <para>
+    /// The register file is sized at compile time. The variables take the first registers, in the order the compiler
+    /// first saw them, then the constants and the result, then the temporaries, which a linear allocator hands out and
+    /// frees in evaluation order. A register holds a pointer to a value. Variable registers cache the frame's bindings: they
+    /// are loaded on entry and written back before anything else can see the frame, namely Eval, Call and Return.
+    /// </para>
+    /// </summary>
+    struct TRegisterCode
+    {
+        std::vector<TRegisterInstruction> Code;
+        std::vector<Values::TObject> Sites;      // Parallel to Code
+        std::vector<Values::TObject**> Cells;    // The bindings of the variable registers
+        std::vector<std::string> Names;          // Parallel to Cells
+        std::vector<Values::TObject*> Constants; // The values of the constant registers
+        std::vector<AstNode*> Nodes;             // Nodes run by Eval
+        std::vector<TCallSite> Calls;
+        std::vector<const AstFunction*> Signatures; // Functions whose annotations the unit checks
+        int ParamCount = 0;                      // Parameters are the first variables
+        int ResultRegister = 0;                  // Holds the value of the last expression statement
+        int RegisterCount = 0;
+        int LoopCount = 0;
+    };
+
+    std::string ToString(EOpCode Op);
+    std::string ToString(ERegisterOp Op);
+} // namespace Vm
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "Tasks.h"
+#include "Value.h"
+
+using namespace Values;
+
+namespace Tasks
+{
+    // The most values a channel may hold. The ring takes a cache line per cell, so this bounds it at 64MB.
+    static constexpr size_t MAX_CHANNEL_CAPACITY = 1 << 20;
+
+    /// <summary>
+    /// A bounded queue of values which tasks pass to each other, any number sending and any number receiving.
+    /// <para>
+    /// The values live in a ring of cells, after Dmitry Vyukov's bounded MPMC queue: each cell has a sequence number
+    /// saying which lap of the ring may next write or read it, so a sender or receiver claims a cell with one
+    /// compare-and-swap on its position and never takes a lock. Only a task which has to wait, because the ring is
+    /// full or empty, parks on the channel's wait list, and the others only touch it while one is parked.
+    /// </para>
+    /// <para>
+    /// A parked task is suspended, so its worker runs the tasks which would unblock it meanwhile. The values sent are
+    /// copies, as with the arguments of a task.
+    /// </para>
+    /// </summary>
+    class TChannel
+    {
+        struct alignas(64) TCell
+        {
+            std::atomic<size_t> Sequence;
+            TObject Value;
+        };
+
+        std::unique_ptr<TCell[]> Cells;
+        size_t Mask;     // The ring has a power of two of cells, at least 2
+        size_t Capacity; // How many values may wait, which the ring may have more cells than
+
+        // Each on a cache line of its own, so senders and receivers do not contend for one
+        alignas(64) std::atomic<size_t> SendPosition = 0;
+        alignas(64) std::atomic<size_t> ReceivePosition = 0;
+        alignas(64) std::atomic<bool> bClosed = false;
+
+        TWaitList Parked;
+
+        bool IsFull(size_t Position) const; // Whether as many values wait as the channel holds, sending at Position
+        bool TrySend(const TObject& Value);
+        bool TryReceive(TObject& Value);
+        bool CanSend() const;
+        bool CanReceive() const;
+        void Park(bool bSending);
+
+    public:
+        /// <param name="InCapacity">How many values may wait to be received, from 1 to MAX_CHANNEL_CAPACITY.</param>
+        explicit TChannel(size_t InCapacity);
+        TChannel(const TChannel&) = delete;
+        TChannel& operator=(const TChannel&) = delete;
+
+        /// <summary>
+        /// Sends a copy of a value, waiting while the channel is full.
+        /// </summary>
+        /// <returns>False if the channel is closed.</returns>
+        bool Send(const TObject& Value);
+
+        /// <summary>
+        /// Receives the oldest value, waiting while the channel is empty and open.
+        /// </summary>
+        /// <returns>False once the channel is closed and every value sent has been received.</returns>
+        bool Receive(TObject& Value);
+
+        /// <summary>
+        /// Closes the channel: sending fails from now on, and receivers drain what was sent and then stop waiting.
+        /// </summary>
+        void Close();
+
+        size_t GetCapacity() const { return Capacity; }
+    };
+} // namespace Tasks
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bytecode.h"
+#include "Inference.h"
+
+class AstNode;
+class AstBody;
+class AstAssignment;
+class AstBinOp;
+class AstCall;
+class AstFunction;
+class AstValue;
+struct Frame;
+
+namespace Vm
+{
+    // Functions whose bodies have more nodes than this are not inlined
+    static constexpr int INLINE_MAX_NODES = 24;
+    // How many inlined calls deep the register compiler goes
+    static constexpr int INLINE_MAX_DEPTH = 4;
+
+    /// <summary>
+    /// Whether the register compiler inlined a call site, for --inline-report.
+    /// </summary>
+    struct TInlineDecision
+    {
+        std::string Function;
+        int Line = 0;
+        int Column = 0;
+        bool bInlined = false;
+        std::string Detail; // The size inlined, or why the call was kept
+    };
+
+    /// <summary>
+    /// Compiles a syntax tree to bytecode for the VM. Compiling never fails: a node the VM has no instructions for is
+    /// compiled to an Eval instruction, which hands the node back to the tree-walking interpreter.
+    /// </summary>
+    class TCompiler
+    {
+        TChunk* Chunk = nullptr;
+        Frame* CurrentFrame;
+        std::map<std::string, int> VariableCells;
+        int Depth = 0;
+
+        int Emit(EOpCode Op, int32_t A = 0, int32_t B = 0, int32_t C = 0);
+        int Here() const { return static_cast<int>(Chunk->Code.size()); }
+        void PatchJump(int Index, int Target);
+        void Adjust(int Delta);
+
+        int NewSite();
+        int VariableCell(const std::string& Name);
+        int ConstantCell(Values::TObject* Value);
+        int LeafCell(AstNode* Node);
+
+        void CompileStatement(AstNode* Node);
+        void CompileExpression(AstNode* Node);
+        int CompileCondition(AstNode* Node);
+        void CompileEval(AstNode* Node, bool bValue);
+
+    public:
+        /// <summary>
+        /// Creates a compiler binding variables to the identifiers in <paramref name="InFrame"/>.
+        /// </summary>
+        /// <param name="InFrame">The frame the compiled code will run against.</param>
+        explicit TCompiler(Frame* InFrame)
+            : CurrentFrame(InFrame)
+        {
+        }
+
+        /// <summary>
+        /// Compiles a program.
+        /// </summary>
+        /// <param name="Program">The root node of the program.</param>
+        /// <returns>The compiled program. It must outlive any variable bound by it.</returns>
+        std::unique_ptr<TChunk> Compile(AstBody* Program);
+    };
+    /// <summary>
+    /// Compiles the program, or a function, to code for the register machine. Like <see cref="TCompiler"/> it never
+    /// fails, handing nodes it has no instructions for back to the tree-walking interpreter.
+    /// <para>
+    /// Calls to small user functions with straight-line bodies are inlined. Parameters are globals bound by reference,
+    /// so an inlined body uses the caller's registers for them and binds each one to its argument's value, as a call
+    /// would. A function is only inlined if it is defined when the unit is compiled, or declared at the top of the
+    /// program before the call; since functions cannot be redefined the inlined body is the one a call would run.
+    /// </para>
+    /// <para>
+    /// Type annotations are checked where values cross into the unit: annotated parameters on entry, annotated
+    /// assignments after the value is computed and the result before returning. Within a unit which calls no user
+    /// function, a variable assigned or checked on entry before anything reads it, and given the same type by every
+    /// assignment, holds that type throughout. Arithmetic and comparisons on ints and floats of a proven type are
+    /// compiled to typed instructions which use the raw values without checking them.
+    /// </para>
+    /// </summary>
+    class TRegisterCompiler
+    {
+        // The function a call site could be inlined from, found while collecting the unit's registers
+        struct TInlineCandidate
+        {
+            const AstFunction* Function = nullptr;
+            std::string Reason; // Why the call cannot be inlined, if it cannot
+        };
+
+        TRegisterCode* Code = nullptr;
+        Frame* CurrentFrame;
+        const std::map<std::string, AstFunction*>& Functions;
+        std::vector<TInlineDecision>* InlineReport;
+        std::map<std::string, int> Variables;
+        std::map<const AstValue*, int> Constants; // Index into Code->Constants
+        std::vector<AstValue*> ConstantNodes;
+        int NextTemp = 0;
+        bool bFunction = false; // Whether the unit is a function, so calls in tail position can be tail calls
+        const AstFunction* UnitFunction = nullptr;
+        std::map<std::string, const AstFunction*> Declared; // Declared at the top of the program so far
+        std::map<const AstCall*, TInlineCandidate> Candidates;
+        std::vector<const AstFunction*> Inlining; // The functions being inlined, innermost last
+        int CollectDepth = 0;                    // Nesting of conditionals and loops while collecting
+        std::map<std::string, Inference::TType> TypedVariables; // Variables of a proven type throughout the unit
+
+        int Emit(ERegisterOp Op, int32_t A = 0, int32_t B = 0, int32_t C = 0);
+        int Here() const { return static_cast<int>(Code->Code.size()); }
+        void PatchJump(int Index, int Target);
+
+        void Collect(AstNode* Node);
+        void CollectCall(AstCall* Call);
+        std::string CheckInline(const AstCall* Call, const AstFunction* Function) const;
+        void AddVariable(const std::string& Name);
+        int Variable(const std::string& Name) const;
+        int LeafRegister(AstNode* Node) const;
+        bool IsTemp(int Register) const { return Register >= Code->ResultRegister + 1; }
+        int AllocateTemp();
+        void Free(int Register);
+        void InferVariables(AstNode* Body, const std::vector<std::string>& Params);
+        Inference::TType StaticType(AstNode* Node) const;
+        bool CanTailCall(const AstCall* Call) const;
+        ERegisterOp GetArithmeticOp(const AstBinOp* BinOp) const;
+        void CompileCheck(const AstAssignment* Assignment);
+        void CompileCheck(ERegisterOp Op, int Register, Values::EValueType Type, const AstFunction* Function);
+
+        int CompileExpression(AstNode* Node, int Target);
+        int CompileCondition(AstNode* Node);
+        void CompileStatement(AstNode* Node, bool bTail = false);
+        void CompileEval(AstNode* Node, int Target, bool bRequired);
+        void CompileCall(AstCall* Call, int Target, bool bRequired, bool bTail = false);
+        void CompileValue(AstNode* Node, int Target, bool bRequired);
+        bool CompileInline(AstCall* Call, int Target, bool bRequired);
+        void Report(const AstCall* Call, bool bInlined, const std::string& Detail);
+        std::unique_ptr<TRegisterCode> CompileUnit(AstNode* Body, const std::vector<std::string>& Params);
+
+    public:
+        /// <summary>
+        /// Creates a compiler binding variables to the identifiers in <paramref name="InFrame"/>.
+        /// </summary>
+        /// <param name="InFrame">The frame the compiled code will run against.</param>
+        /// <param name="InFunctions">The functions defined so far, which calls may be inlined from.</param>
+        /// <param name="InInlineReport">If set, receives a decision for every call site to a user function.</param>
+        TRegisterCompiler(Frame* InFrame, const std::map<std::string, AstFunction*>& InFunctions,
+                          std::vector<TInlineDecision>* InInlineReport = nullptr)
+            : CurrentFrame(InFrame)
+              , Functions(InFunctions)
+              , InlineReport(InInlineReport)
+        {
+        }
+
+        /// <summary>
+        /// Compiles a program.
+        /// </summary>
+        /// <param name="Program">The root node of the program.</param>
+        /// <returns>The compiled program. It must outlive any variable bound by it.</returns>
+        std::unique_ptr<TRegisterCode> Compile(AstBody* Program);
+
+        /// <summary>
+        /// Compiles the body of a function, with its parameters as the first variables.
+        /// </summary>
+        /// <param name="Function">The function to compile.</param>
+        /// <returns>The compiled function. It must outlive any variable bound by it.</returns>
+        std::unique_ptr<TRegisterCode> Compile(const AstFunction* Function);
+    };
+} // namespace Vm
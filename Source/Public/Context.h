@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BuiltIns.h"
+#include "Format.h"
+#include "Logging.h"
+#include "Output.h"
+
+class AstNode;
+
+namespace Tasks
+{
+    class TScheduler;
+}
+
+namespace Runtime
+{
+    // How many iterations a while loop may run before it fails, unless the context sets another limit
+    static constexpr int DEFAULT_MAX_LOOP = 100000;
+
+    /// <summary>
+    /// Owns the syntax tree nodes made in a context and frees them all with it. The optimizer moves subtrees from one
+    /// node to another and drops others, so no node owns its children.
+    /// </summary>
+    class TNodeArena
+    {
+        std::vector<AstNode*> Nodes;
+        std::vector<int> Counts; // Nodes numbered so far, by kind
+
+    public:
+        TNodeArena() = default;
+        ~TNodeArena();
+        TNodeArena(const TNodeArena&) = delete;
+        TNodeArena& operator=(const TNodeArena&) = delete;
+
+        // Moving an arena hands its nodes over, as a compiled program takes the tree its context parsed
+        TNodeArena(TNodeArena&& Other) noexcept { *this = std::move(Other); }
+        TNodeArena& operator=(TNodeArena&& Other) noexcept
+        {
+            std::swap(Nodes, Other.Nodes);
+            std::swap(Counts, Other.Counts);
+            return *this;
+        }
+
+        void Add(AstNode* Node) { Nodes.push_back(Node); }
+
+        // Numbers a node among the nodes of its kind made in this arena, from zero
+        int Number(size_t Kind)
+        {
+            if (Kind >= Counts.size())
+            {
+                Counts.resize(Kind + 1);
+            }
+            return Counts[Kind]++;
+        }
+    };
+
+    /// <summary>
+    /// The state one interpreter shares between the programs it runs: the log its errors go to, the buffer its output
+    /// goes to, the formats its built-ins compiled, its limits, where its parser is and the trees it parsed.
+    /// <para>
+    /// Nothing else an interpreter changes is shared, so interpreters in different contexts can run on different
+    /// threads at once without locks. The built-ins themselves are the process's, which never change once made. Each
+    /// thread runs in the context a TScope made current on it, or in a context of its own. A context must not be
+    /// current on two threads at once.
+    /// </para>
+    /// </summary>
+    struct TContext
+    {
+        TNodeArena Nodes; // First, so the trees outlive everything else the context holds
+        Logging::Logger Logger;
+        Io::TOutput Output{Io::GetDefaultFlushPolicy()}; // What print and printf write, until it is flushed
+        const TFunctionMap& BuiltIns = BuiltIns::GetFunctionMap();
+        int MaxLoop = DEFAULT_MAX_LOOP;
+        Tasks::TScheduler* Scheduler = nullptr; // Runs the tasks programs spawn; null where they cannot spawn any
+        Formatting::TFormatCache Formats;       // The format strings printf has compiled
+
+        // The token the parser moved to last, which errors point at
+        int Line = 0;
+        int Column = 0;
+        std::string Source;
+    };
+
+    // The context a TScope made current on this thread, if any
+    extern thread_local constinit TContext* CurrentContext;
+
+    /// <summary>
+    /// Makes the thread's own context current, creating it the first time.
+    /// </summary>
+    TContext& UseThreadContext();
+
+    /// <summary>
+    /// Gets the context programs on this thread run in.
+    /// </summary>
+    inline TContext& GetContext()
+    {
+        return CurrentContext ? *CurrentContext : UseThreadContext();
+    }
+
+    /// <summary>
+    /// Makes a context current on this thread for as long as the scope lives, then restores the previous one.
+    /// </summary>
+    class TScope
+    {
+        TContext* Previous;
+
+    public:
+        explicit TScope(TContext& Context)
+            : Previous(CurrentContext)
+        {
+            CurrentContext = &Context;
+        }
+
+        ~TScope() { CurrentContext = Previous; }
+
+        TScope(const TScope&) = delete;
+        TScope& operator=(const TScope&) = delete;
+    };
+} // namespace Runtime
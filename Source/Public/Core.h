@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -77,9 +78,10 @@ namespace Core
     }
 
     /// <summary>
-    /// Reads the specified <paramref name="FileName"/> into a <param>std::string</param>.
+    /// Reads the specified <paramref name="FileName"/> into a <param>std::string</param>. The buffer is sized from the
+    /// file's size up front, and large files are mapped and copied in one pass.
     /// </summary>
     /// <param name="FileName">The file to read.</param>
-    /// ///<returns>The contents of the file.</returns>
-    std::string ReadFile(const std::string& FileName);
+    /// <returns>The contents of the file, or nothing if it could not be opened or read.</returns>
+    std::optional<std::string> ReadFile(const std::string& FileName);
 } // namespace Core
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Context.h"
+
+namespace Embed
+{
+    /// <summary>
+    /// A script compiled for a host program: parsed and resolved once, into a tree every execution of it runs. Running
+    /// a tree leaves it as it was, since each interpreter keeps the state of the nodes it runs itself, so the program
+    /// never changes once compiled and any number of executions on any threads may share it.
+    /// </summary>
+    class TProgram
+    {
+        Runtime::TNodeArena Nodes; // First, so the tree outlives everything else the program holds
+        AstBody* Tree = nullptr;
+        std::vector<std::string> SlotNames; // The names the tree is bound to, in slot order
+        std::vector<std::string> Inputs;
+        std::vector<std::string> Errors;
+
+        TProgram() = default;
+
+    public:
+        /// <summary>
+        /// Compiles a script, checking it the way a script file is checked before it runs.
+        /// </summary>
+        /// <param name="Source">The source code of the script.</param>
+        /// <param name="InInputs">The variables the host binds before each run, which the script reads without
+        /// assigning them.</param>
+        /// <returns>The program, holding the errors instead if the script does not compile.</returns>
+        static std::shared_ptr<const TProgram> Compile(const std::string& Source,
+                                                       const std::vector<std::string>& InInputs = {});
+
+        bool IsValid() const { return Errors.empty(); }
+        const std::vector<std::string>& GetErrors() const { return Errors; }
+        AstBody* GetTree() const { return Tree; }
+        const std::vector<std::string>& GetSlotNames() const { return SlotNames; }
+        const std::vector<std::string>& GetInputs() const { return Inputs; }
+    };
+
+    /// <summary>
+    /// Runs a compiled program any number of times with the tree-walking interpreter.
+    /// <para>
+    /// An execution runs the program's tree in a frame of its own, binding the names the program resolved when it is
+    /// created. Operators specialize themselves and hot code is compiled as it runs, and that carries over to later
+    /// runs, so only the first run is cold. Every run starts with no variables set but the inputs, which keep the
+    /// values the host last set.
+    /// </para>
+    /// <para>
+    /// An execution has an interpreter context of its own, so executions may run on different threads at once, but
+    /// each must only run on one thread at a time. Values the execution returns last until its next run.
+    /// </para>
+    /// </summary>
+    class TExecution
+    {
+        std::shared_ptr<const TProgram> Program;
+        Runtime::TContext Context;
+        Visitor Interpreter;
+        std::map<std::string, TObject> Inputs; // The frame binds each input to its value here at the start of a run
+        TObject* Result = nullptr;
+        std::vector<TObject> CallArguments;     // Copies of the arguments of the last Call, which its function may change
+        std::vector<TObject*> CallArgumentValues;
+        bool bDeclared = false; // Whether the top-level functions are declared, for Call
+        bool bBound = true;     // Whether each name got the slot the program's tree is bound to, which runs rely on
+
+        // Logs an error if a name got another slot, returning false
+        bool CheckBound() const;
+
+        // Unsets every variable but the inputs, which it binds to their values
+        void Reset();
+
+    public:
+        /// <param name="InProgram">The program to run.</param>
+        /// <param name="bJit">Whether to compile hot loops and functions to native code, where the JIT is supported.
+        /// </param>
+        explicit TExecution(std::shared_ptr<const TProgram> InProgram, bool bJit = false);
+        TExecution(const TExecution&) = delete;
+        TExecution& operator=(const TExecution&) = delete;
+
+        /// <summary>
+        /// Sets an input for the following runs.
+        /// </summary>
+        /// <returns>False if the program has no input of that name.</returns>
+        bool Set(const std::string& Name, const TObject& Value);
+
+        /// <summary>
+        /// Runs the program once. Anything it printed has been written out when it returns.
+        /// </summary>
+        /// <returns>False if the program failed to compile, an input is not set or the run logged an error.</returns>
+        bool Run();
+
+        /// <summary>
+        /// Calls one of the program's functions without running the rest of the program. Like a run, the call starts
+        /// with no variables set but the inputs.
+        /// </summary>
+        /// <param name="Name">The function, which the program must declare at its top level.</param>
+        /// <param name="Arguments">The argument values, which the call copies.</param>
+        /// <param name="Result">Where the call's result is copied; null if it has none.</param>
+        /// <returns>False if the program failed to compile, declares no such function or the call logged an error.
+        /// </returns>
+        bool Call(const std::string& Name, TArgumentList Arguments, TObject& Result);
+
+        /// <summary>
+        /// Gets a variable as the last run left it.
+        /// </summary>
+        /// <returns>The value, or null if the variable is not set.</returns>
+        TObject* Get(const std::string& Name);
+
+        /// <summary>
+        /// Gets the value the last run left on the stack, which is the value of its last expression.
+        /// </summary>
+        /// <returns>The value, or null if there is none.</returns>
+        TObject* GetResult() const { return Result; }
+
+        /// <summary>
+        /// Gets the errors the program failed to compile with, or those of the last run.
+        /// </summary>
+        std::vector<std::string> GetErrors();
+
+        Runtime::TContext& GetContext() { return Context; }
+    };
+} // namespace Embed
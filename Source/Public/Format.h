@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Function.h"
+#include "HashMap.h"
+
+using namespace Values;
+
+namespace Formatting
+{
+    /// <summary>
+    /// How one field formats its value, parsed from a spec such as ':>8' or ':.3f'. Follows std::format's
+    /// [[fill]align][sign][0][width][.precision][type], without '#' or nested widths.
+    /// </summary>
+    struct TSpec
+    {
+        char Fill = ' ';
+        char Align = 0; // '<', '>' or '^'; numbers go right and everything else left if unset
+        char Sign = '-'; // '+' for a sign on every number, ' ' for a space before positive ones
+        bool bZeroPad = false;
+        int Width = 0;
+        int Precision = -1; // Digits after the point for floats, or characters kept of a string; -1 if unset
+        char Type = 0;      // 's', 'd', 'b', 'B', 'o', 'x', 'X', 'e', 'E', 'f', 'F', 'g' or 'G'; 0 if unset
+        bool bEmpty = true; // '{}', which prints the value as print() does
+    };
+
+    /// <summary>
+    /// A printf format string compiled once into the literal text between its fields and a parsed spec for each field,
+    /// so printing only copies the text and formats the values.
+    /// <para>
+    /// Fields are '{}' or '{:spec}'; any other brace is literal text. A field with a float type, such as '{:.2f}',
+    /// also takes an int, as arithmetic does.
+    /// </para>
+    /// </summary>
+    class TFormat
+    {
+        struct TSegment
+        {
+            size_t Offset; // Of the literal text before the field, in Text
+            size_t Length;
+            size_t FieldLength; // Of the field itself, braces included, which follows the text
+            TSpec Spec;
+        };
+
+        std::string Text;
+        std::vector<TSegment> Fields; // Each with the text before it
+        size_t TailOffset = 0;        // Of the text after the last field
+        std::string Error;            // Why the format is invalid, if it is
+
+    public:
+        TFormat() = default;
+        explicit TFormat(const std::string& InText);
+
+        bool IsValid() const { return Error.empty(); }
+        const std::string& GetError() const { return Error; }
+        size_t GetFieldCount() const { return Fields.size(); }
+
+        /// <summary>
+        /// Appends the values formatted by the fields, one value per field.
+        /// </summary>
+        /// <returns>False, after logging an error, if a field's spec does not apply to its value's type.</returns>
+        bool Write(std::string& Out, TArgumentList Values) const;
+    };
+
+    /// <summary>
+    /// The formats an interpreter has compiled, by their text. Programs usually print with a few literal formats, so
+    /// each call site finds its format compiled after the first call; past CAPACITY different ones, further formats are
+    /// compiled on every call instead of growing the cache without bound.
+    /// </summary>
+    class TFormatCache
+    {
+        static constexpr size_t CAPACITY = 256;
+
+        Core::THashMap<TFormat> Formats;
+        TFormat Uncached;
+
+    public:
+        /// <summary>
+        /// Gets the compiled format, valid until the next call.
+        /// </summary>
+        const TFormat& Get(const std::string& Text);
+    };
+} // namespace Formatting
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Value.h"
+
+namespace Values
+{
+    /// <summary>
+    /// What a built-in function may do besides computing its result, for optimizations which move or skip calls.
+    /// </summary>
+    enum class EPurity
+    {
+        Pure,      // The result depends only on the argument values, and nothing else is touched
+        Volatile,  // No side effects, but the result may differ between calls with the same arguments, as with clock()
+        Effectful, // Has side effects outside the program's values, such as output, but changes no variables
+        Mutating,  // May change the values of its variable arguments in place
+    };
+
+    // The values a call passes a built-in, one per argument. A variable is passed in place, so a built-in which changes
+    // an argument changes the variable. A built-in whose last parameter is a TArgumentList takes any number of further
+    // arguments there.
+    using TArgumentList = std::span<TObject* const>;
+
+    /// <summary>
+    /// How a built-in's parameter of type T takes its value from an argument. Only the types specialized here can be
+    /// parameters, so registering a function with any other fails to compile.
+    /// </summary>
+    template <typename T>
+    struct TParameter;
+
+    template <>
+    struct TParameter<bool>
+    {
+        static constexpr EValueType Type = BoolType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == BoolType; }
+        static bool Get(TObject& Value) { return Value.RawBool(); }
+    };
+
+    template <>
+    struct TParameter<int>
+    {
+        static constexpr EValueType Type = IntType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == IntType; }
+        static int Get(TObject& Value) { return Value.RawInt(); }
+    };
+
+    // Ints are promoted, as the arithmetic operators do
+    template <>
+    struct TParameter<float>
+    {
+        static constexpr EValueType Type = FloatType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == FloatType || Value.GetType() == IntType; }
+        static float Get(TObject& Value)
+        {
+            return Value.GetType() == IntType ? static_cast<float>(Value.RawInt()) : Value.RawFloat();
+        }
+    };
+
+    template <>
+    struct TParameter<double> : TParameter<float>
+    {
+        static double Get(TObject& Value) { return TParameter<float>::Get(Value); }
+    };
+
+    template <>
+    struct TParameter<std::string>
+    {
+        static constexpr EValueType Type = StringType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == StringType; }
+        static const std::string& Get(TObject& Value) { return Value.RawString(); }
+    };
+
+    template <>
+    struct TParameter<TArrayValue>
+    {
+        static constexpr EValueType Type = ArrayType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == ArrayType; }
+        static TArrayValue& Get(TObject& Value) { return *Value.AsArray(); }
+    };
+
+    template <>
+    struct TParameter<TChannelValue>
+    {
+        static constexpr EValueType Type = ChannelType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == ChannelType; }
+        static TChannelValue& Get(TObject& Value) { return *Value.AsChannel(); }
+    };
+
+    template <>
+    struct TParameter<TFileValue>
+    {
+        static constexpr EValueType Type = FileType;
+        static bool Accepts(const TObject& Value) { return Value.GetType() == FileType; }
+        static TFileValue& Get(TObject& Value) { return *Value.AsFile(); }
+    };
+
+    // Any value
+    template <>
+    struct TParameter<TObject>
+    {
+        static constexpr EValueType Type = Void;
+        static bool Accepts(const TObject&) { return true; }
+        static TObject& Get(TObject& Value) { return Value; }
+    };
+
+    template <typename T>
+    constexpr bool IsOptional = false;
+    template <typename T>
+    constexpr bool IsOptional<std::optional<T>> = true;
+
+    template <typename TParam>
+    constexpr bool IsArgumentList = std::is_same_v<std::remove_cvref_t<TParam>, TArgumentList>;
+
+    class TFunction;
+
+    // Calls the function a TFunction holds with the arguments, writing its result into Result
+    using TInvoker = bool (*)(const TFunction& Function, TArgumentList Arguments, TObject& Result);
+
+    /// <summary>
+    /// A built-in function: a C++ function taking and returning plain types, and the code, generated when it is
+    /// registered, which unpacks arguments into those types and stores the result.
+    /// <para>
+    /// Parameters may be bool, int, float, double, std::string, TArrayValue, TChannelValue, TFileValue or TObject, by
+    /// value or reference, and a trailing TArgumentList. Each argument is checked against its parameter's type before
+    /// the call; a float parameter also takes an int. The result may be void, one of the same types except TArrayValue,
+    /// TChannelValue and TFileValue, or a std::optional of one, which is empty if the function failed and logged an
+    /// error. Calls are checked against the parameter count when a program is resolved, before it runs.
+    /// </para>
+    /// </summary>
+    class TFunction
+    {
+        std::string Name;
+        void (*Pointer)() = nullptr; // The registered function, which Invoker casts back to its own type
+        TInvoker Invoker = nullptr;
+        size_t Arity = 0; // Not counting a trailing TArgumentList
+        bool bVariadic = false;
+        EPurity Purity = EPurity::Mutating;
+
+        template <typename TValue>
+        static void Store(TValue&& Value, TObject& Result)
+        {
+            using T = std::remove_cvref_t<TValue>;
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                Result.SetBool(Value);
+            }
+            else if constexpr (std::is_same_v<T, int>)
+            {
+                Result.SetInt(Value);
+            }
+            else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+            {
+                Result.SetFloat(static_cast<float>(Value));
+            }
+            else if constexpr (std::is_same_v<T, std::string>)
+            {
+                Result.SetString(std::string(std::forward<TValue>(Value)));
+            }
+            else
+            {
+                static_assert(std::is_same_v<T, TObject>, "Built-ins return bool, int, float, string or TObject.");
+                Result = std::forward<TValue>(Value);
+            }
+        }
+
+        // Checks each argument a parameter takes, logging the first which does not fit
+        template <typename... TParams, size_t... Indices>
+        bool CheckArguments([[maybe_unused]] TArgumentList Arguments, std::index_sequence<Indices...>) const
+        {
+            return (CheckArgument<TParams>(Arguments, Indices) && ...);
+        }
+
+        template <typename TParam>
+        bool CheckArgument(TArgumentList Arguments, size_t Index) const
+        {
+            if constexpr (IsArgumentList<TParam>)
+            {
+                for (size_t Rest = Index; Rest < Arguments.size(); Rest++)
+                {
+                    if (!CheckDefined(Arguments[Rest], Rest))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            else
+            {
+                using TType = TParameter<std::remove_cvref_t<TParam>>;
+                if (!CheckDefined(Arguments[Index], Index))
+                {
+                    return false;
+                }
+                if (!TType::Accepts(*Arguments[Index]))
+                {
+                    Logging::Error("Argument {} of '{}' must be {}, got '{}'.", Index + 1, Name,
+                                   GetTypeName(TType::Type), Arguments[Index]->ToString());
+                    return false;
+                }
+                return true;
+            }
+        }
+
+        bool CheckDefined(const TObject* Argument, size_t Index) const
+        {
+            if (!Argument || Argument->GetType() == NullType)
+            {
+                Logging::Error("Argument {} of '{}' is undefined.", Index + 1, Name);
+                return false;
+            }
+            return true;
+        }
+
+        template <typename TParam>
+        static decltype(auto) GetArgument(TArgumentList Arguments, size_t Index)
+        {
+            if constexpr (IsArgumentList<TParam>)
+            {
+                return Arguments.subspan(Index);
+            }
+            else
+            {
+                return TParameter<std::remove_cvref_t<TParam>>::Get(*Arguments[Index]);
+            }
+        }
+
+        template <typename TResult, typename... TParams>
+        static bool Call(const TFunction& Function, TArgumentList Arguments, TObject& Result)
+        {
+            if (!Function.CheckArguments<TParams...>(Arguments, std::index_sequence_for<TParams...>()))
+            {
+                Result.SetNull();
+                return false;
+            }
+
+            const auto Callee = reinterpret_cast<TResult (*)(TParams...)>(Function.Pointer);
+            return [&]<size_t... Indices>(std::index_sequence<Indices...>)
+            {
+                if constexpr (std::is_void_v<TResult>)
+                {
+                    Callee(GetArgument<TParams>(Arguments, Indices)...);
+                    Result.SetNull();
+                    return true;
+                }
+                else if constexpr (IsOptional<TResult>)
+                {
+                    auto Value = Callee(GetArgument<TParams>(Arguments, Indices)...);
+                    if (!Value)
+                    {
+                        Result.SetNull();
+                        return false;
+                    }
+                    Store(std::move(*Value), Result);
+                    return true;
+                }
+                else
+                {
+                    Store(Callee(GetArgument<TParams>(Arguments, Indices)...), Result);
+                    return true;
+                }
+            }(std::index_sequence_for<TParams...>());
+        }
+
+    public:
+        TFunction() = default;
+
+        template <typename TResult, typename... TParams>
+        TFunction(const std::string& InName, TResult (*InFunction)(TParams...), EPurity InPurity)
+            : Name(InName)
+              , Pointer(reinterpret_cast<void (*)()>(InFunction))
+              , Invoker(&Call<TResult, TParams...>)
+              , Purity(InPurity)
+        {
+            constexpr size_t Count = sizeof...(TParams);
+            if constexpr (Count > 0)
+            {
+                using TLast = std::tuple_element_t<Count - 1, std::tuple<TParams...>>;
+                bVariadic = IsArgumentList<TLast>;
+            }
+            Arity = Count - bVariadic;
+        }
+
+        const std::string& GetName() const { return Name; }
+        EPurity GetPurity() const { return Purity; }
+        size_t GetArity() const { return Arity; }
+        bool IsVariadic() const { return bVariadic; }
+        bool AcceptsArgumentCount(size_t Count) const { return bVariadic ? Count >= Arity : Count == Arity; }
+
+        /// <summary>
+        /// Calls the function. The argument count must be one it accepts.
+        /// </summary>
+        /// <param name="Arguments">The argument values, which must stay valid for the call.</param>
+        /// <param name="Result">Where the result goes; null if the function has none or failed.</param>
+        /// <returns>False if an argument is of the wrong type or the function failed, having logged why.</returns>
+        bool Invoke(TArgumentList Arguments, TObject& Result) const { return Invoker(*this, Arguments, Result); }
+    };
+} // namespace Values
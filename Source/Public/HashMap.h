@@ -0,0 +1,229 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define HASHMAP_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define HASHMAP_SSE2 0
+#endif
+
+namespace Core
+{
+    /// <summary>
+    /// Open-addressing hash map from strings to <typeparamref name="T"/>, in the style of a Swiss table.
+    /// <para>
+    /// Entries live in a dense array in insertion order, which is also the iteration order. A separate table of slots
+    /// maps each hash to an entry index; each slot has a one-byte control tag holding 7 bits of the hash, so a probe
+    /// checks a whole group of 16 tags at once and only compares strings on a tag match. The full hash of every key is
+    /// stored next to it, so growing the table never rehashes a string.
+    /// </para>
+    /// <para>
+    /// Like <c>std::vector</c>, inserting may invalidate pointers and references to existing values.
+    /// </para>
+    /// </summary>
+    /// <typeparam name="T">The mapped value type.</typeparam>
+    template <typename T>
+    class THashMap
+    {
+        using TEntry = std::pair<std::string, T>;
+
+        static constexpr size_t GroupSize = 16;
+        static constexpr int8_t Empty = -128; // 0b10000000, never produced by a 7-bit tag
+
+        std::vector<TEntry> Entries;
+        std::vector<size_t> Hashes;   // Parallel to Entries
+        std::vector<int8_t> Controls; // One per slot, Empty or the low 7 bits of the hash
+        std::vector<uint32_t> Slots;  // Index into Entries, valid when the control is not Empty
+        size_t GroupMask = 0;         // Group count - 1; the group count is a power of two
+
+        static size_t Hash(std::string_view Key) { return std::hash<std::string_view>{}(Key); }
+        static int8_t Tag(size_t Hash) { return static_cast<int8_t>(Hash & 0x7F); }
+        static size_t FirstGroup(size_t Hash) { return Hash >> 7; }
+
+        // Bit N is set for each control in the group equal to Value.
+        static uint32_t Match(const int8_t* Group, int8_t Value)
+        {
+#if HASHMAP_SSE2
+            const __m128i Controls = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Group));
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Controls, _mm_set1_epi8(Value))));
+#else
+            uint32_t Mask = 0;
+            for (size_t I = 0; I < GroupSize; I++)
+            {
+                Mask |= static_cast<uint32_t>(Group[I] == Value) << I;
+            }
+            return Mask;
+#endif
+        }
+
+        size_t Capacity() const { return Controls.size(); }
+
+        // Returns the entry index for the key, or -1 if it is not present.
+        int64_t FindIndex(std::string_view Key, size_t KeyHash) const
+        {
+            if (Entries.empty())
+            {
+                return -1;
+            }
+            const int8_t KeyTag = Tag(KeyHash);
+            size_t Group = FirstGroup(KeyHash) & GroupMask;
+            for (size_t Step = 1;; Step++)
+            {
+                const int8_t* GroupControls = Controls.data() + Group * GroupSize;
+                for (uint32_t Mask = Match(GroupControls, KeyTag); Mask != 0; Mask &= Mask - 1)
+                {
+                    const uint32_t Index = Slots[Group * GroupSize + std::countr_zero(Mask)];
+                    if (Entries[Index].first == Key)
+                    {
+                        return Index;
+                    }
+                }
+                // An empty slot ends the probe sequence since nothing is ever erased
+                if (Match(GroupControls, Empty) != 0)
+                {
+                    return -1;
+                }
+                // Triangular probing visits every group when the group count is a power of two
+                Group = (Group + Step) & GroupMask;
+            }
+        }
+
+        void PlaceSlot(uint32_t Index)
+        {
+            const size_t KeyHash = Hashes[Index];
+            size_t Group = FirstGroup(KeyHash) & GroupMask;
+            for (size_t Step = 1;; Step++)
+            {
+                const int8_t* GroupControls = Controls.data() + Group * GroupSize;
+                if (const uint32_t Mask = Match(GroupControls, Empty))
+                {
+                    const size_t Slot = Group * GroupSize + std::countr_zero(Mask);
+                    Controls[Slot] = Tag(KeyHash);
+                    Slots[Slot] = Index;
+                    return;
+                }
+                Group = (Group + Step) & GroupMask;
+            }
+        }
+
+        void Rehash(size_t NewCapacity)
+        {
+            Controls.assign(NewCapacity, Empty);
+            Slots.assign(NewCapacity, 0);
+            GroupMask = NewCapacity / GroupSize - 1;
+            for (uint32_t Index = 0; Index < Entries.size(); Index++)
+            {
+                PlaceSlot(Index);
+            }
+        }
+
+        // Keeps the load factor at or below 7/8.
+        void GrowFor(size_t Count)
+        {
+            if (Count * 8 <= Capacity() * 7)
+            {
+                return;
+            }
+            size_t NewCapacity = Capacity() == 0 ? GroupSize : Capacity();
+            while (Count * 8 > NewCapacity * 7)
+            {
+                NewCapacity *= 2;
+            }
+            Rehash(NewCapacity);
+        }
+
+        T& Insert(std::string_view Key, size_t KeyHash, T&& InValue)
+        {
+            GrowFor(Entries.size() + 1);
+            Entries.emplace_back(std::string(Key), std::move(InValue));
+            Hashes.push_back(KeyHash);
+            PlaceSlot(static_cast<uint32_t>(Entries.size() - 1));
+            return Entries.back().second;
+        }
+
+    public:
+        THashMap() = default;
+        THashMap(std::initializer_list<TEntry> InEntries)
+        {
+            Reserve(InEntries.size());
+            for (const auto& [K, V] : InEntries)
+            {
+                Set(K, V);
+            }
+        }
+
+        size_t Size() const { return Entries.size(); }
+        size_t size() const { return Entries.size(); }
+        bool IsEmpty() const { return Entries.empty(); }
+        bool empty() const { return Entries.empty(); }
+
+        void Reserve(size_t Count)
+        {
+            Entries.reserve(Count);
+            Hashes.reserve(Count);
+            GrowFor(Count);
+        }
+
+        void Clear()
+        {
+            Entries.clear();
+            Hashes.clear();
+            Controls.clear();
+            Slots.clear();
+            GroupMask = 0;
+        }
+
+        bool Contains(std::string_view Key) const { return FindIndex(Key, Hash(Key)) >= 0; }
+
+        T* Find(std::string_view Key)
+        {
+            const int64_t Index = FindIndex(Key, Hash(Key));
+            return Index < 0 ? nullptr : &Entries[Index].second;
+        }
+        const T* Find(std::string_view Key) const
+        {
+            const int64_t Index = FindIndex(Key, Hash(Key));
+            return Index < 0 ? nullptr : &Entries[Index].second;
+        }
+
+        /// <summary>
+        /// Sets the value for the key, inserting it at the end of the iteration order if it is new.
+        /// </summary>
+        T& Set(std::string_view Key, const T& InValue)
+        {
+            const size_t KeyHash = Hash(Key);
+            const int64_t Index = FindIndex(Key, KeyHash);
+            if (Index >= 0)
+            {
+                Entries[Index].second = InValue;
+                return Entries[Index].second;
+            }
+            return Insert(Key, KeyHash, T(InValue));
+        }
+
+        T& operator[](std::string_view Key)
+        {
+            const size_t KeyHash = Hash(Key);
+            const int64_t Index = FindIndex(Key, KeyHash);
+            if (Index >= 0)
+            {
+                return Entries[Index].second;
+            }
+            return Insert(Key, KeyHash, T());
+        }
+
+        // Iteration is in insertion order
+        auto begin() { return Entries.begin(); }
+        auto end() { return Entries.end(); }
+        auto begin() const { return Entries.begin(); }
+        auto end() const { return Entries.end(); }
+    };
+} // namespace Core
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Token.h"
+#include "Value.h"
+
+class AstNode;
+class AstBody;
+class AstFunction;
+struct Frame;
+
+namespace Inference
+{
+    enum class EKind
+    {
+        Unknown, // Nothing is known to reach it yet, as for a variable nothing assigns
+        Proven,  // Every value it can have is of one type
+        Dynamic, // It may have values of different types
+    };
+
+    /// <summary>
+    /// What type inference proved about a variable or expression. The kinds form a lattice: Unknown joined with a type
+    /// is that type, and two different types join to Dynamic.
+    /// </summary>
+    struct TType
+    {
+        EKind Kind = EKind::Unknown;
+        Values::EValueType Type = Values::NullType;
+
+        static TType Of(Values::EValueType InType) { return {EKind::Proven, InType}; }
+        static TType Dynamic() { return {EKind::Dynamic, Values::NullType}; }
+
+        bool IsProven() const { return Kind == EKind::Proven; }
+        bool Is(Values::EValueType InType) const { return IsProven() && Type == InType; }
+        TType Join(const TType& Other) const;
+        bool operator==(const TType& Other) const = default;
+    };
+
+    /// <summary>
+    /// The type of a binary operator's result for operands of the given types.
+    /// </summary>
+    TType GetResultType(Values::EBinaryOp Op, const TType& Left, const TType& Right);
+
+    /// <summary>
+    /// The type of '!' or unary '-' applied to an operand of the given type.
+    /// </summary>
+    TType GetUnaryType(ETokenType Op, const TType& Operand);
+
+    // Operator nodes in a program, and how many of them were specialized
+    struct TReport
+    {
+        int Operations = 0;
+        int Specialized = 0;
+    };
+
+    /// <summary>
+    /// Proves the types of variables and expressions across a program and every function it can call, and marks the
+    /// operators whose operand types are proven so the tree runs them without checking types.
+    /// <para>
+    /// Every variable is global and parameters are bound to their arguments, so the analysis does not follow control
+    /// flow: a variable's type joins the type of every assignment to it anywhere, every argument bound to it as a
+    /// parameter and the value it is bound to now. Elements, built-in results and variables passed to a mutating
+    /// built-in, which may store any type in them, are dynamic. The analysis runs again before each program, so
+    /// operators proven for an earlier REPL line are demoted if a later one assigns a variable a new type.
+    /// </para>
+    /// <para>
+    /// Type annotations are checked when the value is assigned, bound or returned, so an annotated assignment or
+    /// parameter has its annotated type whatever the expression or argument, and a call has the return type its
+    /// function declares. Other function results are dynamic.
+    /// </para>
+    /// </summary>
+    class TTypeInference
+    {
+        Frame* CurrentFrame;
+        const std::map<std::string, AstFunction*>& Functions;
+        std::map<std::string, TType> Variables;
+        std::multimap<std::string, AstFunction*> Declarations; // Every function a call could run, by name
+        bool bChanged = false;
+
+        void Declare(AstNode* Node);
+        void Bind(const std::string& Name, const TType& Type);
+        void Infer(AstNode* Node);
+        TType TypeOf(AstNode* Node);
+        void Specialize(AstNode* Node, TReport* Report);
+
+    public:
+        TTypeInference(Frame* InFrame, const std::map<std::string, AstFunction*>& InFunctions)
+            : CurrentFrame(InFrame)
+              , Functions(InFunctions)
+        {
+        }
+
+        /// <summary>
+        /// Infers types for a program about to run and specializes its operators and those of every known function.
+        /// </summary>
+        /// <param name="Program">The root node of the program.</param>
+        /// <returns>The number of operators in the program, including the functions it declares, and how many were
+        /// specialized.</returns>
+        TReport Run(AstBody* Program);
+    };
+} // namespace Inference
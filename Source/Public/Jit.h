@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Value.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define JIT_SUPPORTED 1
+#else
+    #define JIT_SUPPORTED 0
+#endif
+
+class AstWhile;
+class AstFunction;
+struct Frame;
+
+namespace Jit
+{
+    // Loop iterations, summed over every run of the loop, before a while loop is compiled
+    static constexpr int HOT_LOOP_COUNT = 64;
+    // Calls before a function body is compiled
+    static constexpr int HOT_CALL_COUNT = 16;
+
+    enum class EStatus
+    {
+        Success,
+        GuardFailed,    // A variable was missing or had changed type; nothing was executed
+        MaxLoop,        // A loop hit the context's loop limit
+        DivideByZero,   // An int division by zero
+        DivideOverflow, // An int division of INT_MIN by -1
+    };
+
+    struct TStats
+    {
+        int Compiled = 0;
+        int Rejected = 0;
+        int GuardFailures = 0;
+    };
+
+    /// <summary>
+    /// A block of memory holding machine code. The memory is writable while the code is copied in and only readable
+    /// and executable afterwards.
+    /// </summary>
+    class TExecutableMemory
+    {
+        void* Memory = nullptr;
+        size_t Size = 0;
+
+    public:
+        TExecutableMemory() = default;
+        TExecutableMemory(const TExecutableMemory& Other) = delete;
+        TExecutableMemory& operator=(const TExecutableMemory& Other) = delete;
+        ~TExecutableMemory();
+
+        bool Load(const std::vector<uint8_t>& Code);
+        void* GetCode() const { return Memory; }
+    };
+
+    // A variable read or written by a compiled region, held in a single 8-byte slot while the region runs
+    struct TSlotVariable
+    {
+        std::string Name;
+        Values::EValueType Type = Values::NullType;
+        int Slot = -1;
+        int DirtySlot = -1;     // Set to non-zero when the region assigns the variable, or -1 if it never does
+        Values::TObject Storage; // Assigned variables are bound to this on exit, as the tree binds them to node storage
+    };
+
+    class TCompiler;
+
+    /// <summary>
+    /// A while loop or function body compiled to machine code. The code is specialized to the types the variables had
+    /// when it was compiled; every entry checks those types first and refuses to run if any has changed.
+    /// </summary>
+    class TRegion
+    {
+        using TEntryPoint = int (*)(int64_t* Slots);
+
+        TExecutableMemory Code;
+        std::vector<TSlotVariable> Variables;
+        std::vector<int64_t> Slots;
+        int CounterSlot = -1; // Iteration count of the outer loop, for loop regions
+        int ResultSlot = -1;  // Value of the last expression, for function regions which end in one
+        Values::EValueType ResultType = Values::NullType;
+        Values::TObject Result;
+
+        friend class TCompiler;
+
+    public:
+        /// <summary>
+        /// Runs the compiled code against the variables in <paramref name="InFrame"/>, then binds every variable it
+        /// assigned back into the frame.
+        /// </summary>
+        /// <param name="InFrame">The frame holding the variables.</param>
+        /// <param name="Count">For loop regions, the iteration count to resume the loop at.</param>
+        /// <returns>The status of the run.</returns>
+        EStatus Run(Frame* InFrame, int Count);
+
+        // The value of the function body, or null if it does not produce one
+        Values::TObject* GetResult() { return ResultSlot >= 0 ? &Result : nullptr; }
+    };
+
+    /// <summary>
+    /// Baseline JIT compiler for hot while loops and function bodies. Only int and float variables, arithmetic,
+    /// comparisons, assignments, if and while are supported; any other node rejects the whole region, which is then
+    /// left to the interpreter.
+    /// </summary>
+    class TJit
+    {
+        std::vector<std::unique_ptr<TRegion>> Regions;
+
+        TRegion* Compile(const AstWhile* Loop, const AstFunction* Function, Frame* InFrame);
+
+    public:
+        TStats Stats;
+
+        /// <summary>
+        /// Compiles a while loop, using the types of the variables in <paramref name="InFrame"/>.
+        /// </summary>
+        /// <param name="Node">The loop to compile.</param>
+        /// <param name="InFrame">The frame holding the variables.</param>
+        /// <returns>The compiled region, or null if the loop cannot be compiled.</returns>
+        TRegion* Compile(const AstWhile* Node, Frame* InFrame) { return Compile(Node, nullptr, InFrame); }
+
+        /// <summary>
+        /// Compiles a function body, using the types of the variables in <paramref name="InFrame"/> once the arguments
+        /// have been bound.
+        /// </summary>
+        /// <param name="Node">The function to compile.</param>
+        /// <param name="InFrame">The frame holding the variables.</param>
+        /// <returns>The compiled region, or null if the function cannot be compiled.</returns>
+        TRegion* Compile(const AstFunction* Node, Frame* InFrame) { return Compile(nullptr, Node, InFrame); }
+    };
+
+    /// <summary>
+    /// Returns whether the JIT can generate code for the current platform.
+    /// </summary>
+    bool IsSupported();
+} // namespace Jit
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Io
+{
+    /// <summary>
+    /// Reads a file one line at a time through a buffer of fixed size, so memory use does not grow with the file and a
+    /// script can work through files larger than memory.
+    /// <para>
+    /// Each line is found with a vectorized search for its newline and copied into the caller's string, which keeps
+    /// its capacity from line to line. A line longer than the buffer is assembled across refills. Lines end at '\n',
+    /// which is not part of the line; a last line without one is still returned.
+    /// </para>
+    /// <para>
+    /// Any number of threads may read from one reader, each getting whole lines.
+    /// </para>
+    /// </summary>
+    class TLineReader
+    {
+        static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+        std::mutex Mutex;
+        std::FILE* File;
+        std::unique_ptr<char[]> Buffer;
+        size_t Begin = 0; // The first byte not yet returned
+        size_t End = 0;   // One past the last byte read into the buffer
+
+        bool Fill();
+
+    public:
+        /// <summary>
+        /// Opens a file for reading.
+        /// </summary>
+        /// <returns>The reader, or null if the file could not be opened.</returns>
+        static std::shared_ptr<TLineReader> Open(const std::string& Path);
+
+        explicit TLineReader(std::FILE* InFile);
+        ~TLineReader();
+        TLineReader(const TLineReader&) = delete;
+        TLineReader& operator=(const TLineReader&) = delete;
+
+        /// <summary>
+        /// Reads the next line.
+        /// </summary>
+        /// <param name="Line">Replaced with the line, without its newline.</param>
+        /// <returns>False, leaving Line empty, once every line has been read or the reader is closed.</returns>
+        bool Next(std::string& Line);
+
+        /// <summary>
+        /// Closes the file, after which no more lines are read. Closing twice does nothing.
+        /// </summary>
+        void Close();
+    };
+} // namespace Io
@@ -17,24 +17,21 @@ namespace Logging
         Error,
     };
 
+    /// <summary>
+    /// The messages an interpreter logged. Each interpreter context has its own.
+    /// </summary>
     class Logger
     {
         std::vector<std::pair<std::string, LogLevel>> Messages;
 
-        Logger() = default;
-
     public:
-        static Logger* Instance;
-        static int Line;
-        static int Column;
-        static std::string Source;
+        int IndentDepth = 0; // Of debug messages
 
+        Logger() = default;
         Logger(Logger& Other) = delete;
         ~Logger() = default;
         void operator=(const Logger& Other) = delete;
 
-        static Logger* GetInstance();
-
         template <typename... Types>
         void Log(std::format_string<Types...> Fmt, LogLevel Level, Types&&... Args)
         {
@@ -48,42 +45,41 @@ namespace Logging
         void Clear() { Messages.clear(); }
     };
 
-    static Logger* GetLogger()
-    {
-        return Logger::GetInstance();
-    }
+    /// <summary>
+    /// Gets the logger of the interpreter context current on this thread.
+    /// </summary>
+    Logger* GetLogger();
 
     template <typename... Types>
     static constexpr void Debug(std::format_string<Types...> Fmt, Types&&... Args)
     {
 #ifdef _DEBUG
         std::cout << std::format(Fmt, std::forward<Types>(Args)...) << std::endl;
-        Logger::GetInstance()->Log(Fmt, LogLevel::Debug, std::forward<Types>(Args)...);
+        GetLogger()->Log(Fmt, LogLevel::Debug, std::forward<Types>(Args)...);
 #endif
     }
 
     template <typename... Types>
     static constexpr void Info(std::format_string<Types...> Fmt, Types&&... Args)
     {
-        Logger::GetInstance()->Log(Fmt, LogLevel::Info, std::forward<Types>(Args)...);
+        GetLogger()->Log(Fmt, LogLevel::Info, std::forward<Types>(Args)...);
     }
 
     template <typename... Types>
     static constexpr void Warning(std::format_string<Types...> Fmt, Types&&... Args)
     {
-        Logger::GetInstance()->Log(Fmt, LogLevel::Warning, std::forward<Types>(Args)...);
+        GetLogger()->Log(Fmt, LogLevel::Warning, std::forward<Types>(Args)...);
     }
 
     template <typename... Types>
     static constexpr void Error(std::format_string<Types...> Fmt, Types&&... Args)
     {
-        Logger::GetInstance()->Log(Fmt, LogLevel::Error, std::forward<Types>(Args)...);
+        GetLogger()->Log(Fmt, LogLevel::Error, std::forward<Types>(Args)...);
     }
 
-    static int IndentDepth = 0;
     static std::string GetIndent()
     {
-        return std::string(IndentDepth, ' ');
+        return std::string(GetLogger()->IndentDepth, ' ');
     }
     
 } // namespace Logging
@@ -91,9 +87,9 @@ namespace Logging
 #ifdef _DEBUG
     #define DEBUG_ENTER                                             \
         Logging::Debug("{}Entering {}.", Logging::GetIndent(), __FUNCSIG__); \
-        Logging::IndentDepth++;
+        Logging::GetLogger()->IndentDepth++;
     #define DEBUG_EXIT \
-        Logging::IndentDepth--; \
+        Logging::GetLogger()->IndentDepth--; \
         Logging::Debug("{}Exiting {}.", Logging::GetIndent(), __FUNCSIG__);
 #else
 #define DEBUG_ENTER
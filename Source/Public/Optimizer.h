@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class AstNode;
+class AstBody;
+class AstWhile;
+
+namespace Optimizer
+{
+    struct TStats
+    {
+        int Hoisted = 0; // Loop-invariant expressions moved in front of their loops
+    };
+
+    /// <summary>
+    /// Rewrites while loops in a syntax tree so they do less work per iteration. Every engine runs the rewritten tree.
+    /// <para>
+    /// Pure expressions whose variables the loop never assigns are computed once, in front of the loop, into hidden
+    /// variables the loop reads instead. Only expressions the loop evaluates on every iteration are moved, and they
+    /// are only computed if the loop runs at least once, so they fail, if at all, where the loop would have failed.
+    /// A loop calling a user function or a built-in which changes its arguments is left alone, since either could
+    /// change any variable.
+    /// </para>
+    /// <para>
+    /// Multiplications by the loop counter are not replaced by additions. Values are boxed, so an addition costs as
+    /// much as the multiplication it replaces, and keeping the product up to date adds an assignment per iteration.
+    /// </para>
+    /// </summary>
+    class TLoopOptimizer
+    {
+        TStats Stats;
+        int NextVariable = 0; // Hidden variables are numbered across every program of the session
+
+        AstNode* Rewrite(AstNode* Node);
+        AstNode* RewriteLoop(AstWhile* Loop);
+        std::string NewVariable(const std::string& Kind);
+
+    public:
+        /// <summary>
+        /// Optimizes every while loop in a program, including those in the functions it declares.
+        /// </summary>
+        /// <param name="Program">The root node of the program, which is rewritten in place.</param>
+        void Optimize(AstBody* Program);
+
+        const TStats& GetStats() const { return Stats; }
+    };
+} // namespace Optimizer
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Io
+{
+    enum class EFlushPolicy
+    {
+        Line,  // Written out after every line, so a terminal shows each as soon as it is printed
+        Block, // Written out once a block has filled up, or when flushed
+    };
+
+    /// <summary>
+    /// Collects what scripts print and writes it to standard output in as few calls as its flush policy allows, instead
+    /// of going through the stream for every line.
+    /// <para>
+    /// Each interpreter context owns one, so printing takes no lock. Anything still buffered is written when the
+    /// output is flushed, which the interpreter does before printing anything of its own, such as errors, and when its
+    /// context is destroyed. Only whole lines are written, so the lines of contexts on different threads are never
+    /// interleaved.
+    /// </para>
+    /// <para>
+    /// A task's output is held: under block buffering it is never written out, but taken when the task finishes and
+    /// written into the output of whoever joins it. The code spawning a task flushes its own output first, so what a
+    /// program prints before spawning a task, what the task prints and what the program prints after joining it come
+    /// out in that order.
+    /// </para>
+    /// </summary>
+    class TOutput
+    {
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        std::string Buffer;
+        EFlushPolicy Policy;
+        bool bHeld = false;
+
+        void Drain();
+
+        // Whether the buffer is to be written out now
+        bool IsDue() const { return Policy == EFlushPolicy::Line || (!bHeld && Buffer.size() >= BLOCK_SIZE); }
+
+    public:
+        explicit TOutput(EFlushPolicy InPolicy);
+        ~TOutput();
+        TOutput(const TOutput&) = delete;
+        TOutput& operator=(const TOutput&) = delete;
+
+        /// <summary>
+        /// Prints a line, adding its newline.
+        /// </summary>
+        void WriteLine(std::string_view Line);
+
+        /// <summary>
+        /// Prints a line built straight into the buffer, adding its newline.
+        /// </summary>
+        /// <param name="Build">Appends the line to the string it is given, returning false to print nothing after
+        /// all.</param>
+        /// <returns>What Build returned.</returns>
+        template <typename TBuild>
+        bool BuildLine(TBuild&& Build)
+        {
+            const size_t Start = Buffer.size();
+            if (!Build(Buffer))
+            {
+                Buffer.resize(Start);
+                return false;
+            }
+            Buffer += '\n';
+            if (IsDue())
+            {
+                Drain();
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Prints lines another output printed, such as a task's, which end in their newline.
+        /// </summary>
+        void Write(std::string_view Lines);
+
+        /// <summary>
+        /// Writes out everything buffered, unless the output is held.
+        /// </summary>
+        void Flush();
+
+        /// <summary>
+        /// Holds the output from now on: under block buffering nothing is written out until it is taken.
+        /// </summary>
+        void Hold() { bHeld = true; }
+
+        /// <summary>
+        /// Takes everything buffered, leaving the buffer empty.
+        /// </summary>
+        std::string Take();
+
+        void SetPolicy(EFlushPolicy InPolicy);
+    };
+
+    /// <summary>
+    /// The flush policy contexts' outputs are created with: line buffering if standard output is a terminal, and block
+    /// buffering if it is a file or pipe, unless another policy was set.
+    /// </summary>
+    EFlushPolicy GetDefaultFlushPolicy();
+
+    void SetDefaultFlushPolicy(EFlushPolicy InPolicy);
+} // namespace Io
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+class AstNode;
+class AstBody;
+class AstCall;
+class AstFunction;
+struct Frame;
+
+namespace Resolver
+{
+    /// <summary>
+    /// Checks the names in a program before it runs and binds each one, so the tree-walking interpreter skips looking
+    /// them up.
+    /// <para>
+    /// Every variable is global, so a name is defined if any code can bind it: an assignment anywhere in the program
+    /// or a function it could call, a parameter, or a variable the REPL has already bound. Reading any other name,
+    /// calling a function which is neither built in nor declared anywhere, or calling a function with an argument
+    /// count none of its declarations takes would fail when it ran, so it is reported up front and the program does
+    /// not run. Code which never runs is checked too.
+    /// </para>
+    /// <para>
+    /// Variables, subscripts, assignments and parameters are bound to their entries in the frame, and calls to
+    /// built-ins and to functions defined by an earlier program to what they call.
+    /// </para>
+    /// </summary>
+    class TResolver
+    {
+        Frame* CurrentFrame;
+        const std::map<std::string, AstFunction*>& Functions;
+        bool bWholeProgram;
+        std::set<std::string> Defined;
+        std::multimap<std::string, AstFunction*> Declarations; // Functions the program declares, by name
+        int Errors = 0;
+
+        void Declare(AstNode* Node);
+        void Resolve(AstNode* Node, bool bInFunction);
+        void ResolveCall(AstCall* Call, bool bInFunction);
+
+        // Checks a call of a user function, returning the function if it is already defined
+        AstFunction* ResolveFunction(const AstNode* Node, const std::string& Name, size_t ArgCount, bool bInFunction);
+        void Report(const AstNode* Node, const std::string& Message);
+
+    public:
+        /// <param name="InFrame">The frame the program runs in.</param>
+        /// <param name="InFunctions">The functions earlier programs defined.</param>
+        /// <param name="bInWholeProgram">Whether the program is all there will be. A REPL line is not, so the
+        /// functions it declares may use variables and functions later lines define.</param>
+        TResolver(Frame* InFrame, const std::map<std::string, AstFunction*>& InFunctions, bool bInWholeProgram)
+            : CurrentFrame(InFrame)
+              , Functions(InFunctions)
+              , bWholeProgram(bInWholeProgram)
+        {
+        }
+
+        /// <summary>
+        /// Resolves the names of a program about to run, including those of the functions it declares.
+        /// </summary>
+        /// <param name="Program">The root node of the program.</param>
+        /// <returns>False if a name cannot be resolved; each problem is logged as an error.</returns>
+        bool Run(AstBody* Program);
+    };
+} // namespace Resolver
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Simd
+{
+    enum class EInstructionSet
+    {
+        Scalar,
+        SSE,
+        AVX2,
+    };
+
+    enum EArrayOp
+    {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        ArrayOpCount
+    };
+
+    // Element-wise: Out[I] = A[I] op B[I]
+    template <typename T>
+    using TBinaryKernel = void (*)(const T* A, const T* B, T* Out, size_t Count);
+
+    // Broadcast: Out[I] = A[I] op Scalar, or Out[I] = Scalar op A[I] for the reversed variant
+    template <typename T>
+    using TBroadcastKernel = void (*)(const T* A, T Scalar, T* Out, size_t Count);
+
+    // Reductions over a single array. Count must be at least 1 for Min/Max.
+    template <typename T>
+    using TReduceKernel = T (*)(const T* A, size_t Count);
+
+    template <typename T>
+    using TDotKernel = T (*)(const T* A, const T* B, size_t Count);
+
+    template <typename T>
+    using TScanKernel = void (*)(const T* A, T* Out, size_t Count);
+
+    /// <summary>
+    /// The set of array kernels for a single element type, all compiled for the same instruction set.
+    /// </summary>
+    template <typename T>
+    struct TKernelSet
+    {
+        TBinaryKernel<T> Binary[ArrayOpCount];
+        TBroadcastKernel<T> Broadcast[ArrayOpCount];
+        TBroadcastKernel<T> BroadcastReversed[ArrayOpCount];
+        TReduceKernel<T> Sum;
+        TReduceKernel<T> Min;
+        TReduceKernel<T> Max;
+        TDotKernel<T> Dot;
+        TScanKernel<T> PrefixSum;
+    };
+
+    struct TKernels
+    {
+        EInstructionSet InstructionSet;
+        TKernelSet<float> Float;
+        TKernelSet<int> Int;
+    };
+
+    /// <summary>
+    /// Detects the best instruction set supported by the current CPU.
+    /// </summary>
+    /// <returns>The widest supported instruction set.</returns>
+    EInstructionSet DetectInstructionSet();
+
+    /// <summary>
+    /// Returns the kernels for the best instruction set supported by the current CPU. Detection happens once, on the
+    /// first call.
+    /// </summary>
+    /// <returns>The selected kernels.</returns>
+    const TKernels& GetKernels();
+
+    /// <summary>
+    /// Returns the kernels compiled for the specified <paramref name="InstructionSet"/>, regardless of whether the
+    /// current CPU supports it.
+    /// </summary>
+    /// <param name="InstructionSet">The instruction set to get kernels for.</param>
+    /// <returns>The kernels for the instruction set.</returns>
+    const TKernels& GetKernels(EInstructionSet InstructionSet);
+
+    std::string ToString(EInstructionSet InstructionSet);
+} // namespace Simd
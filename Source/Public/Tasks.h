@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Function.h"
+
+using namespace Values;
+
+namespace Embed
+{
+    class TProgram;
+    class TExecution;
+} // namespace Embed
+
+namespace Tasks
+{
+    // Arrays shorter than this are run on the calling thread by the parallel built-ins, which would spend more on
+    // handing chunks to workers than on running them
+    static constexpr size_t SEQUENTIAL_CUTOFF = 2048;
+
+    // How many chunks the parallel built-ins split a longer array into for each worker, so that workers which finish
+    // early can steal the rest
+    static constexpr size_t CHUNKS_PER_WORKER = 4;
+
+    // The stack each task on a worker runs on, which like a thread's is only reserved and takes memory as it is used
+    static constexpr size_t FIBER_STACK_SIZE = 8 * 1024 * 1024;
+
+    // How many fibers each worker keeps once their tasks finish, for its next tasks to run on
+    static constexpr size_t IDLE_FIBERS_PER_WORKER = 2;
+
+    class TScheduler;
+    struct TFiber;
+
+    /// <summary>
+    /// Work calling one of the program's functions, run alongside the code which queued it: a call spawned by the
+    /// script, or one chunk of an array the parallel built-ins work through.
+    /// <para>
+    /// A task runs in an interpreter of its own and shares no variables with the code which queued it: the values it
+    /// calls the function with are copied into the call, and the results are copied out again, as is what it printed.
+    /// </para>
+    /// </summary>
+    struct TTask
+    {
+        std::string Function; // The function the task calls, which its errors name
+        std::function<bool(Embed::TExecution& Execution)> Body; // Released once the task has run
+        TObject Result;
+        std::vector<std::string> Errors; // The errors the task failed with, if it did
+        std::string Output;              // What the task printed under block buffering, which its joiner prints
+        std::atomic<bool> bDone = false;
+
+        // Set while the task runs on a worker: the stack it runs on, and the worker, which alone resumes it
+        TFiber* Fiber = nullptr;
+        int Home = -1;
+        bool bExited = false; // Whether the body has returned, leaving the fiber free for another task
+    };
+
+    /// <summary>
+    /// The tasks and threads waiting for something other tasks do, such as a channel getting a value.
+    /// <para>
+    /// A task on a worker is suspended while it waits: it leaves its worker free to run other tasks, and costs only
+    /// the stack it has used so far. Notify queues it on its worker again, which resumes it. A thread outside the pool
+    /// blocks instead, until notified.
+    /// </para>
+    /// </summary>
+    class TWaitList
+    {
+        std::mutex Mutex;
+        std::condition_variable Signal; // What blocked threads wait on
+        std::vector<TTask*> Suspended;
+        std::atomic<int> WaitingCount = 0; // Suspended tasks and blocked threads
+
+    public:
+        /// <summary>
+        /// Waits until Ready returns true, which it is called again to check after every notification.
+        /// </summary>
+        void Wait(const std::function<bool()>& Ready);
+
+        /// <summary>
+        /// Wakes everything waiting, to check again. Called after changing what they wait for.
+        /// </summary>
+        void Notify();
+    };
+
+    /// <summary>
+    /// The tasks waiting to run on one worker. The worker takes the task it pushed last, while the tasks thieves take
+    /// from the other end are the oldest, which are likely to spawn the most work of their own.
+    /// </summary>
+    class TWorkQueue
+    {
+        std::mutex Mutex;
+        std::deque<TTask*> Tasks;
+        std::deque<TTask*> Woken; // Suspended tasks which may go on, which only this queue's worker can resume
+
+    public:
+        // Only this queue's worker reads and writes these
+        int SuspendedCount = 0;          // Tasks suspended on the worker
+        std::vector<TFiber*> IdleFibers; // Fibers the worker created which no task is running on, kept for the next
+
+        void Push(TTask* Task);
+        TTask* Pop();
+        TTask* Steal();
+        void PushWoken(TTask* Task);
+        TTask* PopWoken();
+    };
+
+    /// <summary>
+    /// Runs the tasks a program spawns, and the chunks of its parallel built-ins, on a pool of worker threads.
+    /// <para>
+    /// Each worker has a queue of its own, to which the tasks it spawns go; threads outside the pool share one more.
+    /// A worker with nothing in its queue steals from the others. A task joining another is suspended until the other
+    /// is done, so a task may spawn and join tasks of its own without tying up its worker, while a thread outside the
+    /// pool runs other tasks meanwhile.
+    /// Tasks run in interpreters created from the program's source, which are reused once a task finishes.
+    /// </para>
+    /// <para>
+    /// On a worker, each task runs on a fiber of its own, so a task which waits on a TWaitList is suspended and the
+    /// worker runs other tasks meanwhile, however many wait. A fiber only ever runs on the worker which created it, and
+    /// a suspended task is resumed on the worker it started on, so neither changes threads and the thread-locals a
+    /// task reads, such as its interpreter context, stay its own. Threads outside the pool run tasks on their own
+    /// stacks, and block where a task would be suspended.
+    /// </para>
+    /// <para>
+    /// The workers start when the first task is spawned, and are stopped once every task spawned has run when the
+    /// scheduler is destroyed. A task suspended for good, such as one receiving from a channel which is never sent to
+    /// or closed, keeps its worker from stopping, so destroying the scheduler blocks until the task is woken.
+    /// </para>
+    /// </summary>
+    class TScheduler
+    {
+        std::string Source;
+        int WorkerCount;
+        bool bJit;
+        int MaxLoop;
+
+        std::once_flag Started;
+        std::shared_ptr<const Embed::TProgram> Program;
+        std::vector<std::unique_ptr<TWorkQueue>> Queues; // One for each worker, then one for threads outside the pool
+        std::vector<std::thread> Workers;
+
+        std::mutex TasksMutex;
+        std::unordered_map<int, std::unique_ptr<TTask>> Tasks; // The tasks spawned and not yet joined, by handle
+        int NextHandle = 0;
+
+        std::mutex ExecutionsMutex;
+        std::vector<std::unique_ptr<Embed::TExecution>> Idle; // Interpreters no task is running in
+
+        TWaitList Finished; // What tasks joining others wait on
+
+        // Bumped whenever a task is queued or finishes, which is what idle workers and joining threads wait for
+        std::mutex SignalMutex;
+        std::condition_variable Signal;
+        uint64_t Generation = 0;
+        bool bStopping = false;
+
+        bool Start();
+        void Work(int Index);
+        void Notify();
+        int GetWorkerIndex() const;
+        TTask* FindTask(int Index);
+        void Queue(TTask* Task);
+        void Run(TTask* Task);
+        void Execute(TTask* Task);
+        void Resume(TTask* Task);
+        void Suspend(TTask* Task);
+        void Wake(TTask* Task);
+        void Finish(TTask* Task);
+        TFiber* AcquireFiber(int Index);
+        void ReleaseFiber(int Index, TFiber* Fiber);
+        void Wait(const TTask* Task);
+        bool Report(const TTask* Task);
+
+        // Runs a body for each chunk of an array, on the workers unless the array is short, and waits for all of them
+        bool ForEachChunk(const std::string& Function, size_t Size,
+                          const std::function<bool(Embed::TExecution&, size_t Chunk, size_t Begin, size_t End)>& Body,
+                          size_t& ChunkCount);
+
+        friend class TWaitList;
+        friend struct TFiber;
+
+    public:
+        /// <param name="InSource">The source of the program whose functions tasks call.</param>
+        /// <param name="InWorkerCount">How many worker threads to run tasks on.</param>
+        /// <param name="bInJit">Whether tasks compile hot code to native code, where the JIT is supported.</param>
+        /// <param name="InMaxLoop">Iterations a while loop in a task may run before it fails.</param>
+        TScheduler(std::string InSource, int InWorkerCount, bool bInJit, int InMaxLoop);
+        ~TScheduler();
+        TScheduler(const TScheduler&) = delete;
+        TScheduler& operator=(const TScheduler&) = delete;
+
+        /// <summary>
+        /// Spawns a task calling one of the program's functions.
+        /// </summary>
+        /// <param name="Function">The function, which the program must declare at its top level.</param>
+        /// <param name="Arguments">The argument values, which the task copies.</param>
+        /// <returns>The task's handle, or nothing if the program could not be compiled for tasks.</returns>
+        std::optional<int> Spawn(const std::string& Function, TArgumentList Arguments);
+
+        /// <summary>
+        /// Waits for a task to finish, suspending the task joining it or running other tasks meanwhile. Joining a task
+        /// frees it, so its handle is no longer valid.
+        /// </summary>
+        /// <param name="Handle">The handle Spawn returned.</param>
+        /// <param name="Result">Where the task's result is copied; null if it has none.</param>
+        /// <returns>False if there is no such task or it failed, having logged why.</returns>
+        bool Join(int Handle, TObject& Result);
+
+        /// <summary>
+        /// Calls a function with each element of an array, in chunks run in parallel.
+        /// </summary>
+        /// <returns>An array of the results in the order of the elements, or nothing if a call failed.</returns>
+        std::optional<TObject> Map(const std::string& Function, const TArray& Elements);
+
+        /// <summary>
+        /// Calls a function returning a bool with each element of an array, in chunks run in parallel.
+        /// </summary>
+        /// <returns>An array of the elements it returned true for, in order, or nothing if a call failed.</returns>
+        std::optional<TObject> Filter(const std::string& Function, const TArray& Elements);
+
+        /// <summary>
+        /// Folds an array with a function of two values. Each chunk is folded in parallel, starting from its first
+        /// element, and then the chunks' results are folded in order starting from the initial value, so the
+        /// function must be associative for the result not to depend on how the array was split.
+        /// </summary>
+        /// <returns>The folded value, which is the initial value for an empty array, or nothing if a call failed.
+        /// </returns>
+        std::optional<TObject> Reduce(const std::string& Function, const TArray& Elements, const TObject& Initial);
+
+        int GetWorkerCount() const { return WorkerCount; }
+    };
+} // namespace Tasks
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <format>
 #include <string>
 #include <fstream>
 #include <regex>
@@ -54,20 +56,29 @@ enum ETokenType
     DivEquals,
     PlusPlus,
     MinusMinus,
+    Colon,
+    Arrow,
 };
 
 static int TOKEN_TYPE_COUNT = ETokenType::Count;
 
-static std::map<ETokenType, std::string> TokenToStringMap{
+static const std::map<ETokenType, std::string> TokenToStringMap{
     {Eof, "/0"}, {Type, "Type"}, {Func, "func"}, {Plus, "+"}, {Minus, "-"},
     {Multiply, "*"}, {Divide, "/"}, {Comma, ","}, {Not, "!"}, {Assign, "="},
     {Equals, "=="}, {NotEquals, "!="}, {Semicolon, ";"}, {LessThan, "<"}, {GreaterThan, ">"},
     {LParen, "("}, {RParen, ")"}, {LBracket, "["}, {RBracket, "]"}, {LCurly, "{"},
     {RCurly, "}"}, {If, "if"}, {Else, "else"}, {For, "for"}, {While, "while"},
     {Return, "return"}, {Period, "."}, {PlusEquals, "+="}, {MinusEquals, "-="}, {MultEquals, "*="},
-    {DivEquals, "/="}, {PlusPlus, "++"}, {MinusMinus, "--"}
+    {DivEquals, "/="}, {PlusPlus, "++"}, {MinusMinus, "--"}, {Colon, ":"}, {Arrow, "->"}
 };
 
+// The text of a token type, or nothing if it has none
+static std::string GetTokenString(const ETokenType Type)
+{
+    const auto It = TokenToStringMap.find(Type);
+    return It != TokenToStringMap.end() ? It->second : std::string();
+}
+
 static ETokenType GetTokenTypeFromString(const std::string& InString)
 {
     for (auto& [K, V] : TokenToStringMap)
@@ -80,7 +91,9 @@ static ETokenType GetTokenTypeFromString(const std::string& InString)
     return Invalid;
 }
 
-const std::vector<char> TOKENS{'+', '-', '/', '*', '=', '!', ';', '<', '>', '(', ')', '[', ']', '{', '}', ',', '.'};
+const std::vector<char> TOKENS{
+    '+', '-', '/', '*', '=', '!', ';', '<', '>', '(', ')', '[', ']', '{', '}', ',', '.', ':',
+};
 const std::vector<char> OPERATORS{'+', '-', '/', '*', '=', '.', '!'};
 const std::vector<std::string> TYPES{
     "int",
@@ -227,8 +240,8 @@ public:
         {
             ETokenType Type;
             std::string Op;
-            // Equals operator
-            if (Contains(OPERATORS, C) && Contains(OPERATORS, GetNextChar()))
+            // Equals operator, or the arrow before a return type
+            if ((Contains(OPERATORS, C) && Contains(OPERATORS, GetNextChar())) || GetPair() == "->")
             {
                 Op = std::string(Source.begin() + Position, Source.begin() + Position + 2);
                 Type = GetTokenTypeFromString(Op);
@@ -9,10 +9,21 @@
 #include <functional>
 
 #include "Core.h"
+#include "HashMap.h"
 #include "Logging.h"
 
 using namespace Core;
 
+namespace Tasks
+{
+    class TChannel;
+} // namespace Tasks
+
+namespace Io
+{
+    class TLineReader;
+} // namespace Io
+
 namespace Values
 {
     enum EValueType
@@ -25,10 +36,30 @@ namespace Values
         StringType,
         ArrayType,
         MapType,
+        ChannelType,
+        FileType,
         TypeCount
     };
 
+    // Binary operators with a kernel in the type-pair dispatch table
+    enum class EBinaryOp
+    {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Less,
+        Greater,
+        Equal,
+        NotEqual,
+        Count
+    };
+
     class TObject;
+
+    // A kernel for one binary operator and one (Left, Right) type pair. See TObject::BinaryOp.
+    using TBinaryKernel = void (*)(const TObject& Left, const TObject& Right, TObject& Out);
+
     class TValue;
     class TBoolValue;
     class TIntValue;
@@ -36,9 +67,11 @@ namespace Values
     class TStringValue;
     class TArrayValue;
     class TMapValue;
+    class TChannelValue;
+    class TFileValue;
 
     using TArray = std::vector<TObject>;
-    using TMap = std::map<std::string, TObject>;
+    using TMap = THashMap<TObject>;
 
     class TValue
     {
@@ -206,8 +239,15 @@ namespace Values
             : Value(InValue)
         {
         }
-        std::string GetValue() const { return Value; }
+        TStringValue(std::string&& InValue) noexcept
+            : Value(std::move(InValue))
+        {
+        }
+        const std::string& GetValue() const { return Value; }
         void SetValue(const std::string& NewValue) { Value = NewValue; }
+        void SetValue(std::string&& NewValue) { Value = std::move(NewValue); }
+        // Moves the string out, leaving this empty, so its buffer can be reused
+        std::string TakeValue() { return std::move(Value); }
         bool IsSubscriptable() const override { return true; }
         bool IsValid() const override { return !Value.empty(); }
         std::string ToString() override { return Value; }
@@ -234,7 +274,11 @@ namespace Values
             : Value(InValue)
         {
         }
-        TArray GetValue() const { return Value; }
+        TArrayValue(TArray&& InValue) noexcept
+            : Value(std::move(InValue))
+        {
+        }
+        const TArray& GetValue() const { return Value; }
         bool IsSubscriptable() const override { return true; }
         bool IsValid() const override { return true; }
         std::string ToString() override { return "#[" + TStringValue::Join(Value, ",") + "]"; }
@@ -260,7 +304,7 @@ namespace Values
             : Value(InValue)
         {
         }
-        TMap GetValue() const { return Value; }
+        const TMap& GetValue() const { return Value; }
         bool IsSubscriptable() const override { return false; }
         bool IsValid() const override { return true; }
         std::string ToString() override { return "Map"; }
@@ -268,14 +312,49 @@ namespace Values
 
         TArrayValue GetKeys() const;
         TArrayValue GetValues() const;
-        bool HasKey(const std::string& Key) const;
+        TIntValue Size() const { return TIntValue(static_cast<int>(Value.Size())); }
+        bool HasKey(std::string_view Key) const;
         TObject* At(const std::string& Key) { return &Value[Key]; }
         TObject* At(const TStringValue& Key) { return &Value[Key.GetValue()]; }
 
-        explicit operator bool() const { return !Value.empty(); }
+        explicit operator bool() const { return !Value.IsEmpty(); }
         TObject& operator[](const std::string& Key) { return Value[Key]; }
     };
 
+    // A reference to a channel: copies of the value, such as those passed to tasks, all refer to the same channel
+    class TChannelValue : public TValue
+    {
+        std::shared_ptr<Tasks::TChannel> Value;
+
+    public:
+        TChannelValue(std::shared_ptr<Tasks::TChannel> InValue)
+            : Value(std::move(InValue))
+        {
+        }
+        Tasks::TChannel& GetValue() const { return *Value; }
+        bool IsSubscriptable() const override { return false; }
+        bool IsValid() const override { return true; }
+        std::string ToString() override { return "Channel"; }
+        std::string ToString() const override { return "Channel"; }
+    };
+
+    // A reference to a file open for reading line by line: copies of the value all read from the same position
+    class TFileValue : public TValue
+    {
+        std::shared_ptr<Io::TLineReader> Value;
+
+    public:
+        TFileValue(std::shared_ptr<Io::TLineReader> InValue)
+            : Value(std::move(InValue))
+        {
+        }
+        Io::TLineReader& GetValue() const { return *Value; }
+        bool IsSubscriptable() const override { return false; }
+        bool IsValid() const override { return true; }
+        std::string ToString() override { return "File"; }
+        std::string ToString() const override { return "File"; }
+    };
+
     class TObject
     {
         std::unique_ptr<TValue> Value;
@@ -344,6 +423,7 @@ namespace Values
         {
             Value = std::move(Other.Value);
             Type = Other.Type;
+            Other.Type = NullType;
         }
         ~TObject() noexcept = default;
         TObject(bool InValue) noexcept
@@ -403,6 +483,11 @@ namespace Values
             Value = std::make_unique<TArrayValue>(InValue);
             Type = ArrayType;
         } // Array
+        TObject(TArrayValue&& InValue) noexcept
+        {
+            Value = std::make_unique<TArrayValue>(std::move(InValue));
+            Type = ArrayType;
+        }
         TObject(const std::initializer_list<TObject>& InValue) noexcept
         {
             Value = std::make_unique<TArrayValue>(InValue);
@@ -413,6 +498,16 @@ namespace Values
             Value = std::make_unique<TMapValue>(InValue);
             Type = MapType;
         }
+        TObject(const TChannelValue& InValue) noexcept
+        {
+            Value = std::make_unique<TChannelValue>(InValue);
+            Type = ChannelType;
+        }
+        TObject(const TFileValue& InValue) noexcept
+        {
+            Value = std::make_unique<TFileValue>(InValue);
+            Type = FileType;
+        }
 
         // Methods
         EValueType GetType() { return Type; }
@@ -465,6 +560,22 @@ namespace Values
             }
             return Cast<TMapValue>(Value.get());
         }
+        TChannelValue* AsChannel() const
+        {
+            if (Value == nullptr)
+            {
+                return nullptr;
+            }
+            return Cast<TChannelValue>(Value.get());
+        }
+        TFileValue* AsFile() const
+        {
+            if (Value == nullptr)
+            {
+                return nullptr;
+            }
+            return Cast<TFileValue>(Value.get());
+        }
 
         TBoolValue GetBool() const { return *AsBool(); }
         TIntValue GetInt() const { return *AsInt(); }
@@ -520,15 +631,108 @@ namespace Values
 
         EValueType GetType() const { return Type; }
 
+        // Unchecked accessors for when the type is already known, such as inside the binary operator kernels.
+        bool RawBool() const { return static_cast<const TBoolValue*>(Value.get())->GetValue(); }
+        int RawInt() const { return static_cast<const TIntValue*>(Value.get())->GetValue(); }
+        float RawFloat() const { return static_cast<const TFloatValue*>(Value.get())->GetValue(); }
+        const std::string& RawString() const { return static_cast<const TStringValue*>(Value.get())->GetValue(); }
+
+        // Setters which reuse the current allocation when the type does not change.
+        void SetBool(bool InValue)
+        {
+            if (Type == BoolType)
+            {
+                static_cast<TBoolValue*>(Value.get())->SetValue(InValue);
+                return;
+            }
+            Value = std::make_unique<TBoolValue>(InValue);
+            Type = BoolType;
+        }
+        void SetInt(int InValue)
+        {
+            if (Type == IntType)
+            {
+                static_cast<TIntValue*>(Value.get())->SetValue(InValue);
+                return;
+            }
+            Value = std::make_unique<TIntValue>(InValue);
+            Type = IntType;
+        }
+        void SetFloat(float InValue)
+        {
+            if (Type == FloatType)
+            {
+                static_cast<TFloatValue*>(Value.get())->SetValue(InValue);
+                return;
+            }
+            Value = std::make_unique<TFloatValue>(InValue);
+            Type = FloatType;
+        }
+        void SetString(std::string&& InValue)
+        {
+            if (Type == StringType)
+            {
+                static_cast<TStringValue*>(Value.get())->SetValue(std::move(InValue));
+                return;
+            }
+            Value = std::make_unique<TStringValue>(std::move(InValue));
+            Type = StringType;
+        }
+        void SetNull()
+        {
+            Value.reset();
+            Type = NullType;
+        }
+
+        /// <summary>
+        /// Applies the binary operator <paramref name="Op"/> through the type-pair dispatch table, writing the result
+        /// into <paramref name="Out"/>. <paramref name="Out"/> may alias either operand. Type pairs the operator does
+        /// not support produce a null object.
+        /// </summary>
+        static void BinaryOp(EBinaryOp Op, const TObject& Left, const TObject& Right, TObject& Out);
+
+        /// <summary>
+        /// Returns the kernel <see cref="BinaryOp"/> dispatches to for the operator and operand types, so callers which
+        /// have already seen the types can cache it.
+        /// </summary>
+        static TBinaryKernel GetBinaryKernel(EBinaryOp Op, EValueType Left, EValueType Right);
+
         bool IsSubscriptable() { return Value->IsSubscriptable(); }
         bool IsSubscriptable() const { return Value->IsSubscriptable(); }
-        std::string ToString() { return Value->ToString(); }
-        std::string ToString() const { return Value->ToString(); }
+        std::string ToString() { return Value ? Value->ToString() : "null"; }
+        std::string ToString() const { return Value ? Value->ToString() : "null"; }
 
         // Operators
 
         TObject& operator=(const TObject& Other)
         {
+            if (this == &Other)
+            {
+                return *this;
+            }
+
+            // Scalars of the same type are copied into the existing allocation
+            if (Type == Other.Type && Value != nullptr)
+            {
+                switch (Type)
+                {
+                case (IntType) :
+                    SetInt(Other.RawInt());
+                    return *this;
+                case (BoolType) :
+                    SetBool(Other.RawBool());
+                    return *this;
+                case (FloatType) :
+                    SetFloat(Other.RawFloat());
+                    return *this;
+                case (StringType) :
+                    static_cast<TStringValue*>(Value.get())->SetValue(Other.RawString());
+                    return *this;
+                default :
+                    break;
+                }
+            }
+
             Type = Other.Type;
             TStringValue S("");
             switch (Other.Type)
@@ -564,8 +768,19 @@ namespace Values
                     Value = std::make_unique<TMapValue>(Other.GetMap());
                     break;
                 }
+            case (ChannelType) :
+                {
+                    Value = std::make_unique<TChannelValue>(*Other.AsChannel());
+                    break;
+                }
+            case (FileType) :
+                {
+                    Value = std::make_unique<TFileValue>(*Other.AsFile());
+                    break;
+                }
             default :
                 {
+                    Value.reset();
                     break;
                 }
             }
@@ -573,6 +788,18 @@ namespace Values
             return *this;
         }
 
+        // Takes over the other object's value, such as an array a built-in has just built, instead of copying it
+        TObject& operator=(TObject&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                Value = std::move(Other.Value);
+                Type = Other.Type;
+                Other.Type = NullType;
+            }
+            return *this;
+        }
+
         TObject operator[](const std::string& Key)
         {
             return At(TObject(Key));
@@ -673,120 +900,10 @@ namespace Values
 
     static bool IsType(const TObject& Value, EValueType Type);
 
-    class TIdentifier
-    {
-    protected:
-        std::string Name;
-
-    public:
-        TIdentifier() = default;
-        virtual ~TIdentifier() = default;
-        virtual bool IsValid() = 0;
-        virtual TObject GetValue() = 0;
-        virtual TObject* GetValuePtr() = 0;
-        virtual std::string ToString() = 0;
-    };
-
-    class TLiteral : public TIdentifier
-    {
-        TObject Value;
-
-    public:
-        TLiteral(TObject InValue)
-            : Value(std::move(InValue))
-        {
-        }
-        std::string GetName() { return Name; }
-        bool IsValid() override { return Value.GetType() != NullType; }
-        TObject GetValue() override { return Value; }
-        TObject* GetValuePtr() override { return &Value; }
-        std::string ToString() override
-        {
-            if (IsValid())
-            {
-                return GetValue().ToString();
-            }
-            else
-            {
-                return "Value is nullptr.";
-            }
-        }
-    };
-
-    using TObjectPtr = std::unique_ptr<TObject>;
-    class TVariable : public TIdentifier
-    {
-        TObject* Value;
-
-    public:
-        TVariable(const std::string& InName, TObject* InValue)
-        {
-            Name = InName;
-            SetValue(InValue);
-        }
-
-        TVariable(TVariable& Other) noexcept
-            : TIdentifier(Other)
-        {
-            Name = Other.Name;
-            *this = Other;
-        }
-        TVariable(const TVariable& Other) noexcept
-            : TIdentifier(Other)
-        {
-            Name = Other.Name;
-            *this = Other;
-        }
-
-        ~TVariable() override = default;
-        bool IsValid() override { return Value != nullptr; }
-        TObject GetValue() override { return *Value; }
-        TObject* GetValuePtr() override { return Value; }
-        void SetValue(TObject* InValue) { Value = InValue; }
-        std::string GetName() { return Name; }
-        std::string ToString() override
-        {
-            if (IsValid())
-            {
-                return std::format("{}, {}", GetName(), GetValue().ToString());
-            }
-            else
-            {
-                return std::format("{} is undefined.", GetName());
-            }
-        }
-
-        TVariable& operator=(const TVariable& Other)
-        {
-            Name = Other.Name;
-            SetValue(Other.Value);
-            return *this;
-        }
-    };
-
-    using TArguments = std::vector<std::shared_ptr<TIdentifier>>;
-
-    using TFunctor = void(TArguments* InArguments, TObject* ReturnValue, bool& bResult);
-    class TFunction
-    {
-        TFunctor* Func = nullptr;
-
-    public:
-        TFunction() = default;
-        TFunction(TFunctor* InFunc) { Func = InFunc; }
-        bool Invoke(TArguments* Arguments, TObject* ReturnValue) const
-        {
-            // The function _should_ be defined by now, but in case it isn't...
-            if (Func == nullptr)
-            {
-                Logging::Error("Function is not defined.");
-                return false;
-            }
+    // The name of a type, as type annotations spell it
+    std::string GetTypeName(EValueType Type);
 
-            // Execute the function, passing the result by reference
-            bool bResult = false;
-            Func(Arguments, ReturnValue, bResult);
-            return bResult;
-        }
-    };
+    // Whether an int division is defined, logging why not if it is not. Dividing by zero and dividing INT_MIN by -1
+    // both trap.
+    bool CanDivide(int Dividend, int Divisor);
 } // namespace Values
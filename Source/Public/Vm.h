@@ -0,0 +1,114 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Bytecode.h"
+#include "Compiler.h"
+
+// GCC and Clang dispatch with computed gotos; other compilers, or builds defining VM_NO_COMPUTED_GOTO, use a switch
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(VM_NO_COMPUTED_GOTO)
+    #define VM_COMPUTED_GOTO 1
+#else
+    #define VM_COMPUTED_GOTO 0
+#endif
+
+class Visitor;
+
+namespace Vm
+{
+    /// <summary>
+    /// Counters for --stats. Moves are the reads and writes of stack slots, registers and variable bindings, and the
+    /// copies of values, counted as the VMs make them.
+    /// </summary>
+    struct TStats
+    {
+        uint64_t Instructions = 0;
+        uint64_t Moves = 0;
+    };
+
+    /// <summary>
+    /// Executes bytecode produced by <see cref="TCompiler"/>, handing Eval instructions to the tree-walking
+    /// interpreter it shares its variables with.
+    /// </summary>
+    class TVirtualMachine
+    {
+        Visitor* Interpreter;
+        TStats* Stats;
+
+        template <bool bStats>
+        bool Execute(TChunk& Chunk);
+
+    public:
+        explicit TVirtualMachine(Visitor* InInterpreter, TStats* InStats = nullptr)
+            : Interpreter(InInterpreter)
+              , Stats(InStats)
+        {
+        }
+
+        /// <summary>
+        /// Runs a compiled program until it halts or an error is logged.
+        /// </summary>
+        /// <param name="Chunk">The program to run.</param>
+        /// <returns>Whether the program ran without errors.</returns>
+        bool Run(TChunk& Chunk);
+    };
+
+    // The default memory budget for the register VM's stacks, in bytes
+    static constexpr size_t DEFAULT_STACK_BUDGET = 64 * 1024 * 1024;
+
+    /// <summary>
+    /// Executes code produced by <see cref="TRegisterCompiler"/>. User functions are compiled the first time they are
+    /// called and kept for the life of the machine, which must outlive any variable bound by them.
+    /// <para>
+    /// Calls do not recurse natively. Every activation's registers and loop counters live on stacks on the heap, and a
+    /// call or return only switches which slice of them the dispatch loop works on, so script recursion is limited by
+    /// the memory budget rather than by the native stack.
+    /// </para>
+    /// </summary>
+    class TRegisterMachine
+    {
+        // A call in progress. Its registers and loop counters are the slices of the stacks starting at the bases.
+        struct TActivation
+        {
+            TRegisterCode* Unit;
+            const TRegisterInstruction* ReturnIp; // Where the caller resumes; the instruction before it is the call
+            size_t RegisterBase;
+            size_t CounterBase;
+        };
+
+        Visitor* Interpreter;
+        TStats* Stats;
+        size_t StackBudget;
+        std::vector<TInlineDecision>* InlineReport;
+        std::map<const AstFunction*, std::unique_ptr<TRegisterCode>> Functions;
+        std::vector<Values::TObject*> RegisterStack;
+        std::vector<int> CounterStack;
+        std::vector<TActivation> CallStack;
+
+        TRegisterCode* GetCode(const AstFunction* Function);
+        bool Enter(TRegisterCode* Unit, const TRegisterInstruction* ReturnIp);
+
+        template <bool bStats>
+        bool Execute();
+
+    public:
+        explicit TRegisterMachine(Visitor* InInterpreter, TStats* InStats = nullptr,
+                                  size_t InStackBudget = DEFAULT_STACK_BUDGET,
+                                  std::vector<TInlineDecision>* InInlineReport = nullptr)
+            : Interpreter(InInterpreter)
+              , Stats(InStats)
+              , StackBudget(InStackBudget)
+              , InlineReport(InInlineReport)
+        {
+        }
+
+        /// <summary>
+        /// Runs a compiled program until it returns or an error is logged.
+        /// </summary>
+        /// <param name="Program">The program to run.</param>
+        /// <returns>Whether the program ran without errors.</returns>
+        bool Run(TRegisterCode& Program);
+    };
+} // namespace Vm